@@ -0,0 +1,154 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+#include "RealtimeHandoff.h"
+#include "RectifierToneStack.h"
+#include "SharedDspResources.h"
+
+#ifndef GAINFORGE_SYNCHRONOUS_PREPARE
+ #define GAINFORGE_SYNCHRONOUS_PREPARE 0
+#endif
+
+//==============================================================================
+/**
+    Sample-rate dependent data that is too slow to build inside prepareToPlay.
+
+    Built on a worker thread and handed to the audio thread as one immutable
+    bundle. Any member may be missing (not built yet, or not needed); the DSP
+    code checks and falls back to its cheap path.
+*/
+struct PreparedResources
+{
+    double sampleRate = 0.0;
+    int maximumBlockSize = 0;
+
+    std::shared_ptr<const RectifierToneStack::CoefficientTable> toneStackTable;
+};
+
+//==============================================================================
+/**
+    Builds PreparedResources off the message thread and publishes them to the
+    audio thread when complete.
+
+    prepare() returns immediately; until the new bundle arrives the audio
+    thread keeps running with whatever it has (or its fallback path). A build
+    that is overtaken by another prepare() call (e.g. a second sample-rate
+    change during session load) is discarded.
+
+    Immutable pieces come from the process-wide SharedDspResourceCache, so
+    instances running at the same rate share one copy and only build what's
+    missing.
+
+    Define GAINFORGE_SYNCHRONOUS_PREPARE=1 to build inline in prepareToPlay
+    instead, for comparing session-load times.
+*/
+class AsyncPreparer
+{
+public:
+    struct Timings
+    {
+        double prepareCallMs = 0.0;    // Time prepare() blocked the calling (message) thread
+        double resourcesReadyMs = 0.0; // From the prepare() call until the bundle was published
+        bool synchronous = false;
+    };
+
+    /** Message thread. */
+    void prepare (double sampleRate, int maximumBlockSize, SharedDspResourceCache& cache,
+                  juce::ThreadPool& pool, RealtimeHandoff<PreparedResources>& target)
+    {
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+
+        // Hosts often call prepareToPlay repeatedly with the same settings
+        if (readySampleRate.load() == sampleRate && readyBlockSize.load() >= maximumBlockSize)
+        {
+            recordCallTime (startTicks, false);
+            return;
+        }
+
+        int thisGeneration;
+        {
+            const juce::ScopedLock sl (publishLock);
+            thisGeneration = ++generation;
+            readySampleRate = 0.0;
+            readyBlockSize = 0;
+        }
+
+        auto job = [this, sampleRate, maximumBlockSize, thisGeneration, startTicks, &cache, &target]
+        {
+            auto resources = build (sampleRate, maximumBlockSize, cache);
+
+            {
+                const juce::ScopedLock sl (publishLock);
+
+                if (generation.load() != thisGeneration)
+                    return; // Superseded while we were building
+
+                target.publish (std::move (resources));
+                readySampleRate = sampleRate;
+                readyBlockSize = maximumBlockSize;
+            }
+
+            const juce::SpinLock::ScopedLockType sl (timingsLock);
+            timings.resourcesReadyMs = elapsedMs (startTicks);
+        };
+
+       #if GAINFORGE_SYNCHRONOUS_PREPARE
+        job();
+        recordCallTime (startTicks, true);
+       #else
+        pool.addJob (job);
+        recordCallTime (startTicks, false);
+       #endif
+    }
+
+    bool isReady() const noexcept        { return readySampleRate.load() > 0.0; }
+
+    Timings getTimings() const
+    {
+        const juce::SpinLock::ScopedLockType sl (timingsLock);
+        return timings;
+    }
+
+    /** The actual work. Runs on the worker thread (or inline when synchronous). */
+    static std::unique_ptr<PreparedResources> build (double sampleRate, int maximumBlockSize,
+                                                     SharedDspResourceCache& cache)
+    {
+        auto resources = std::make_unique<PreparedResources>();
+        resources->sampleRate = sampleRate;
+        resources->maximumBlockSize = maximumBlockSize;
+
+        resources->toneStackTable = cache.getOrBuild<RectifierToneStack::CoefficientTable> (
+            SharedDspResourceCache::makeKey ("toneStackTable", sampleRate),
+            [sampleRate]
+            {
+                auto table = std::make_shared<RectifierToneStack::CoefficientTable>();
+                table->build (sampleRate);
+                return table;
+            });
+
+        return resources;
+    }
+
+private:
+    static double elapsedMs (juce::int64 startTicks)
+    {
+        return 1000.0 * juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+    }
+
+    void recordCallTime (juce::int64 startTicks, bool synchronous)
+    {
+        const juce::SpinLock::ScopedLockType sl (timingsLock);
+        timings.prepareCallMs = elapsedMs (startTicks);
+        timings.synchronous = synchronous;
+    }
+
+    juce::CriticalSection publishLock;
+    std::atomic<int> generation { 0 };
+    std::atomic<double> readySampleRate { 0.0 };
+    std::atomic<int> readyBlockSize { 0 };
+
+    mutable juce::SpinLock timingsLock;
+    Timings timings;
+};
@@ -0,0 +1,282 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "PresetBank.h"
+
+//==============================================================================
+/**
+    Compact, versioned plugin state.
+
+    Layout (little endian):
+        uint32  magic ('GFSB')
+        uint16  version
+        uint16  number of values that follow
+        values  version 1: float, by position (ParameterSnapshot order, then BYPASS and QUALITY)
+                version 2+: { uint32 parameter ID hash, float value } each
+        fields  version 1: the amp model path, then optional trailing fields by position
+                version 2+: { uint32 tag, uint32 byte count, payload } until the end
+
+    From version 2, every value carries a hash of its parameter ID and every
+    field a tag and a length. Readers skip values and fields they don't know,
+    and anything the state lacks keeps whatever the caller pre-filled, so a
+    state with extra parameters or fields still loads into a build without
+    them and vice versa. Version 1 states (positional) are still read.
+
+    The version goes up whenever a value or field is added, or the meaning of
+    one changes:
+        1   positional values and trailing fields
+        2   ID-tagged values and tagged fields. Voice and Mode are decoded as
+            choice indices (Mid and Crunch run their own branches); loaders
+            map the Voice/Mode of older states to the Mod branch they ran
+
+    Anything that doesn't start with the magic number is treated as the old
+    XML state.
+*/
+namespace BinaryState
+{
+    static constexpr juce::uint32 magic = 0x42534647; // "GFSB" read as little endian
+    static constexpr int currentVersion = 2;
+    static constexpr int choiceIndexVersion = 2;    // First version whose Voice/Mode mean what they say
+    static constexpr int numValues = ParameterSnapshot::numParameters + 2; // + BYPASS, QUALITY
+    static constexpr int headerSize = 8;
+
+    /** Field tags (four characters read as little endian). */
+    enum Tag : juce::uint32
+    {
+        ampModelPathTag         = 0x4d504d41,   // "AMPM"
+        cabinetPathTag          = 0x50424143,   // "CABP"
+        cabinetBlendTag         = 0x42424143,   // "CABB"
+        cabinetPreprocessingTag = 0x58424143,   // "CABX"
+        cabinetApproximationTag = 0x41424143,   // "CABA"
+        mergeLinearStageTag     = 0x4547524d    // "MRGE"
+    };
+
+    struct Contents
+    {
+        ParameterSnapshot parameters;
+        float bypass = 0.0f;
+        float quality = 0.0f;
+        juce::String ampModelPath;
+        juce::String cabinetPath;
+        juce::String cabinetBlend;
+        juce::String cabinetPreprocessing;
+        int cabinetApproximation = 0;
+        bool mergeLinearStage = false;
+        int version = currentVersion;   // Set by read() to the version the state was written with
+    };
+
+    inline bool isBinaryState (const void* data, int sizeInBytes) noexcept
+    {
+        return data != nullptr && sizeInBytes >= headerSize
+            && juce::ByteOrder::littleEndianInt (data) == magic;
+    }
+
+    /** 32-bit FNV-1a of a parameter ID, stored next to its value. */
+    inline juce::uint32 hashParameterID (const char* parameterID) noexcept
+    {
+        juce::uint32 hash = 2166136261u;
+        for (auto* c = parameterID; *c != 0; ++c)
+            hash = (hash ^ (juce::uint8) *c) * 16777619u;
+        return hash;
+    }
+
+    /** ID of stored value i: the snapshot's parameters, then BYPASS and QUALITY. */
+    inline const char* getValueID (int index) noexcept
+    {
+        if (index < ParameterSnapshot::numParameters)
+            return ParameterSnapshot::getParameterID (index);
+
+        return index == ParameterSnapshot::numParameters ? "BYPASS" : "QUALITY";
+    }
+
+    inline float& getValue (Contents& contents, int index) noexcept
+    {
+        if (index < ParameterSnapshot::numParameters)
+            return contents.parameters[index];
+
+        return index == ParameterSnapshot::numParameters ? contents.bypass : contents.quality;
+    }
+
+    inline float getValue (const Contents& contents, int index) noexcept
+    {
+        return getValue (const_cast<Contents&> (contents), index);
+    }
+
+    /** Length-prefixed UTF-8 string (not terminated). */
+    inline void writeString (juce::MemoryOutputStream& out, const juce::String& text)
+    {
+        const auto utf8 = text.toUTF8();
+        const auto bytes = (int) utf8.sizeInBytes() - 1;
+
+        out.writeInt (bytes);
+        out.write (utf8.getAddress(), (size_t) bytes);
+    }
+
+    /** Returns false if the stream doesn't hold a complete string. */
+    inline bool readString (juce::MemoryInputStream& in, juce::String& text)
+    {
+        const int bytes = in.readInt();
+        if (bytes < 0 || in.getNumBytesRemaining() < bytes)
+            return false;
+
+        juce::MemoryBlock block;
+        in.readIntoMemoryBlock (block, bytes);
+        text = juce::String::fromUTF8 (static_cast<const char*> (block.getData()), (int) block.getSize());
+        return true;
+    }
+
+    inline void write (const Contents& contents, juce::MemoryBlock& dest)
+    {
+        dest.reset();
+        juce::MemoryOutputStream out (dest, false);
+        out.preallocate ((size_t) (headerSize + numValues * 8 + 6 * 8 + 8 + contents.ampModelPath.getNumBytesAsUTF8()
+                                   + contents.cabinetPath.getNumBytesAsUTF8() + contents.cabinetBlend.getNumBytesAsUTF8()
+                                   + contents.cabinetPreprocessing.getNumBytesAsUTF8()));
+
+        out.writeInt ((int) magic);
+        out.writeShort ((short) currentVersion);
+        out.writeShort ((short) numValues);
+
+        for (int i = 0; i < numValues; ++i)
+        {
+            out.writeInt ((int) hashParameterID (getValueID (i)));
+            out.writeFloat (getValue (contents, i));
+        }
+
+        auto writeStringField = [&out] (Tag tag, const juce::String& text)
+        {
+            out.writeInt ((int) tag);
+            writeString (out, text); // The string's byte count doubles as the field's
+        };
+
+        auto writeIntField = [&out] (Tag tag, int value)
+        {
+            out.writeInt ((int) tag);
+            out.writeInt (4);
+            out.writeInt (value);
+        };
+
+        writeStringField (ampModelPathTag, contents.ampModelPath);
+        writeStringField (cabinetPathTag, contents.cabinetPath);
+        writeStringField (cabinetBlendTag, contents.cabinetBlend);
+        writeStringField (cabinetPreprocessingTag, contents.cabinetPreprocessing);
+        writeIntField (cabinetApproximationTag, contents.cabinetApproximation);
+        writeIntField (mergeLinearStageTag, contents.mergeLinearStage ? 1 : 0);
+    }
+
+    //==============================================================================
+    namespace detail
+    {
+        // Version 1: values by position, the amp model path, then optional trailing fields
+        inline bool readPositional (juce::MemoryInputStream& in, int storedValues, Contents& result)
+        {
+            for (int i = 0; i < storedValues; ++i)
+            {
+                const float value = in.readFloat();
+                if (i < numValues)
+                    getValue (result, i) = value;
+            }
+
+            if (! readString (in, result.ampModelPath))
+                return false;
+
+            // States from before the cabinet fields existed have no cabinet
+            result.cabinetPath = {};
+            result.cabinetBlend = {};
+            result.cabinetPreprocessing = {};
+
+            for (auto* optional : { &result.cabinetPath, &result.cabinetBlend, &result.cabinetPreprocessing })
+                if (in.getNumBytesRemaining() >= 4 && ! readString (in, *optional))
+                    return false;
+
+            result.cabinetApproximation = in.getNumBytesRemaining() >= 4 ? juce::jmax (0, (int) in.readInt()) : 0;
+            result.mergeLinearStage = in.getNumBytesRemaining() >= 4 && in.readInt() != 0;
+            return true;
+        }
+
+        // Version 2+: ID-tagged values, then tagged fields
+        inline bool readTagged (juce::MemoryInputStream& in, int storedValues, Contents& result)
+        {
+            for (int i = 0; i < storedValues; ++i)
+            {
+                const auto hash = (juce::uint32) in.readInt();
+                const float value = in.readFloat();
+
+                for (int known = 0; known < numValues; ++known)
+                {
+                    if (hashParameterID (getValueID (known)) == hash)
+                    {
+                        getValue (result, known) = value;
+                        break;
+                    }
+                }
+            }
+
+            // The strings and switches describe the whole session; ones the state lacks are off
+            result.ampModelPath = {};
+            result.cabinetPath = {};
+            result.cabinetBlend = {};
+            result.cabinetPreprocessing = {};
+            result.cabinetApproximation = 0;
+            result.mergeLinearStage = false;
+
+            while (in.getNumBytesRemaining() >= 8)
+            {
+                const auto tag = (juce::uint32) in.readInt();
+                const int bytes = in.readInt();
+
+                if (bytes < 0 || in.getNumBytesRemaining() < bytes)
+                    return false;
+
+                const auto fieldEnd = in.getPosition() + bytes;
+                juce::MemoryBlock payload;
+                in.readIntoMemoryBlock (payload, bytes);
+
+                auto asString = [&payload] { return juce::String::fromUTF8 (static_cast<const char*> (payload.getData()), (int) payload.getSize()); };
+                auto asInt = [&payload] { return payload.getSize() >= 4 ? (int) juce::ByteOrder::littleEndianInt (payload.getData()) : 0; };
+
+                switch (tag)
+                {
+                    case ampModelPathTag:           result.ampModelPath = asString(); break;
+                    case cabinetPathTag:            result.cabinetPath = asString(); break;
+                    case cabinetBlendTag:           result.cabinetBlend = asString(); break;
+                    case cabinetPreprocessingTag:   result.cabinetPreprocessing = asString(); break;
+                    case cabinetApproximationTag:   result.cabinetApproximation = juce::jmax (0, asInt()); break;
+                    case mergeLinearStageTag:       result.mergeLinearStage = asInt() != 0; break;
+                    default:                        break; // Written by a newer build
+                }
+
+                in.setPosition (fieldEnd);
+            }
+
+            return true;
+        }
+    }
+
+    /** Returns false (leaving contents untouched) if the data isn't a valid binary state. */
+    inline bool read (const void* data, int sizeInBytes, Contents& contents)
+    {
+        if (! isBinaryState (data, sizeInBytes))
+            return false;
+
+        juce::MemoryInputStream in (data, (size_t) sizeInBytes, false);
+        in.skipNextBytes (4);
+
+        const int version = (juce::uint16) in.readShort();
+        const int storedValues = (juce::uint16) in.readShort();
+        const int bytesPerValue = version >= 2 ? 8 : 4;
+
+        if (version < 1 || in.getNumBytesRemaining() < (juce::int64) storedValues * bytesPerValue)
+            return false;
+
+        Contents result = contents;
+        result.version = version;
+
+        if (! (version >= 2 ? detail::readTagged (in, storedValues, result)
+                            : detail::readPositional (in, storedValues, result)))
+            return false;
+
+        contents = result;
+        return true;
+    }
+}
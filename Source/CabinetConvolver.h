@@ -0,0 +1,578 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <atomic>
+#include <complex>
+#include <memory>
+#include <vector>
+#include "IRPreprocessing.h"
+#include "OfflinePipeline.h"
+#include "SharedDspResources.h"
+
+//==============================================================================
+/**
+    Speaker cabinet: zero-latency convolution with a loaded impulse response.
+
+    The IR is cut into uniform partitions of partitionSize samples:
+
+    - the first partition runs as a direct-form FIR, so there is no latency
+    - the next partitions are FFT partitions (overlap-save against a
+      frequency-domain delay line) computed on the audio thread: headPartitions
+      plus as many as the largest host block spans, so a tail job queued in one
+      callback is never due before the next callback plus headPartitions
+    - the rest - the tail - only needs input older than that, so it is handed
+      to a shared worker thread that has at least a host block period to
+      deliver it
+
+    If a tail result isn't ready when its block is due, the audio thread
+    computes it itself (same arithmetic, same result), so a late worker costs
+    CPU on the audio thread, never glitches.
+*/
+namespace Cabinet
+{
+    using Complex = std::complex<float>;
+
+    static constexpr int partitionSize = 64;            // Direct-form head length and FFT partition size
+    static constexpr int fftOrder = 7;                  // 2 * partitionSize
+    static constexpr int numBins = partitionSize + 1;
+    static constexpr int headPartitions = 8;            // FFT partitions done on the audio thread beyond one host block
+    static constexpr double maxLengthSeconds = 1.0;     // Longer files are truncated
+
+    //==============================================================================
+    /**
+        Immutable, pre-transformed IR for one sample rate. Shared by every channel
+        that plays it. The data either lives in the vectors here or, for IRs
+        loaded from a preprocessed container, in a read-only file mapping.
+    */
+    struct PartitionedIR
+    {
+        juce::String name;
+        double sampleRate = 0.0;
+        int length = 0;
+        int numPartitions = 0;                  // FFT partitions after the direct-form head
+        PreprocessingReport preprocessing;      // What load-time preprocessing did, if anything
+
+        const float* getReversedHead() const noexcept                   { return head; }
+        const Complex* getPartition (int index) const noexcept          { return spectra + (size_t) index * numBins; }
+
+        /** Heap bytes only; mapped data lives in the OS page cache, shared with other processes. */
+        size_t getSizeInBytes() const noexcept
+        {
+            return sizeof (*this) + ownedHead.size() * sizeof (float) + ownedSpectra.size() * sizeof (Complex);
+        }
+
+        /** Partitions an IR that is already at its playback rate. */
+        static std::shared_ptr<const PartitionedIR> create (const float* samples, int numSamples,
+                                                            double sampleRate, const juce::String& name,
+                                                            const PreprocessingReport& preprocessing = {})
+        {
+            auto ir = std::make_shared<PartitionedIR>();
+            ir->name = name;
+            ir->preprocessing = preprocessing;
+            ir->sampleRate = sampleRate;
+            ir->length = numSamples;
+            ir->numPartitions = getNumPartitions (numSamples);
+
+            ir->ownedHead.assign ((size_t) partitionSize, 0.0f);
+            for (int i = 0; i < juce::jmin (numSamples, partitionSize); ++i)
+                ir->ownedHead[(size_t) (partitionSize - 1 - i)] = samples[i];
+
+            // Overlap-save: each partition zero-padded to the FFT size
+            juce::dsp::FFT fft (fftOrder);
+            std::vector<float> buffer ((size_t) (4 * partitionSize));
+            ir->ownedSpectra.resize ((size_t) ir->numPartitions * numBins);
+
+            for (int k = 0; k < ir->numPartitions; ++k)
+            {
+                std::fill (buffer.begin(), buffer.end(), 0.0f);
+                const int start = (k + 1) * partitionSize;
+                std::copy (samples + start, samples + juce::jmin (numSamples, start + partitionSize), buffer.begin());
+
+                fft.performRealOnlyForwardTransform (buffer.data(), true);
+                std::copy_n (reinterpret_cast<const Complex*> (buffer.data()), numBins, ir->ownedSpectra.begin() + (ptrdiff_t) k * numBins);
+            }
+
+            ir->head = ir->ownedHead.data();
+            ir->spectra = ir->ownedSpectra.data();
+            return ir;
+        }
+
+        /** Wraps data that is already partitioned, inside a mapping the IR keeps alive. */
+        static std::shared_ptr<const PartitionedIR> createMapped (std::shared_ptr<const juce::MemoryMappedFile> mapping,
+                                                                  const float* reversedHead, const Complex* spectra,
+                                                                  int numSamples, double sampleRate, const juce::String& name)
+        {
+            auto ir = std::make_shared<PartitionedIR>();
+            ir->name = name;
+            ir->sampleRate = sampleRate;
+            ir->length = numSamples;
+            ir->numPartitions = getNumPartitions (numSamples);
+            ir->head = reversedHead;
+            ir->spectra = spectra;
+            ir->mapping = std::move (mapping);
+            return ir;
+        }
+
+        static int getNumPartitions (int numSamples) noexcept    { return juce::jmax (0, (numSamples - 1) / partitionSize); }
+
+        /** The IR back in the time domain (for analysis, not playback). */
+        std::vector<float> getImpulseResponse() const
+        {
+            std::vector<float> samples ((size_t) length, 0.0f);
+            for (int i = 0; i < juce::jmin (length, partitionSize); ++i)
+                samples[(size_t) i] = head[partitionSize - 1 - i];
+
+            juce::dsp::FFT fft (fftOrder);
+            std::vector<float> buffer ((size_t) (4 * partitionSize));
+
+            for (int k = 0; k < numPartitions; ++k)
+            {
+                std::fill (buffer.begin(), buffer.end(), 0.0f);
+                std::copy_n (getPartition (k), numBins, reinterpret_cast<Complex*> (buffer.data()));
+                fft.performRealOnlyInverseTransform (buffer.data());
+
+                const int start = (k + 1) * partitionSize;
+                std::copy_n (buffer.begin(), juce::jmin (partitionSize, length - start), samples.begin() + start);
+            }
+
+            return samples;
+        }
+
+    private:
+        const float* head = nullptr;            // Taps [0, partitionSize), reversed for the FIR
+        const Complex* spectra = nullptr;       // Partition k covers taps [(k + 1) P, (k + 2) P)
+        std::vector<float> ownedHead;
+        std::vector<Complex> ownedSpectra;
+        std::shared_ptr<const juce::MemoryMappedFile> mapping;
+    };
+
+    //==============================================================================
+    /** Reads an audio file and mixes it down to mono at its own rate (at most maxLengthSeconds). */
+    inline bool decodeImpulseResponse (const juce::File& file, std::vector<float>& mono, double& sourceSampleRate,
+                                       juce::String& error)
+    {
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+
+        std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor (file));
+        if (reader == nullptr || reader->sampleRate <= 0.0 || reader->lengthInSamples <= 0)
+        {
+            error = "Unsupported or empty audio file: " + file.getFileName();
+            return false;
+        }
+
+        const auto sourceLength = (int) juce::jmin (reader->lengthInSamples, (juce::int64) (maxLengthSeconds * reader->sampleRate));
+        juce::AudioBuffer<float> source ((int) reader->numChannels, sourceLength);
+        reader->read (&source, 0, sourceLength, 0, true, true);
+
+        mono.assign ((size_t) sourceLength, 0.0f);
+        for (int channel = 0; channel < source.getNumChannels(); ++channel)
+            juce::FloatVectorOperations::addWithMultiply (mono.data(), source.getReadPointer (channel),
+                                                          1.0f / (float) source.getNumChannels(), sourceLength);
+
+        sourceSampleRate = reader->sampleRate;
+        return true;
+    }
+
+    /**
+        Resamples a mono IR to the playback rate and normalises it to unit energy
+        (so swapping cabinets keeps roughly the same level). Returns an empty
+        vector for a silent IR.
+    */
+    inline std::vector<float> conditionImpulseResponse (std::vector<float> mono, double sourceSampleRate, double targetSampleRate)
+    {
+        std::vector<float> samples;
+        const double ratio = sourceSampleRate / targetSampleRate;
+        const auto sourceLength = (int) mono.size();
+
+        if (std::abs (ratio - 1.0) < 1.0e-9)
+        {
+            samples = std::move (mono);
+        }
+        else
+        {
+            // Zero padding lets the interpolator's window run off the end of the IR
+            mono.resize (mono.size() + 256, 0.0f);
+            samples.resize ((size_t) std::ceil (sourceLength / ratio));
+
+            juce::WindowedSincInterpolator interpolator;
+            interpolator.process (ratio, mono.data(), samples.data(), (int) samples.size());
+        }
+
+        double energy = 0.0;
+        for (auto s : samples)
+            energy += (double) s * s;
+
+        if (energy <= 0.0)
+            return {};
+
+        juce::FloatVectorOperations::multiply (samples.data(), (float) (1.0 / std::sqrt (energy)), (int) samples.size());
+        return samples;
+    }
+
+    /**
+        Decodes, conditions and partitions an IR file for the given rate.
+        Blocking - call it from a background thread. Returns nullptr and sets
+        error on failure.
+    */
+    inline std::shared_ptr<const PartitionedIR> readImpulseResponse (const juce::File& file, double targetSampleRate,
+                                                                     juce::String& error)
+    {
+        std::vector<float> mono;
+        double sourceSampleRate = 0.0;
+        if (! decodeImpulseResponse (file, mono, sourceSampleRate, error))
+            return nullptr;
+
+        const auto samples = conditionImpulseResponse (std::move (mono), sourceSampleRate, targetSampleRate);
+        if (samples.empty())
+        {
+            error = "Impulse response is silent: " + file.getFileName();
+            return nullptr;
+        }
+
+        return PartitionedIR::create (samples.data(), (int) samples.size(), targetSampleRate, file.getFileNameWithoutExtension());
+    }
+
+    /** Cache key for an IR: content id, playback rate and the partition layout it was transformed for. */
+    inline juce::String makeCacheKey (const juce::String& contentId, double sampleRate)
+    {
+        return SharedDspResourceCache::makeKey ("cabinetIR", sampleRate, contentId + "/p" + juce::String (partitionSize));
+    }
+
+    //==============================================================================
+    /** Anything with tail work for the shared worker. */
+    struct TailSource
+    {
+        virtual ~TailSource() = default;
+
+        /** Worker thread: does whatever is queued. Returns false if there was nothing to do. */
+        virtual bool processTailJobs() noexcept = 0;
+    };
+
+    /**
+        One thread per process computing convolution tails for every cabinet.
+
+        The audio thread never signals it: notifyWork() only sets a flag, and
+        the worker polls that flag with a bounded sleep (pollIntervalMs) while
+        any convolver is registered. Every job has at least a host block period
+        plus headPartitions partitions (>= 2.6 ms at 192 kHz) before it is due,
+        and a late one costs the audio thread CPU, not a glitch. With no
+        convolvers registered the worker sleeps until one is added.
+    */
+    class TailWorker : private juce::Thread
+    {
+    public:
+        static constexpr int pollIntervalMs = 1;
+
+        TailWorker() : juce::Thread ("GAINFORGE cab tail")   { startThread (juce::Thread::Priority::high); }
+        ~TailWorker() override                              { stopThread (2000); }
+
+        /** Audio thread: flags that a job was queued. One atomic store: no system call, no lock. */
+        void notifyWork() noexcept
+        {
+            workPending.store (true, std::memory_order_release);
+        }
+
+        /** Any non-audio thread. */
+        void addSource (TailSource* source)
+        {
+            {
+                const juce::ScopedLock sl (sourceLock);
+                sources.push_back (source);
+                numSources.store ((int) sources.size());
+            }
+
+            notify(); // Starts polling
+        }
+
+        /** Any non-audio thread. Returns once the worker is no longer touching the source. */
+        void removeSource (TailSource* source)
+        {
+            const juce::ScopedLock sl (sourceLock);
+            sources.erase (std::remove (sources.begin(), sources.end(), source), sources.end());
+            numSources.store ((int) sources.size());
+        }
+
+    private:
+        void run() override
+        {
+            juce::ScopedNoDenormals noDenormals;
+
+            while (! threadShouldExit())
+            {
+                if (numSources.load() == 0)
+                {
+                    wait (-1); // Until addSource() (or stopThread())
+                    continue;
+                }
+
+                // Cleared before draining, so a job queued from here on is seen by the next pass
+                if (! workPending.exchange (false, std::memory_order_acquire))
+                {
+                    wait (pollIntervalMs);
+                    continue;
+                }
+
+                const juce::ScopedLock sl (sourceLock);
+                for (auto* source : sources)
+                    source->processTailJobs();
+            }
+        }
+
+        juce::CriticalSection sourceLock;
+        std::vector<TailSource*> sources;
+        std::atomic<int> numSources { 0 };
+        std::atomic<bool> workPending { false };
+    };
+
+    //==============================================================================
+    /**
+        What the amp runs as its cabinet for one channel: the exact convolver or
+        an approximation of it. process() and reset() are audio-thread only and
+        never allocate.
+    */
+    struct Stage
+    {
+        virtual ~Stage() = default;
+
+        virtual void process (float* data, int numSamples) noexcept = 0;
+        virtual void reset() noexcept = 0;
+
+        /** The IR this stage convolves with exactly, or nullptr for an approximation. */
+        virtual const PartitionedIR* getExactImpulseResponse() const noexcept   { return nullptr; }
+
+        /** Bytes the stage owns, itself included; a shared IR is counted by whoever shares it. */
+        virtual size_t getSizeInBytes() const noexcept = 0;
+    };
+
+    /**
+        Convolution state for one channel. Constructed (and destroyed) off the
+        audio thread; process() and reset() are audio-thread only and never
+        allocate.
+    */
+    class Convolver : public Stage,
+                      private TailSource
+    {
+    public:
+        /** maxBlockSize is the largest block process() will be called with (the host's prepared size). */
+        Convolver (std::shared_ptr<const PartitionedIR> irToUse, TailWorker& workerToUse, int maxBlockSize)
+            : ir (std::move (irToUse)), worker (workerToUse), fft (fftOrder),
+              numHead (headPartitions + (juce::jmax (1, maxBlockSize) + partitionSize - 1) / partitionSize),
+              numTailSlots (2 * numHead + 2)
+        {
+            jassert (numTailSlots <= maxQueuedJobs);
+
+            const int numTail = juce::jmax (0, ir->numPartitions - numHead);
+
+            // Enough history that the oldest spectrum a job can still meet its deadline with isn't overwritten
+            numHistory = ir->numPartitions + numTailSlots;
+            history.resize ((size_t) numHistory * numBins);
+            inputBlock.resize ((size_t) (2 * partitionSize));
+            outputBlock.resize ((size_t) partitionSize);
+            fftBuffer.resize ((size_t) (4 * partitionSize));
+            accumulator.resize ((size_t) numBins);
+
+            if (numTail > 0)
+            {
+                tailSlots = std::make_unique<TailSlot[]> ((size_t) numTailSlots);
+                for (int i = 0; i < numTailSlots; ++i)
+                    tailSlots[i].sum.resize ((size_t) numBins);
+
+                worker.addSource (this);
+            }
+
+            reset();
+        }
+
+        ~Convolver() override
+        {
+            if (tailSlots != nullptr)
+                worker.removeSource (this);
+        }
+
+        const PartitionedIR& getImpulseResponse() const noexcept    { return *ir; }
+        const PartitionedIR* getExactImpulseResponse() const noexcept override     { return ir.get(); }
+
+        /** FFT partitions computed on the audio thread; the tail starts after them. */
+        int getNumHeadPartitions() const noexcept                   { return numHead; }
+
+        size_t getSizeInBytes() const noexcept override
+        {
+            size_t bytes = sizeof (*this)
+                         + (inputBlock.capacity() + outputBlock.capacity() + fftBuffer.capacity()) * sizeof (float)
+                         + (accumulator.capacity() + history.capacity()) * sizeof (Complex);
+
+            if (tailSlots != nullptr)
+                for (int i = 0; i < numTailSlots; ++i)
+                    bytes += sizeof (TailSlot) + tailSlots[i].sum.capacity() * sizeof (Complex);
+
+            return bytes;
+        }
+
+        /** Tail blocks the audio thread had to compute itself because the worker was late. */
+        int getNumLateTails() const noexcept                        { return lateTails.load (std::memory_order_relaxed); }
+
+        void reset() noexcept override
+        {
+            std::fill (inputBlock.begin(), inputBlock.end(), 0.0f);
+            std::fill (outputBlock.begin(), outputBlock.end(), 0.0f);
+            position = 0;
+
+            // Jump past every block with a job still queued, so stale results can never match;
+            // history before firstValidBlock counts as silence
+            blockIndex += numTailSlots;
+            firstValidBlock.store (blockIndex, std::memory_order_release);
+        }
+
+        void process (float* data, int numSamples) noexcept override
+        {
+            const float* head = ir->getReversedHead();
+
+            for (int start = 0; start < numSamples;)
+            {
+                const int count = juce::jmin (numSamples - start, partitionSize - position);
+
+                for (int i = 0; i < count; ++i)
+                {
+                    const int p = position + i;
+                    inputBlock[(size_t) (partitionSize + p)] = data[start + i];
+
+                    // Direct-form head over the last partitionSize inputs (contiguous thanks to the block layout)
+                    const float* x = inputBlock.data() + p + 1;
+                    float y = 0.0f;
+                    for (int k = 0; k < partitionSize; ++k)
+                        y += head[k] * x[k];
+
+                    data[start + i] = y + outputBlock[(size_t) p];
+                }
+
+                position += count;
+                start += count;
+
+                if (position == partitionSize)
+                {
+                    completeBlock();
+                    position = 0;
+                }
+            }
+        }
+
+    private:
+        struct TailSlot
+        {
+            std::vector<Complex> sum;
+            std::atomic<juce::int64> readyBlock { -1 };
+        };
+
+        static constexpr int maxQueuedJobs = 256;   // Room for a callback's jobs with blocks up to 7.5k samples
+
+        Complex* getHistory (juce::int64 block) noexcept                { return history.data() + (size_t) (block % numHistory) * numBins; }
+
+        static void multiplyAdd (Complex* dest, const Complex* a, const Complex* b) noexcept
+        {
+            for (int i = 0; i < numBins; ++i)
+                dest[i] += a[i] * b[i];
+        }
+
+        // Partitions [first, last) against the spectra that feed output block `target`
+        void accumulate (Complex* dest, juce::int64 target, int first, int last) noexcept
+        {
+            const auto oldest = firstValidBlock.load (std::memory_order_acquire);
+
+            for (int k = first; k < last; ++k)
+            {
+                const auto block = target - 1 - k;
+                if (block < oldest)
+                    break;
+
+                multiplyAdd (dest, ir->getPartition (k), getHistory (block));
+            }
+        }
+
+        void completeBlock() noexcept
+        {
+            // Spectrum of the last two input blocks (overlap-save)
+            std::copy (inputBlock.begin(), inputBlock.end(), fftBuffer.begin());
+            std::fill (fftBuffer.begin() + 2 * partitionSize, fftBuffer.end(), 0.0f);
+            fft.performRealOnlyForwardTransform (fftBuffer.data(), true);
+            std::copy_n (reinterpret_cast<const Complex*> (fftBuffer.data()), numBins, getHistory (blockIndex));
+
+            const auto target = blockIndex + 1;
+            std::fill (accumulator.begin(), accumulator.end(), Complex());
+            accumulate (accumulator.data(), target, 0, juce::jmin (numHead, ir->numPartitions));
+
+            if (tailSlots != nullptr)
+            {
+                auto& slot = tailSlots[target % numTailSlots];
+
+                if (slot.readyBlock.load (std::memory_order_acquire) == target)
+                {
+                    for (int i = 0; i < numBins; ++i)
+                        accumulator[(size_t) i] += slot.sum[(size_t) i];
+                }
+                else
+                {
+                    accumulate (accumulator.data(), target, numHead, ir->numPartitions);
+                    lateTails.fetch_add (1, std::memory_order_relaxed);
+                }
+            }
+
+            if (ir->numPartitions > 0)
+            {
+                std::copy (accumulator.begin(), accumulator.end(), reinterpret_cast<Complex*> (fftBuffer.data()));
+                fft.performRealOnlyInverseTransform (fftBuffer.data());
+                std::copy_n (fftBuffer.begin() + partitionSize, partitionSize, outputBlock.begin());
+            }
+
+            // Slide the input window and queue the tail for the block numHead + 1 ahead
+            std::copy_n (inputBlock.begin() + partitionSize, partitionSize, inputBlock.begin());
+            ++blockIndex;
+
+            if (tailSlots != nullptr)
+            {
+                jobs.push (blockIndex + numHead);
+                worker.notifyWork();
+            }
+        }
+
+        bool processTailJobs() noexcept override
+        {
+            bool didWork = false;
+
+            for (juce::int64 target; jobs.pop (target);)
+            {
+                // Jobs run in order on one thread, so a slot is never written while the audio thread reads it
+                auto& slot = tailSlots[target % numTailSlots];
+                std::fill (slot.sum.begin(), slot.sum.end(), Complex());
+                accumulate (slot.sum.data(), target, numHead, ir->numPartitions);
+                slot.readyBlock.store (target, std::memory_order_release);
+                didWork = true;
+            }
+
+            return didWork;
+        }
+
+        std::shared_ptr<const PartitionedIR> ir;
+        TailWorker& worker;
+        juce::dsp::FFT fft;
+        const int numHead;                      // headPartitions plus the partitions one host block spans
+        const int numTailSlots;
+
+        std::vector<float> inputBlock;          // Previous and current input block
+        std::vector<float> outputBlock;         // FFT partitions' output for the current block
+        std::vector<float> fftBuffer;
+        std::vector<Complex> accumulator;
+        std::vector<Complex> history;           // Input spectra, one per block, ring of numHistory
+        int numHistory = 0;
+        int position = 0;
+        juce::int64 blockIndex = 0;             // Audio thread
+        std::atomic<juce::int64> firstValidBlock { 0 };
+
+        std::unique_ptr<TailSlot[]> tailSlots;
+        SpscQueue<juce::int64, maxQueuedJobs> jobs; // Target blocks, audio thread -> worker
+        std::atomic<int> lateTails { 0 };
+
+        JUCE_DECLARE_NON_COPYABLE (Convolver)
+    };
+}
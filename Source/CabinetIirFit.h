@@ -0,0 +1,431 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <vector>
+#include "CabinetConvolver.h"
+
+//==============================================================================
+/**
+    Low-CPU cabinet: a cascade of 8-16 biquads fitted to an IR's magnitude
+    response. No convolution and no latency, five multiplies per section per
+    sample.
+
+    The fit runs on a Bark-like warped frequency axis (first-order allpass
+    warping with Smith & Abel's coefficient for the sample rate), so sections
+    go where hearing resolves detail instead of crowding the top octave. On
+    that axis it alternates autocorrelation-method LPC fits: poles against
+    the target divided by the current zeros, then zeros against what the
+    poles missed. The roots are mapped back to the z-plane and paired into
+    sections. LPC polynomials are minimum phase, and the warping maps the
+    unit disc onto itself, so the cascade is always stable. Phase isn't
+    matched - a cabinet's character is almost all in its magnitude response.
+*/
+namespace Cabinet
+{
+    namespace IirFit
+    {
+        static constexpr int minSections = 8;
+        static constexpr int maxSections = 16;
+
+        /** Normalised biquad (a0 = 1). */
+        struct Section
+        {
+            float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+        };
+
+        /** How close the fit came, in third-octave bands. */
+        struct Report
+        {
+            int numSections = 0;
+            std::vector<float> bandFrequencies;     // Band centres, 20 Hz up to 20 kHz (or just below Nyquist)
+            std::vector<float> bandErrorDb;         // Fitted minus exact level per band
+            float maxErrorDb = 0.0f;
+            float rmsErrorDb = 0.0f;
+
+            juce::String toString() const
+            {
+                if (numSections == 0)
+                    return "Exact convolution";
+
+                return juce::String (numSections) + " biquads, fit error " + juce::String (rmsErrorDb, 2)
+                     + " dB RMS, " + juce::String (maxErrorDb, 2) + " dB max (20 Hz - 20 kHz)";
+            }
+        };
+
+        struct Result
+        {
+            std::vector<Section> sections;
+            Report report;
+        };
+
+        namespace Detail
+        {
+            using ComplexD = std::complex<double>;
+
+            /** Smith & Abel's Bark-warping allpass coefficient. */
+            inline double getWarpingCoefficient (double sampleRate)
+            {
+                return 1.0674 * std::sqrt (2.0 / juce::MathConstants<double>::pi * std::atan (0.06583 * sampleRate / 1000.0)) - 0.1916;
+            }
+
+            /** Levinson-Durbin: prediction polynomial [1, a1 .. aOrder] for an autocorrelation. */
+            inline std::vector<double> levinson (const std::vector<double>& r, int order)
+            {
+                std::vector<double> a ((size_t) order + 1, 0.0), previous;
+                a[0] = 1.0;
+                double error = r[0] * (1.0 + 1.0e-9); // A touch of white noise keeps it well conditioned
+
+                for (int i = 1; i <= order && error > 0.0; ++i)
+                {
+                    double acc = r[(size_t) i];
+                    for (int j = 1; j < i; ++j)
+                        acc += a[(size_t) j] * r[(size_t) (i - j)];
+
+                    const double k = -acc / error;
+                    previous = a;
+                    for (int j = 1; j < i; ++j)
+                        a[(size_t) j] = previous[(size_t) j] + k * previous[(size_t) (i - j)];
+
+                    a[(size_t) i] = k;
+                    error *= 1.0 - k * k;
+                }
+
+                return a;
+            }
+
+            /** Roots of z^n + c1 z^(n-1) + ... + cn (Aberth-Ehrlich). */
+            inline std::vector<ComplexD> findRoots (const std::vector<double>& coefficients)
+            {
+                const int order = (int) coefficients.size() - 1;
+                std::vector<ComplexD> roots ((size_t) order);
+
+                for (int k = 0; k < order; ++k)
+                    roots[(size_t) k] = std::polar (0.9, juce::MathConstants<double>::twoPi * k / order + 0.4);
+
+                for (int iteration = 0; iteration < 500; ++iteration)
+                {
+                    double largestStep = 0.0;
+
+                    for (int k = 0; k < order; ++k)
+                    {
+                        const auto z = roots[(size_t) k];
+                        ComplexD value (1.0), derivative (0.0);
+
+                        for (int i = 1; i <= order; ++i)
+                        {
+                            derivative = derivative * z + value;
+                            value = value * z + coefficients[(size_t) i];
+                        }
+
+                        ComplexD repulsion (0.0);
+                        for (int j = 0; j < order; ++j)
+                            if (j != k)
+                                repulsion += 1.0 / (z - roots[(size_t) j]);
+
+                        const auto ratio = value / derivative;
+                        const auto step = ratio / (1.0 - ratio * repulsion);
+
+                        if (std::isfinite (step.real()) && std::isfinite (step.imag()))
+                        {
+                            roots[(size_t) k] -= step;
+                            largestStep = juce::jmax (largestStep, std::abs (step));
+                        }
+                    }
+
+                    if (largestStep < 1.0e-14)
+                        break;
+                }
+
+                return roots;
+            }
+
+            /** A second-order factor (1 - r z^-1)(1 - r' z^-1), with one of its roots to pair by. */
+            struct Quadratic
+            {
+                double c1 = 0.0, c2 = 0.0;
+                ComplexD root;
+            };
+
+            /** Groups roots into conjugate pairs (or pairs of real roots). */
+            inline std::vector<Quadratic> makeQuadratics (std::vector<ComplexD> roots)
+            {
+                std::vector<Quadratic> quadratics;
+                std::vector<double> realRoots;
+
+                for (auto& r : roots)
+                {
+                    if (r.imag() > 1.0e-9)
+                        quadratics.push_back ({ -2.0 * r.real(), std::norm (r), r });
+                    else if (std::abs (r.imag()) <= 1.0e-9)
+                        realRoots.push_back (r.real());
+                }
+
+                if (realRoots.size() % 2 != 0)
+                    realRoots.push_back (0.0);
+
+                std::sort (realRoots.begin(), realRoots.end());
+                for (size_t i = 0; i < realRoots.size(); i += 2)
+                    quadratics.push_back ({ -(realRoots[i] + realRoots[i + 1]), realRoots[i] * realRoots[i + 1],
+                                            ComplexD (realRoots[i + 1]) });
+
+                return quadratics;
+            }
+
+            /** |H(e^jw)|^2 of a cascade. */
+            inline double getPowerResponse (const std::vector<Section>& sections, double omega)
+            {
+                const auto z1 = std::polar (1.0, -omega);
+                const auto z2 = z1 * z1;
+                double power = 1.0;
+
+                for (auto& s : sections)
+                    power *= std::norm ((double) s.b0 + (double) s.b1 * z1 + (double) s.b2 * z2)
+                           / std::norm (1.0 + (double) s.a1 * z1 + (double) s.a2 * z2);
+
+                return power;
+            }
+        }
+
+        /** Fits a cascade to an IR at its playback rate. Blocking; a few milliseconds. */
+        inline Result fit (const std::vector<float>& impulseResponse, double sampleRate, int numSections)
+        {
+            using namespace Detail;
+            constexpr double pi = juce::MathConstants<double>::pi;
+            constexpr int gridSize = 512;
+            constexpr int iterations = 8;
+
+            numSections = juce::jlimit (minSections, maxSections, numSections);
+            const int order = 2 * numSections;
+            const double lambda = getWarpingCoefficient (sampleRate);
+
+            // Power spectrum of the exact IR
+            juce::dsp::FFT fft (Cabinet::Detail::getFftOrderFor (juce::jmax (impulseResponse.size(), (size_t) 4096) * 2));
+            const int fftSize = fft.getSize();
+            const int numSpectrumBins = fftSize / 2 + 1;
+            std::vector<float> buffer ((size_t) (2 * fftSize), 0.0f);
+            std::copy (impulseResponse.begin(), impulseResponse.end(), buffer.begin());
+            fft.performRealOnlyForwardTransform (buffer.data(), true);
+
+            std::vector<double> power ((size_t) numSpectrumBins);
+            for (int k = 0; k < numSpectrumBins; ++k)
+                power[(size_t) k] = std::norm (std::complex<double> (buffer[(size_t) (2 * k)], buffer[(size_t) (2 * k + 1)]));
+
+            // Uniform grid on the warped axis; each point averages the bins it covers, which doubles
+            // as smoothing that follows the ear's resolution
+            std::vector<double> warped (gridSize + 1), omega (gridSize + 1), target (gridSize + 1);
+            for (int k = 0; k <= gridSize; ++k)
+            {
+                warped[(size_t) k] = pi * k / gridSize;
+                omega[(size_t) k] = warped[(size_t) k] - 2.0 * std::atan (lambda * std::sin (warped[(size_t) k])
+                                                                          / (1.0 + lambda * std::cos (warped[(size_t) k])));
+            }
+
+            double peak = 0.0;
+            for (int k = 0; k <= gridSize; ++k)
+            {
+                const double lower = k == 0 ? 0.0 : 0.5 * (omega[(size_t) k - 1] + omega[(size_t) k]);
+                const double upper = k == gridSize ? pi : 0.5 * (omega[(size_t) k] + omega[(size_t) k + 1]);
+                const int first = juce::jlimit (0, numSpectrumBins - 1, (int) std::floor (lower * fftSize / (2.0 * pi)));
+                const int last = juce::jlimit (first + 1, numSpectrumBins, (int) std::ceil (upper * fftSize / (2.0 * pi)));
+
+                double sum = 0.0;
+                for (int bin = first; bin < last; ++bin)
+                    sum += power[(size_t) bin];
+
+                target[(size_t) k] = sum / (last - first);
+                peak = juce::jmax (peak, target[(size_t) k]);
+            }
+
+            // Nothing is worth chasing more than 60 dB down
+            for (auto& t : target)
+                t = juce::jmax (t, peak * 1.0e-6);
+
+            // Trapezoid-weighted cosine tables on the warped grid, for autocorrelations and responses
+            std::vector<double> cosines ((size_t) ((order + 1) * (gridSize + 1))), sines (cosines.size());
+            for (int n = 0; n <= order; ++n)
+                for (int k = 0; k <= gridSize; ++k)
+                {
+                    cosines[(size_t) (n * (gridSize + 1) + k)] = std::cos (n * warped[(size_t) k]);
+                    sines[(size_t) (n * (gridSize + 1) + k)] = std::sin (n * warped[(size_t) k]);
+                }
+
+            auto getAutocorrelation = [&] (const std::vector<double>& spectrum)
+            {
+                std::vector<double> r ((size_t) order + 1, 0.0);
+                for (int n = 0; n <= order; ++n)
+                    for (int k = 0; k <= gridSize; ++k)
+                        r[(size_t) n] += (k == 0 || k == gridSize ? 0.5 : 1.0) * spectrum[(size_t) k]
+                                       * cosines[(size_t) (n * (gridSize + 1) + k)];
+                return r;
+            };
+
+            auto getPolynomialPower = [&] (const std::vector<double>& polynomial, int k)
+            {
+                double re = 0.0, im = 0.0;
+                for (int n = 0; n <= order; ++n)
+                {
+                    re += polynomial[(size_t) n] * cosines[(size_t) (n * (gridSize + 1) + k)];
+                    im -= polynomial[(size_t) n] * sines[(size_t) (n * (gridSize + 1) + k)];
+                }
+                return re * re + im * im;
+            };
+
+            std::vector<double> poles, zeros ((size_t) order + 1, 0.0), spectrum (gridSize + 1);
+            zeros[0] = 1.0;
+
+            for (int iteration = 0; iteration < iterations; ++iteration)
+            {
+                for (int k = 0; k <= gridSize; ++k)
+                    spectrum[(size_t) k] = target[(size_t) k] / juce::jmax (getPolynomialPower (zeros, k), 1.0e-30);
+                poles = levinson (getAutocorrelation (spectrum), order);
+
+                // Zeros: an all-pole fit to the inverse of what the poles leave over
+                for (int k = 0; k <= gridSize; ++k)
+                    spectrum[(size_t) k] = 1.0 / juce::jmax (target[(size_t) k] * getPolynomialPower (poles, k), 1.0e-30);
+                zeros = levinson (getAutocorrelation (spectrum), order);
+            }
+
+            // Back to the z-plane: the allpass substitution moves each warped root w to (w + lambda) / (1 + lambda w).
+            // The extra zeros (at lambda) of the pole fit and poles of the zero fit cancel, both being of the same order
+            auto unwarp = [lambda] (std::vector<ComplexD> roots)
+            {
+                for (auto& r : roots)
+                    r = (r + lambda) / (1.0 + lambda * r);
+                return makeQuadratics (std::move (roots));
+            };
+
+            auto poleQuadratics = unwarp (findRoots (poles));
+            auto zeroQuadratics = unwarp (findRoots (zeros));
+
+            // Sharpest resonances first, each with the zeros nearest to it (keeps the sections' gains moderate)
+            std::sort (poleQuadratics.begin(), poleQuadratics.end(),
+                       [] (const Quadratic& a, const Quadratic& b) { return a.c2 > b.c2; });
+
+            Result result;
+            for (auto& pole : poleQuadratics)
+            {
+                Section section;
+                section.a1 = (float) pole.c1;
+                section.a2 = (float) pole.c2;
+
+                if (! zeroQuadratics.empty())
+                {
+                    auto nearest = std::min_element (zeroQuadratics.begin(), zeroQuadratics.end(),
+                                                     [&pole] (const Quadratic& a, const Quadratic& b)
+                                                     {
+                                                         return std::abs (a.root - pole.root) < std::abs (b.root - pole.root);
+                                                     });
+                    section.b1 = (float) nearest->c1;
+                    section.b2 = (float) nearest->c2;
+                    zeroQuadratics.erase (nearest);
+                }
+
+                result.sections.push_back (section);
+            }
+
+            if (result.sections.empty())
+                return result;
+
+            // Level: least squares in dB over the audible band, which the grid already spaces perceptually
+            double logGain = 0.0;
+            int numGainPoints = 0;
+            for (int k = 0; k <= gridSize; ++k)
+            {
+                const double frequency = omega[(size_t) k] * sampleRate / (2.0 * pi);
+                if (frequency > 30.0 && frequency < juce::jmin (18000.0, 0.45 * sampleRate))
+                {
+                    logGain += std::log (target[(size_t) k] / getPowerResponse (result.sections, omega[(size_t) k]));
+                    ++numGainPoints;
+                }
+            }
+
+            const auto gain = (float) std::exp (0.5 * logGain / juce::jmax (1, numGainPoints));
+            auto& first = result.sections.front();
+            first.b0 *= gain;
+            first.b1 *= gain;
+            first.b2 *= gain;
+
+            // Error per third-octave band, floored like the target
+            auto& report = result.report;
+            report.numSections = (int) result.sections.size();
+            const double binWidth = sampleRate / fftSize;
+            const double powerFloor = peak * 1.0e-6;
+            double sumSquares = 0.0;
+
+            for (double centre = 20.0; centre <= juce::jmin (20000.0, 0.45 * sampleRate); centre *= std::pow (2.0, 1.0 / 3.0))
+            {
+                const int lowBin = juce::jlimit (0, numSpectrumBins - 1, (int) std::ceil (centre * std::pow (2.0, -1.0 / 6.0) / binWidth));
+                const int highBin = juce::jlimit (lowBin + 1, numSpectrumBins, (int) std::ceil (centre * std::pow (2.0, 1.0 / 6.0) / binWidth));
+
+                double exact = 0.0, fitted = 0.0;
+                for (int bin = lowBin; bin < highBin; ++bin)
+                {
+                    exact += power[(size_t) bin];
+                    fitted += getPowerResponse (result.sections, 2.0 * pi * bin / fftSize);
+                }
+
+                const auto error = (float) (10.0 * std::log10 (juce::jmax (fitted / (highBin - lowBin), powerFloor)
+                                                               / juce::jmax (exact / (highBin - lowBin), powerFloor)));
+                report.bandFrequencies.push_back ((float) centre);
+                report.bandErrorDb.push_back (error);
+                report.maxErrorDb = juce::jmax (report.maxErrorDb, std::abs (error));
+                sumSquares += (double) error * error;
+            }
+
+            report.rmsErrorDb = (float) std::sqrt (sumSquares / juce::jmax ((size_t) 1, report.bandErrorDb.size()));
+            return result;
+        }
+    }
+
+    //==============================================================================
+    /** The fitted cascade, for one channel: every section runs in one fused per-sample loop. */
+    class BiquadCascade : public Stage
+    {
+    public:
+        explicit BiquadCascade (const std::vector<IirFit::Section>& sectionsToUse)
+        {
+            numSections = juce::jmin ((int) sectionsToUse.size(), IirFit::maxSections);
+            std::copy_n (sectionsToUse.begin(), numSections, sections.begin());
+            reset();
+        }
+
+        void reset() noexcept override
+        {
+            for (auto& s : state)
+                s = { 0.0f, 0.0f };
+        }
+
+        void process (float* data, int numSamples) noexcept override
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                float x = data[i];
+
+                // Transposed direct form II
+                for (int s = 0; s < numSections; ++s)
+                {
+                    const auto& c = sections[(size_t) s];
+                    auto& z = state[(size_t) s];
+
+                    const float y = c.b0 * x + z[0];
+                    z[0] = c.b1 * x - c.a1 * y + z[1];
+                    z[1] = c.b2 * x - c.a2 * y;
+                    x = y;
+                }
+
+                data[i] = x;
+            }
+        }
+
+        size_t getSizeInBytes() const noexcept override     { return sizeof (*this); }
+
+    private:
+        std::array<IirFit::Section, IirFit::maxSections> sections {};
+        std::array<std::array<float, 2>, IirFit::maxSections> state {};
+        int numSections = 0;
+    };
+}
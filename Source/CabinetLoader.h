@@ -0,0 +1,220 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include "CabinetConvolver.h"
+#include "IRContainer.h"
+#include "SharedDspResources.h"
+
+//==============================================================================
+/**
+    Loading cabinet IRs for playback: single files (audio or '.gfir') and
+    multi-mic blends, all through the process-wide cache. Everything here
+    blocks - call it from a background thread.
+*/
+namespace Cabinet
+{
+    /**
+        Opens the preprocessed container for a file: the file itself, or a '.gfir'
+        with the same name next to an audio file (only if it was made from the
+        audio file as it is now).
+    */
+    inline bool openContainerFor (const juce::File& file, SharedDspResourceCache& cache, IRContainer& container)
+    {
+        const bool isContainer = file.hasFileExtension (IRContainer::fileExtension);
+        const auto containerFile = isContainer ? file : file.withFileExtension (IRContainer::fileExtension);
+
+        return containerFile.existsAsFile() && container.open (containerFile)
+            && (isContainer || container.getContentId() == cache.getFileContentId (file));
+    }
+
+    /** Time-domain IR at the playback rate, normalised, from a container's source block or the audio file. */
+    inline std::vector<float> loadConditionedSamples (const juce::File& file, double targetSampleRate,
+                                                      SharedDspResourceCache& cache, juce::String& error)
+    {
+        std::vector<float> mono;
+        double sourceSampleRate = 0.0;
+
+        IRContainer container;
+        if (openContainerFor (file, cache, container))
+        {
+            mono = container.getSource();
+            sourceSampleRate = container.getSourceSampleRate();
+        }
+        else if (! decodeImpulseResponse (file, mono, sourceSampleRate, error))
+        {
+            return {};
+        }
+
+        auto samples = conditionImpulseResponse (std::move (mono), sourceSampleRate, targetSampleRate);
+        if (samples.empty())
+            error = "Impulse response is silent: " + file.getFileName();
+
+        return samples;
+    }
+
+    /** Preprocesses conditioned samples and partitions the result, keeping the report with the IR. */
+    inline std::shared_ptr<const PartitionedIR> createPreprocessed (std::vector<float> samples, double sampleRate,
+                                                                    const Preprocessing& options, const juce::String& name)
+    {
+        const auto report = preprocessImpulseResponse (samples, sampleRate, options);
+        return PartitionedIR::create (samples.data(), (int) samples.size(), sampleRate, name, report);
+    }
+
+    /**
+        Loads an IR for the given rate, keyed by content, sample rate, partition
+        size and preprocessing: every instance loading the same IR at the same
+        rate shares one PartitionedIR, and only the first one pays for building
+        it. Without preprocessing a container is used straight from its mapping
+        when it holds the rate; anything else decodes the audio file (or
+        resamples the container's source block).
+    */
+    inline std::shared_ptr<const PartitionedIR> loadImpulseResponse (const juce::File& file, double targetSampleRate,
+                                                                     const Preprocessing& options,
+                                                                     SharedDspResourceCache& cache, juce::String& error)
+    {
+        IRContainer container;
+        const bool hasContainer = openContainerFor (file, cache, container);
+        const bool isContainer = file.hasFileExtension (IRContainer::fileExtension);
+
+        if (! hasContainer && (isContainer || ! file.existsAsFile()))
+        {
+            error = (isContainer ? "Invalid IR container: " : "File not found: ") + file.getFullPathName();
+            return nullptr;
+        }
+
+        const auto contentId = hasContainer ? container.getContentId() : cache.getFileContentId (file);
+        const auto name = hasContainer ? container.getName() : file.getFileNameWithoutExtension();
+
+        if (options.isEnabled())
+        {
+            return cache.getOrBuild<PartitionedIR> (makeCacheKey (contentId + "/" + options.getId(), targetSampleRate),
+                                                    [&]() -> std::shared_ptr<const PartitionedIR>
+            {
+                auto samples = loadConditionedSamples (file, targetSampleRate, cache, error);
+                return samples.empty() ? nullptr : createPreprocessed (std::move (samples), targetSampleRate, options, name);
+            });
+        }
+
+        if (hasContainer)
+        {
+            return cache.getOrBuild<PartitionedIR> (makeCacheKey (contentId, targetSampleRate), [&]
+            {
+                const int rateIndex = container.findRate (targetSampleRate);
+                if (rateIndex >= 0)
+                    return container.getPartitionedIR (rateIndex);
+
+                // Not one of the stored rates - still no decoding, just resample the stored source
+                const auto samples = conditionImpulseResponse (container.getSource(), container.getSourceSampleRate(), targetSampleRate);
+                return samples.empty() ? nullptr
+                                       : PartitionedIR::create (samples.data(), (int) samples.size(), targetSampleRate, name);
+            });
+        }
+
+        return cache.getOrBuild<PartitionedIR> (makeCacheKey (contentId, targetSampleRate),
+                                                [&] { return readImpulseResponse (file, targetSampleRate, error); });
+    }
+
+    //==============================================================================
+    /** One microphone of a multi-mic cabinet. */
+    struct MicSource
+    {
+        juce::File file;
+        float gainDecibels = 0.0f;     // Relative to the other mics; each IR is normalised first
+        float offsetMs = 0.0f;         // Alignment (time of arrival); only differences between mics matter
+    };
+
+    static constexpr int maxMics = 3;
+
+    inline juce::String blendToXmlString (const std::vector<MicSource>& mics)
+    {
+        juce::XmlElement xml ("CabinetBlend");
+        for (auto& mic : mics)
+        {
+            auto* element = xml.createNewChildElement ("Mic");
+            element->setAttribute ("file", mic.file.getFullPathName());
+            element->setAttribute ("gainDb", mic.gainDecibels);
+            element->setAttribute ("offsetMs", mic.offsetMs);
+        }
+
+        return xml.toString (juce::XmlElement::TextFormat().singleLine().withoutHeader());
+    }
+
+    inline std::vector<MicSource> blendFromXmlString (const juce::String& text)
+    {
+        std::vector<MicSource> mics;
+        if (auto xml = juce::parseXMLIfTagMatches (text, "CabinetBlend"))
+            for (auto* element : xml->getChildWithTagNameIterator ("Mic"))
+                if ((int) mics.size() < maxMics)
+                    mics.push_back ({ juce::File (element->getStringAttribute ("file")),
+                                      (float) element->getDoubleAttribute ("gainDb"),
+                                      (float) element->getDoubleAttribute ("offsetMs") });
+
+        return mics;
+    }
+
+    /**
+        Mixes several mic IRs (gain and alignment applied) into one composite IR
+        at the playback rate, so a blend convolves exactly like a single IR: the
+        cost per sample only depends on the length of the longest aligned mic.
+        Cached like single IRs, keyed by every mic's content, gain and offset.
+        Preprocessing applies to the composite, so the mics stay aligned.
+    */
+    inline std::shared_ptr<const PartitionedIR> blendImpulseResponses (const std::vector<MicSource>& mics, double targetSampleRate,
+                                                                       const Preprocessing& options,
+                                                                       SharedDspResourceCache& cache, juce::String& error)
+    {
+        if (mics.empty() || (int) mics.size() > maxMics)
+        {
+            error = "A blend needs 1 to " + juce::String (maxMics) + " mics";
+            return nullptr;
+        }
+
+        juce::String contentId ("blend");
+        float earliestMs = mics.front().offsetMs;
+
+        for (auto& mic : mics)
+        {
+            contentId << ":" << cache.getFileContentId (mic.file) << "," << mic.gainDecibels << "," << mic.offsetMs;
+            earliestMs = juce::jmin (earliestMs, mic.offsetMs);
+        }
+
+        if (options.isEnabled())
+            contentId << "/" << options.getId();
+
+        return cache.getOrBuild<PartitionedIR> (makeCacheKey (contentId, targetSampleRate),
+                                                [&]() -> std::shared_ptr<const PartitionedIR>
+        {
+            std::vector<float> composite;
+
+            for (auto& mic : mics)
+            {
+                const auto samples = loadConditionedSamples (mic.file, targetSampleRate, cache, error);
+                if (samples.empty())
+                    return nullptr;
+
+                // Whole-sample alignment, relative to the earliest mic
+                const auto offset = (size_t) juce::roundToInt ((mic.offsetMs - earliestMs) * 0.001 * targetSampleRate);
+                const auto maxLength = (size_t) (maxLengthSeconds * targetSampleRate);
+                const auto length = juce::jmin (samples.size(), maxLength - juce::jmin (offset, maxLength));
+
+                composite.resize (juce::jmax (composite.size(), offset + length), 0.0f);
+                juce::FloatVectorOperations::addWithMultiply (composite.data() + offset, samples.data(),
+                                                              juce::Decibels::decibelsToGain (mic.gainDecibels, -100.0f),
+                                                              (int) length);
+            }
+
+            // Same overall level as a single IR, whatever the mic gains
+            composite = conditionImpulseResponse (std::move (composite), targetSampleRate, targetSampleRate);
+            if (composite.empty())
+            {
+                error = "Blend is silent";
+                return nullptr;
+            }
+
+            return createPreprocessed (std::move (composite), targetSampleRate, options,
+                                       mics.size() == 1 ? mics.front().file.getFileNameWithoutExtension()
+                                                        : juce::String ((int) mics.size()) + "-mic blend");
+        });
+    }
+}
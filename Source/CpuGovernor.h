@@ -0,0 +1,275 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include "QualityTier.h"
+
+//==============================================================================
+/**
+    Picks a quality tier from how much pressure the audio threads are under.
+
+    Three signals feed it:
+
+    - this instance's load: its processing time divided by the block duration
+    - the session's load: the processing time of every GainForge instance in
+      the process, per second of wall clock and per audio thread they run on
+      (SharedLoad). Forty instances at 3% each never trip a per-instance
+      threshold, but together they fill a core
+    - dropouts: the wall clock running ahead of the audio the host asked for,
+      by more than 1.5 blocks. Gaps longer than 8 blocks are taken as the
+      transport stopping, not as a dropout
+
+    The larger of the two loads is smoothed. The governor steps down a tier
+    quickly when it stays above stepDownLoad, and steps up only after a long
+    stretch below stepUpLoad. After every step it holds off until the estimate
+    reflects the new tier, so it never oscillates between neighbours.
+
+    A dropout drops straight to the tier below the one running and caps the
+    governor there until the next prepare(): whatever ran when the host
+    missed a deadline is not tried again.
+
+    Audio thread only, apart from the atomic readouts.
+*/
+class CpuGovernor
+{
+public:
+    static constexpr float stepDownLoad = 0.70f;
+    static constexpr float stepUpLoad = 0.30f;
+
+    //==============================================================================
+    /**
+        Processing time of every instance in the process, and the threads it ran on.
+        Shared through juce::SharedResourcePointer; lock-free, so any instance's
+        audio thread can add to it.
+    */
+    class SharedLoad
+    {
+    public:
+        static constexpr int maxThreads = 32;
+
+        /** Audio thread: adds one callback's processing time and notes the thread it ran on. */
+        void add (juce::int64 busyTicks, juce::int64 nowTicks) noexcept
+        {
+            totalBusyTicks.fetch_add (busyTicks, std::memory_order_relaxed);
+            noteThread (nowTicks);
+        }
+
+        juce::int64 getBusyTicks() const noexcept    { return totalBusyTicks.load (std::memory_order_relaxed); }
+
+        /** Number of threads that ran an instance in the last second (at least 1). */
+        int getNumActiveThreads (juce::int64 nowTicks) const noexcept
+        {
+            int active = 0;
+            for (auto& slot : threads)
+                if (slot.id.load (std::memory_order_relaxed) != nullptr
+                     && nowTicks - slot.lastSeen.load (std::memory_order_relaxed) < staleTicks)
+                    ++active;
+
+            return juce::jmax (1, active);
+        }
+
+    private:
+        void noteThread (juce::int64 nowTicks) noexcept
+        {
+            const auto id = juce::Thread::getCurrentThreadId();
+
+            for (auto& slot : threads)
+            {
+                if (slot.id.load (std::memory_order_relaxed) == id)
+                {
+                    slot.lastSeen.store (nowTicks, std::memory_order_relaxed);
+                    return;
+                }
+            }
+
+            // Only this thread ever writes its own id, so a free or stale slot can be claimed with one CAS
+            for (auto& slot : threads)
+            {
+                auto current = slot.id.load (std::memory_order_relaxed);
+                const bool claimable = current == nullptr
+                                    || nowTicks - slot.lastSeen.load (std::memory_order_relaxed) >= staleTicks;
+
+                if (claimable && slot.id.compare_exchange_strong (current, id, std::memory_order_relaxed))
+                {
+                    slot.lastSeen.store (nowTicks, std::memory_order_relaxed);
+                    return;
+                }
+            }
+        }
+
+        struct Slot
+        {
+            std::atomic<juce::Thread::ThreadID> id { nullptr };
+            std::atomic<juce::int64> lastSeen { 0 };
+        };
+
+        const juce::int64 staleTicks = juce::Time::secondsToHighResolutionTicks (1.0);
+        std::array<Slot, maxThreads> threads;
+        std::atomic<juce::int64> totalBusyTicks { 0 };
+    };
+
+    //==============================================================================
+    void prepare (double newSampleRate, Quality::Tier startTier) noexcept
+    {
+        sampleRate = newSampleRate;
+        ceiling = Quality::Tier::high;
+        tier = startTier;
+        smoothedLoad.store (0.0f);
+        secondsOverBudget = secondsUnderBudget = 0.0;
+        holdOffSeconds = settleTime;
+        anchorTicks = windowStartTicks = 0;
+        sessionLoad = 0.0f;
+    }
+
+    /** Takes over from a tier chosen elsewhere (e.g. when switching from a manual tier to Auto). */
+    void setTier (Quality::Tier newTier) noexcept
+    {
+        tier = (Quality::Tier) juce::jmin ((int) newTier, (int) ceiling);
+        secondsOverBudget = secondsUnderBudget = 0.0;
+        holdOffSeconds = settleTime;
+    }
+
+    /** Call after processing a block with the ticks taken before it. Returns the tier to run next. */
+    Quality::Tier update (juce::int64 startTicks, int numSamples) noexcept
+    {
+        if (numSamples <= 0 || sampleRate <= 0.0)
+            return tier;
+
+        const auto endTicks = juce::Time::getHighResolutionTicks();
+        const double blockSeconds = numSamples / sampleRate;
+        const double usedSeconds = juce::Time::highResolutionTicksToSeconds (endTicks - startTicks);
+
+        sharedLoad->add (endTicks - startTicks, endTicks);
+        followClock (startTicks, blockSeconds);
+
+        const auto load = juce::jmax ((float) (usedSeconds / blockSeconds), updateSessionLoad (endTicks));
+
+        // One-pole smoothing with a ~200 ms time constant, independent of block size
+        const auto alpha = (float) (1.0 - std::exp (-blockSeconds / 0.2));
+        const float smoothed = smoothedLoad.load (std::memory_order_relaxed);
+        const float newLoad = smoothed + alpha * (load - smoothed);
+        smoothedLoad.store (newLoad, std::memory_order_relaxed);
+
+        if (holdOffSeconds > 0.0)
+        {
+            holdOffSeconds -= blockSeconds;
+            return tier;
+        }
+
+        secondsOverBudget = newLoad > stepDownLoad ? secondsOverBudget + blockSeconds : 0.0;
+        secondsUnderBudget = newLoad < stepUpLoad ? secondsUnderBudget + blockSeconds : 0.0;
+
+        if (secondsOverBudget > stepDownTime && tier != Quality::Tier::eco)
+            step (-1);
+        else if (secondsUnderBudget > stepUpTime && tier < ceiling)
+            step (1);
+
+        return tier;
+    }
+
+    /** For blocks that skip processing (bypass): keeps the dropout detector in step with the host's clock. */
+    void updateIdle (juce::int64 startTicks, int numSamples) noexcept
+    {
+        if (numSamples > 0 && sampleRate > 0.0)
+            followClock (startTicks, numSamples / sampleRate);
+    }
+
+    /** Smoothed load the decisions are based on: the higher of this instance's and the session's (1.0 = the whole budget). */
+    float getSmoothedLoad() const noexcept          { return smoothedLoad.load (std::memory_order_relaxed); }
+
+    /** Dropouts seen since the instance was created. */
+    int getNumDropouts() const noexcept             { return dropouts.load (std::memory_order_relaxed); }
+
+private:
+    static constexpr double stepDownTime = 0.25;
+    static constexpr double stepUpTime = 3.0;
+    static constexpr double settleTime = 1.0;
+    static constexpr double sessionWindow = 0.05;
+    static constexpr double lateBlocks = 1.5, pauseBlocks = 8.0;
+    static constexpr double reanchorSeconds = 10.0;    // Forgets the drift between the audio and system clocks
+
+    void step (int direction) noexcept
+    {
+        tier = (Quality::Tier) juce::jlimit (0, Quality::numLiveTiers - 1, (int) tier + direction);
+        secondsOverBudget = secondsUnderBudget = 0.0;
+        holdOffSeconds = settleTime;
+    }
+
+    /** Session load over the last window, refreshed every sessionWindow seconds. */
+    float updateSessionLoad (juce::int64 nowTicks) noexcept
+    {
+        const auto busyTicks = sharedLoad->getBusyTicks();
+
+        if (windowStartTicks == 0)
+        {
+            windowStartTicks = nowTicks;
+            windowStartBusyTicks = busyTicks;
+        }
+
+        const double elapsed = juce::Time::highResolutionTicksToSeconds (nowTicks - windowStartTicks);
+        if (elapsed >= sessionWindow)
+        {
+            const double busy = juce::Time::highResolutionTicksToSeconds (busyTicks - windowStartBusyTicks);
+            sessionLoad = (float) (busy / (elapsed * sharedLoad->getNumActiveThreads (nowTicks)));
+            windowStartTicks = nowTicks;
+            windowStartBusyTicks = busyTicks;
+        }
+
+        return sessionLoad;
+    }
+
+    void followClock (juce::int64 startTicks, double blockSeconds) noexcept
+    {
+        if (! detectDropout (startTicks, blockSeconds))
+            return;
+
+        ceiling = (Quality::Tier) juce::jmax (0, (int) tier - 1);
+        dropouts.store (dropouts.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+        if (tier != ceiling)
+            step ((int) ceiling - (int) tier);
+    }
+
+    /** True if the host fell behind real time before this block started. */
+    bool detectDropout (juce::int64 startTicks, double blockSeconds) noexcept
+    {
+        const double wallSeconds = anchorTicks != 0 ? juce::Time::highResolutionTicksToSeconds (startTicks - anchorTicks) : 0.0;
+        const double lag = wallSeconds - audioSeconds;  // Grows when callbacks arrive late; bursts of early ones lower it
+        bool late = false;
+
+        if (anchorTicks == 0 || lag - minimumLag > pauseBlocks * blockSeconds || wallSeconds > reanchorSeconds)
+        {
+            anchorTicks = startTicks;
+            audioSeconds = minimumLag = 0.0;
+        }
+        else if (lag - minimumLag > lateBlocks * blockSeconds)
+        {
+            late = true;
+            anchorTicks = startTicks;
+            audioSeconds = minimumLag = 0.0;
+        }
+        else
+        {
+            minimumLag = juce::jmin (minimumLag, lag);
+        }
+
+        audioSeconds += blockSeconds;
+        return late;
+    }
+
+    juce::SharedResourcePointer<SharedLoad> sharedLoad;
+
+    double sampleRate = 0.0;
+    Quality::Tier tier = Quality::Tier::standard;
+    Quality::Tier ceiling = Quality::Tier::high;
+    std::atomic<float> smoothedLoad { 0.0f };
+    std::atomic<int> dropouts { 0 };
+    double secondsOverBudget = 0.0, secondsUnderBudget = 0.0, holdOffSeconds = 0.0;
+
+    juce::int64 windowStartTicks = 0, windowStartBusyTicks = 0;
+    float sessionLoad = 0.0f;
+
+    juce::int64 anchorTicks = 0;
+    double audioSeconds = 0.0, minimumLag = 0.0;
+};
@@ -0,0 +1,330 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <vector>
+#include "PresetBank.h"
+#include "RealtimeLog.h"
+
+//==============================================================================
+/**
+    Always-on record of how close each live callback came to its deadline, for
+    working out GainForge's share of an xrun after the fact.
+
+    Every processBlock is timed against its real-time budget (block size over
+    sample rate). The audio thread adds the ratio to a log-bucketed histogram
+    and passes callbacks that make its local worst-N list through a lock-free
+    ring. Each instance has its own Monitor and is its only writer. A shared
+    Writer thread merges the worst callbacks, with their block size and
+    parameters, and rewrites a JSON summary in the log folder every few
+    seconds. Bounces are not recorded, because load means nothing offline.
+*/
+namespace DeadlineWatchdog
+{
+    /** One timed callback. */
+    struct Callback
+    {
+        juce::int64 ticks = 0;      // juce::Time::getHighResolutionTicks() at the end of the callback
+        float load = 0.0f;          // Processing time / block duration (1.0 = deadline missed)
+        float microseconds = 0.0f;
+        juce::int32 numSamples = 0;
+        ParameterSnapshot parameters;
+    };
+
+    //==============================================================================
+    class Monitor
+    {
+    public:
+        static constexpr int numWorst = 16;
+
+        // Log-spaced: 4 buckets per octave of load, from 1/1024 of the budget to 16x over it
+        static constexpr int bucketsPerOctave = 4;
+        static constexpr int lowestOctave = -10;
+        static constexpr int numBuckets = (4 - lowestOctave) * bucketsPerOctave;
+
+        /** Upper edge of a histogram bucket, as a load (the last bucket also holds everything above it). */
+        static double getBucketLimit (int bucket) noexcept
+        {
+            return std::exp2 ((double) (bucket + 1) / bucketsPerOctave + lowestOctave);
+        }
+
+        /** Before the audio thread starts (prepareToPlay). Statistics carry on across re-prepares. */
+        void prepare (double newSampleRate) noexcept
+        {
+            sampleRate = newSampleRate;
+            sampleRateForWriter.store (newSampleRate, std::memory_order_relaxed);
+        }
+
+        /** Audio thread: call after a callback with the ticks taken before it. */
+        void record (juce::int64 startTicks, int numSamples, const ParameterSnapshot& parameters) noexcept
+        {
+            if (numSamples <= 0 || sampleRate <= 0.0)
+                return;
+
+            const auto endTicks = juce::Time::getHighResolutionTicks();
+            const double usedSeconds = juce::Time::highResolutionTicksToSeconds (endTicks - startTicks);
+            const auto load = (float) (usedSeconds * sampleRate / numSamples);
+
+            // Single writer, so plain load/store rather than read-modify-write
+            auto increment = [] (auto& counter) { counter.store (counter.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed); };
+
+            increment (histogram[(size_t) getBucket (load)]);
+            increment (callbacks);
+            if (load >= 1.0f)
+                increment (overruns);
+
+            // Only callbacks that displace one of this thread's worst so far are passed on
+            auto lightest = std::min_element (worstLoads.begin(), worstLoads.end());
+            if (load <= *lightest)
+                return;
+
+            *lightest = load;
+
+            int start1, size1, start2, size2;
+            fifo.prepareToWrite (1, start1, size1, start2, size2);
+
+            if (size1 + size2 == 0)
+            {
+                increment (dropped);
+                return;
+            }
+
+            auto& callback = pending[(size_t) (size1 > 0 ? start1 : start2)];
+            callback.ticks = endTicks;
+            callback.load = load;
+            callback.microseconds = (float) (usedSeconds * 1.0e6);
+            callback.numSamples = numSamples;
+            callback.parameters = parameters;
+
+            fifo.finishedWrite (1);
+        }
+
+        //==============================================================================
+        /** Writer thread: merges newly recorded callbacks into a worst-first list of at most numWorst. */
+        void collectWorst (std::vector<Callback>& worst) noexcept
+        {
+            int start1, size1, start2, size2;
+            fifo.prepareToRead (fifo.getNumReady(), start1, size1, start2, size2);
+
+            for (int i = 0; i < size1; ++i)  worst.push_back (pending[(size_t) (start1 + i)]);
+            for (int i = 0; i < size2; ++i)  worst.push_back (pending[(size_t) (start2 + i)]);
+
+            fifo.finishedRead (size1 + size2);
+
+            std::sort (worst.begin(), worst.end(), [] (const Callback& a, const Callback& b) { return a.load > b.load; });
+            if (worst.size() > (size_t) numWorst)
+                worst.resize ((size_t) numWorst);
+        }
+
+        juce::uint64 getNumCallbacks() const noexcept           { return callbacks.load (std::memory_order_relaxed); }
+        juce::uint64 getNumOverruns() const noexcept            { return overruns.load (std::memory_order_relaxed); }
+        juce::uint32 getNumDropped() const noexcept             { return dropped.load (std::memory_order_relaxed); }
+        juce::uint32 getBucketCount (int bucket) const noexcept { return histogram[(size_t) bucket].load (std::memory_order_relaxed); }
+        double getSampleRate() const noexcept                   { return sampleRateForWriter.load (std::memory_order_relaxed); }
+
+    private:
+        static int getBucket (float load) noexcept
+        {
+            if (! (load > 0.0f))
+                return 0;
+
+            const int bucket = (int) std::floor ((std::log2 (load) - (float) lowestOctave) * (float) bucketsPerOctave);
+            return juce::jlimit (0, numBuckets - 1, bucket);
+        }
+
+        // Audio thread only
+        double sampleRate = 0.0;
+        std::array<float, numWorst> worstLoads {};
+
+        // Audio thread writes, writer thread reads
+        std::array<std::atomic<juce::uint32>, numBuckets> histogram {};
+        std::atomic<juce::uint64> callbacks { 0 }, overruns { 0 };
+        std::atomic<juce::uint32> dropped { 0 };
+        std::atomic<double> sampleRateForWriter { 0.0 };
+
+        juce::AbstractFifo fifo { 64 };
+        std::array<Callback, 64> pending {};
+    };
+
+    //==============================================================================
+    /** Times one processBlock call; does nothing when inactive (offline rendering). */
+    class ScopedCallback
+    {
+    public:
+        ScopedCallback (Monitor& m, int blockSize, const ParameterSnapshot& renderedParameters, bool isActive) noexcept
+            : monitor (m), parameters (renderedParameters), numSamples (blockSize),
+              startTicks (isActive ? juce::Time::getHighResolutionTicks() : 0)
+        {}
+
+        /** Reads the parameters at the end, so they are the ones the block was rendered with. */
+        ~ScopedCallback()
+        {
+            if (startTicks != 0)
+                monitor.record (startTicks, numSamples, parameters);
+        }
+
+    private:
+        Monitor& monitor;
+        const ParameterSnapshot& parameters;
+        const int numSamples;
+        const juce::int64 startTicks;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedCallback)
+    };
+
+    //==============================================================================
+    /**
+        Process-wide thread that rewrites GainForge_deadlines.json. Hold it through
+        juce::SharedResourcePointer so all instances share one thread and one file.
+        The summaries of removed instances stay in the file until the process exits.
+    */
+    class Writer : private juce::Thread
+    {
+    public:
+        static constexpr int writeIntervalMs = 5000;
+        static constexpr int maxRetired = 32;
+
+        Writer()
+            : juce::Thread ("GAINFORGE deadline watchdog"),
+              anchorTicks (juce::Time::getHighResolutionTicks()),
+              anchorMillis (juce::Time::currentTimeMillis())
+        {
+            file = RealtimeLog::Writer::getLogDirectory().getChildFile ("GainForge_deadlines.json");
+            startThread (juce::Thread::Priority::background);
+        }
+
+        ~Writer() override
+        {
+            stopThread (2000);
+        }
+
+        /** Message thread: start saving a monitor. It must stay alive until removeMonitor(). */
+        void addMonitor (Monitor* monitor, const juce::String& instanceName)
+        {
+            const juce::ScopedLock sl (lock);
+            sources.push_back ({ monitor, instanceName, {} });
+        }
+
+        void removeMonitor (Monitor* monitor)
+        {
+            const juce::ScopedLock sl (lock);
+
+            for (auto& source : sources)
+            {
+                if (source.monitor == monitor)
+                {
+                    retired.add (summarise (source));
+                    if (retired.size() > maxRetired)
+                        retired.remove (0);
+                }
+            }
+
+            sources.erase (std::remove_if (sources.begin(), sources.end(),
+                                           [monitor] (const Source& s) { return s.monitor == monitor; }),
+                           sources.end());
+            save();
+        }
+
+    private:
+        struct Source
+        {
+            Monitor* monitor;
+            juce::String name;
+            std::vector<Callback> worst;
+        };
+
+        void run() override
+        {
+            while (! threadShouldExit())
+            {
+                wait (writeIntervalMs);
+
+                const juce::ScopedLock sl (lock);
+                save();
+            }
+        }
+
+        // Called with lock held
+        juce::var summarise (Source& source)
+        {
+            auto& monitor = *source.monitor;
+            monitor.collectWorst (source.worst);
+
+            auto* instance = new juce::DynamicObject();
+            instance->setProperty ("instance", source.name);
+            instance->setProperty ("sampleRate", monitor.getSampleRate());
+            instance->setProperty ("callbacks", (juce::int64) monitor.getNumCallbacks());
+            instance->setProperty ("overruns", (juce::int64) monitor.getNumOverruns());
+            instance->setProperty ("worstDropped", (juce::int64) monitor.getNumDropped());
+
+            juce::Array<juce::var> histogram;
+            for (int bucket = 0; bucket < Monitor::numBuckets; ++bucket)
+            {
+                if (const auto count = monitor.getBucketCount (bucket))
+                {
+                    auto* row = new juce::DynamicObject();
+                    row->setProperty ("loadBelow", bucket == Monitor::numBuckets - 1 ? juce::var ("inf")
+                                                                                     : juce::var (Monitor::getBucketLimit (bucket)));
+                    row->setProperty ("count", (juce::int64) count);
+                    histogram.add (juce::var (row));
+                }
+            }
+            instance->setProperty ("histogram", histogram);
+
+            juce::Array<juce::var> worst;
+            for (const auto& callback : source.worst)
+            {
+                const auto millis = anchorMillis + (juce::int64) (1000.0 * juce::Time::highResolutionTicksToSeconds (callback.ticks - anchorTicks));
+
+                auto* row = new juce::DynamicObject();
+                row->setProperty ("time", juce::Time (millis).toISO8601 (true));
+                row->setProperty ("load", callback.load);
+                row->setProperty ("microseconds", callback.microseconds);
+                row->setProperty ("blockSize", callback.numSamples);
+
+                auto* parameters = new juce::DynamicObject();
+                for (int i = 0; i < ParameterSnapshot::numParameters; ++i)
+                    parameters->setProperty (ParameterSnapshot::getParameterID (i), callback.parameters[i]);
+                row->setProperty ("parameters", juce::var (parameters));
+
+                worst.add (juce::var (row));
+            }
+            instance->setProperty ("worst", worst);
+
+            return juce::var (instance);
+        }
+
+        // Called with lock held. Written through a temporary file so a crash never leaves half a summary
+        void save()
+        {
+            if (sources.empty() && retired.isEmpty())
+                return;
+
+            juce::Array<juce::var> instances (retired);
+            for (auto& source : sources)
+                instances.add (summarise (source));
+
+            auto* root = new juce::DynamicObject();
+            root->setProperty ("written", juce::Time::getCurrentTime().toISO8601 (true));
+            root->setProperty ("instances", instances);
+
+            file.getParentDirectory().createDirectory();
+            juce::TemporaryFile temporary (file);
+            if (temporary.getFile().replaceWithText (juce::JSON::toString (juce::var (root))))
+                temporary.overwriteTargetFileWithTemporary();
+        }
+
+        juce::CriticalSection lock;
+        std::vector<Source> sources;
+        juce::Array<juce::var> retired;
+
+        juce::File file;
+        const juce::int64 anchorTicks;
+        const juce::int64 anchorMillis;
+
+        JUCE_DECLARE_NON_COPYABLE (Writer)
+    };
+}
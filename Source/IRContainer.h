@@ -0,0 +1,288 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cstring>
+#include <vector>
+#include "CabinetConvolver.h"
+#include "SharedDspResources.h"
+
+//==============================================================================
+/**
+    Preprocessed cabinet IRs ('.gfir'): the IR already resampled to the common
+    session rates and transformed into the convolver's partition layout, so
+    loading one is a file mapping instead of decode + resample + FFTs.
+
+    Layout (little endian, native floats):
+        Header      (128 bytes) magic 'GFIR', version, partition size, rate count,
+                                source rate/length/offset, source content id, name
+        RateEntry   (32 bytes)  rate, length, head and spectra offsets; repeated
+        Data blocks, each 64-byte aligned:
+            source      float[sourceLength], the mono IR at its original rate
+            per rate    float[partitionSize] reversed head,
+                        complex<float>[partitions * (partitionSize + 1)] spectra
+
+    The convolver reads the spectra straight out of the mapping, so pages are
+    only read when first used and the OS shares them between processes.
+    Rates that aren't stored are resampled from the source block. The content
+    id is the one SharedDspResourceCache computes for the original audio
+    file, so a container and its WAV share cache entries (and a container
+    whose WAV has since changed is recognised as stale).
+*/
+class IRContainer
+{
+public:
+    static constexpr juce::uint32 magic = 0x52494647; // "GFIR" read as little endian
+    static constexpr juce::uint32 currentVersion = 1;
+    static constexpr int alignment = 64;
+    static constexpr int maxIdBytes = 32;
+    static constexpr int maxNameBytes = 56;
+    static constexpr const char* fileExtension = ".gfir";
+
+    struct Header
+    {
+        juce::uint32 magic;
+        juce::uint32 version;
+        juce::uint32 partitionSize;
+        juce::uint32 numRates;
+        double sourceSampleRate;
+        juce::uint32 sourceLength;
+        juce::uint32 reserved;
+        juce::uint64 sourceOffset;
+        char sourceId[maxIdBytes];
+        char name[maxNameBytes];
+    };
+
+    struct RateEntry
+    {
+        double sampleRate;
+        juce::uint32 length;
+        juce::uint32 reserved;
+        juce::uint64 headOffset;
+        juce::uint64 spectraOffset;
+    };
+
+    static_assert (sizeof (Header) == 128, "Header layout is part of the file format");
+    static_assert (sizeof (RateEntry) == 32, "RateEntry layout is part of the file format");
+
+    static juce::Array<double> getDefaultRates()    { return { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 }; }
+
+    //==============================================================================
+    /** Converts an audio file into a container holding the given rates. Blocking. */
+    static bool convert (const juce::File& source, const juce::File& dest, const juce::Array<double>& rates,
+                         juce::String& error)
+    {
+        std::vector<float> mono;
+        double sourceSampleRate = 0.0;
+        if (! Cabinet::decodeImpulseResponse (source, mono, sourceSampleRate, error))
+            return false;
+
+        const auto name = source.getFileNameWithoutExtension();
+        std::vector<std::shared_ptr<const Cabinet::PartitionedIR>> irs;
+
+        for (auto rate : rates)
+        {
+            const auto samples = Cabinet::conditionImpulseResponse (mono, sourceSampleRate, rate);
+            if (samples.empty())
+            {
+                error = "Impulse response is silent: " + source.getFileName();
+                return false;
+            }
+
+            irs.push_back (Cabinet::PartitionedIR::create (samples.data(), (int) samples.size(), rate, name));
+        }
+
+        Header header {};
+        header.magic = magic;
+        header.version = currentVersion;
+        header.partitionSize = (juce::uint32) Cabinet::partitionSize;
+        header.numRates = (juce::uint32) irs.size();
+        header.sourceSampleRate = sourceSampleRate;
+        header.sourceLength = (juce::uint32) mono.size();
+        copyString (SharedDspResourceCache::hashFileContents (source), header.sourceId, maxIdBytes);
+        copyString (name, header.name, maxNameBytes);
+
+        // Lay every block out on an aligned offset first, then write them in order
+        std::vector<RateEntry> entries (irs.size());
+        auto offset = align (sizeof (Header) + entries.size() * sizeof (RateEntry));
+        header.sourceOffset = offset;
+        offset = align (offset + mono.size() * sizeof (float));
+
+        for (size_t i = 0; i < irs.size(); ++i)
+        {
+            entries[i] = {};
+            entries[i].sampleRate = irs[i]->sampleRate;
+            entries[i].length = (juce::uint32) irs[i]->length;
+            entries[i].headOffset = offset;
+            offset = align (offset + Cabinet::partitionSize * sizeof (float));
+            entries[i].spectraOffset = offset;
+            offset = align (offset + (size_t) irs[i]->numPartitions * Cabinet::numBins * sizeof (Cabinet::Complex));
+        }
+
+        juce::FileOutputStream out (dest);
+        if (out.failedToOpen())
+        {
+            error = "Couldn't write " + dest.getFullPathName();
+            return false;
+        }
+
+        out.setPosition (0);
+        out.truncate();
+        out.write (&header, sizeof (header));
+        out.write (entries.data(), entries.size() * sizeof (RateEntry));
+
+        writeAt (out, header.sourceOffset, mono.data(), mono.size() * sizeof (float));
+
+        for (size_t i = 0; i < irs.size(); ++i)
+        {
+            writeAt (out, entries[i].headOffset, irs[i]->getReversedHead(), Cabinet::partitionSize * sizeof (float));
+            writeAt (out, entries[i].spectraOffset, irs[i]->getPartition (0),
+                     (size_t) irs[i]->numPartitions * Cabinet::numBins * sizeof (Cabinet::Complex));
+        }
+
+        out.flush();
+        if (! out.getStatus().wasOk())
+        {
+            error = out.getStatus().getErrorMessage();
+            return false;
+        }
+
+        return true;
+    }
+
+    //==============================================================================
+    /** Maps a container. Returns false (and stays closed) if it isn't valid for this build's engine. */
+    bool open (const juce::File& file)
+    {
+        close();
+
+       #if JUCE_BIG_ENDIAN
+        juce::ignoreUnused (file);
+        return false; // The data is used in place
+       #else
+        auto mapped = std::make_shared<juce::MemoryMappedFile> (file, juce::MemoryMappedFile::readOnly);
+        const auto size = (juce::uint64) mapped->getSize();
+        if (mapped->getData() == nullptr || size < sizeof (Header))
+            return false;
+
+        std::memcpy (&header, mapped->getData(), sizeof (header));
+
+        if (header.magic != magic || header.version != currentVersion
+             || header.partitionSize != (juce::uint32) Cabinet::partitionSize
+             || size < sizeof (Header) + (juce::uint64) header.numRates * sizeof (RateEntry)
+             || ! fits (header.sourceOffset, (juce::uint64) header.sourceLength * sizeof (float), size))
+            return false;
+
+        entries.resize (header.numRates);
+        std::memcpy (entries.data(), static_cast<const char*> (mapped->getData()) + sizeof (Header),
+                     entries.size() * sizeof (RateEntry));
+
+        for (auto& entry : entries)
+        {
+            const auto numPartitions = (juce::uint64) Cabinet::PartitionedIR::getNumPartitions ((int) entry.length);
+
+            if (entry.headOffset % alignof (float) != 0 || entry.spectraOffset % alignof (Cabinet::Complex) != 0
+                 || ! fits (entry.headOffset, Cabinet::partitionSize * sizeof (float), size)
+                 || ! fits (entry.spectraOffset, numPartitions * Cabinet::numBins * sizeof (Cabinet::Complex), size))
+            {
+                entries.clear();
+                return false;
+            }
+        }
+
+        mapping = std::move (mapped);
+        return true;
+       #endif
+    }
+
+    void close()
+    {
+        mapping.reset();
+        entries.clear();
+    }
+
+    bool isOpen() const noexcept                    { return mapping != nullptr; }
+
+    juce::String getName() const                    { return readString (header.name, maxNameBytes); }
+    juce::String getContentId() const               { return readString (header.sourceId, maxIdBytes); }
+    double getSourceSampleRate() const noexcept     { return header.sourceSampleRate; }
+
+    /** The mono IR at its original rate. */
+    std::vector<float> getSource() const
+    {
+        const auto* data = reinterpret_cast<const float*> (getData (header.sourceOffset));
+        return { data, data + header.sourceLength };
+    }
+
+    /** Index of the stored rate, or -1. */
+    int findRate (double sampleRate) const noexcept
+    {
+        for (size_t i = 0; i < entries.size(); ++i)
+            if (std::abs (entries[i].sampleRate - sampleRate) < 0.5)
+                return (int) i;
+
+        return -1;
+    }
+
+    /** The stored partitions for a rate, without copying. The IR keeps the mapping alive. */
+    std::shared_ptr<const Cabinet::PartitionedIR> getPartitionedIR (int rateIndex) const
+    {
+        auto& entry = entries[(size_t) rateIndex];
+        return Cabinet::PartitionedIR::createMapped (mapping,
+                                                     reinterpret_cast<const float*> (getData (entry.headOffset)),
+                                                     reinterpret_cast<const Cabinet::Complex*> (getData (entry.spectraOffset)),
+                                                     (int) entry.length, entry.sampleRate, getName());
+    }
+
+private:
+    static juce::uint64 align (juce::uint64 offset) noexcept   { return (offset + alignment - 1) / alignment * alignment; }
+
+    static bool fits (juce::uint64 offset, juce::uint64 bytes, juce::uint64 fileSize) noexcept
+    {
+        return offset <= fileSize && bytes <= fileSize - offset;
+    }
+
+    static void writeAt (juce::FileOutputStream& out, juce::uint64 offset, const void* data, size_t bytes)
+    {
+        // Zero padding up to the aligned start of the block
+        out.writeRepeatedByte (0, (size_t) (offset - (juce::uint64) out.getPosition()));
+
+        if (bytes > 0)
+            out.write (data, bytes);
+    }
+
+    static void copyString (const juce::String& text, char* dest, int maxBytes)
+    {
+        // Truncate on a character boundary so the stored UTF-8 stays valid
+        auto utf8 = text.toUTF8();
+        int bytes = 0;
+
+        for (auto p = utf8; ! p.isEmpty(); ++p)
+        {
+            const auto charBytes = (int) juce::CharPointer_UTF8::getBytesRequiredFor (*p);
+            if (bytes + charBytes > maxBytes)
+                break;
+
+            bytes += charBytes;
+        }
+
+        std::memcpy (dest, utf8.getAddress(), (size_t) bytes);
+    }
+
+    static juce::String readString (const char* source, int maxBytes)
+    {
+        int length = 0;
+        while (length < maxBytes && source[length] != 0)
+            ++length;
+
+        return juce::String::fromUTF8 (source, length);
+    }
+
+    const void* getData (juce::uint64 offset) const noexcept
+    {
+        return static_cast<const char*> (mapping->getData()) + offset;
+    }
+
+    std::shared_ptr<juce::MemoryMappedFile> mapping;
+    Header header {};
+    std::vector<RateEntry> entries;
+};
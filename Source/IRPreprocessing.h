@@ -0,0 +1,253 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+//==============================================================================
+/**
+    Load-time cabinet IR clean-up. Commercial IRs are often 0.5-1 s long, with
+    pre-delay in front and a long low-level tail, all of which costs
+    convolution CPU and memory for nothing audible.
+
+    - minimum phase: same magnitude response, energy moved to the front
+      (real-cepstrum folding), which also removes the pre-delay
+    - leading silence: drops everything before the IR reaches -60 dB of its peak
+    - tail truncation: cuts where the remaining energy falls below a threshold,
+      with a short raised-cosine fade
+
+    Runs once per load on the loader thread, before partitioning.
+*/
+namespace Cabinet
+{
+    struct Preprocessing
+    {
+        bool minimumPhase = false;
+        bool trimLeadingSilence = false;
+        float tailThresholdDb = 0.0f;  // Remaining energy relative to the total; 0 keeps the whole tail
+        float fadeMs = 5.0f;
+
+        bool isEnabled() const noexcept     { return minimumPhase || trimLeadingSilence || tailThresholdDb < 0.0f; }
+
+        /** For cache keys: IRs built with different settings must not be shared. */
+        juce::String getId() const
+        {
+            return juce::String (minimumPhase ? "mp" : "lp") + (trimLeadingSilence ? ",trim" : "")
+                 + ",t" + juce::String (tailThresholdDb, 1) + ",f" + juce::String (fadeMs, 1);
+        }
+
+        juce::String toXmlString() const
+        {
+            juce::XmlElement xml ("CabinetPreprocessing");
+            xml.setAttribute ("minimumPhase", minimumPhase);
+            xml.setAttribute ("trimLeadingSilence", trimLeadingSilence);
+            xml.setAttribute ("tailThresholdDb", tailThresholdDb);
+            xml.setAttribute ("fadeMs", fadeMs);
+            return xml.toString (juce::XmlElement::TextFormat().singleLine().withoutHeader());
+        }
+
+        static Preprocessing fromXmlString (const juce::String& text)
+        {
+            Preprocessing options;
+            if (auto xml = juce::parseXMLIfTagMatches (text, "CabinetPreprocessing"))
+            {
+                options.minimumPhase = xml->getBoolAttribute ("minimumPhase");
+                options.trimLeadingSilence = xml->getBoolAttribute ("trimLeadingSilence");
+                options.tailThresholdDb = juce::jmin (0.0f, (float) xml->getDoubleAttribute ("tailThresholdDb"));
+                options.fadeMs = juce::jmax (0.0f, (float) xml->getDoubleAttribute ("fadeMs", 5.0));
+            }
+
+            return options;
+        }
+    };
+
+    /** What preprocessing did to an IR: the error it introduced and how much shorter the IR got. */
+    struct PreprocessingReport
+    {
+        bool applied = false;
+        int originalLength = 0;
+        int processedLength = 0;
+        int leadingSamplesTrimmed = 0;
+        float removedEnergyDb = -144.0f;    // Energy cut off (pre-delay and tail), relative to the total
+        float maxMagnitudeErrorDb = 0.0f;   // Worst deviation of the magnitude response, 20 Hz - 20 kHz
+
+        /** Fraction of the IR length (and so of the FFT partitions' CPU and memory) saved. */
+        float getLengthSaving() const noexcept
+        {
+            return originalLength > 0 ? 1.0f - (float) processedLength / (float) originalLength : 0.0f;
+        }
+
+        juce::String toString() const
+        {
+            if (! applied)
+                return "Not preprocessed";
+
+            return "Length " + juce::String (originalLength) + " -> " + juce::String (processedLength) + " samples ("
+                 + juce::String (juce::roundToInt (getLengthSaving() * 100.0f)) + "% less convolution CPU), "
+                 + juce::String (leadingSamplesTrimmed) + " leading samples trimmed, removed energy "
+                 + juce::String (removedEnergyDb, 1) + " dB, max magnitude error " + juce::String (maxMagnitudeErrorDb, 2) + " dB";
+        }
+    };
+
+    namespace Detail
+    {
+        inline int getFftOrderFor (size_t numSamples) noexcept
+        {
+            int order = 8;
+            while ((size_t) (1 << order) < numSamples && order < 20)
+                ++order;
+
+            return order;
+        }
+
+        inline double getEnergy (const float* samples, size_t numSamples) noexcept
+        {
+            double energy = 0.0;
+            for (size_t i = 0; i < numSamples; ++i)
+                energy += (double) samples[i] * samples[i];
+
+            return energy;
+        }
+
+        /** Real-cepstrum minimum-phase reconstruction, zero padded 4x against cepstral aliasing. */
+        inline std::vector<float> makeMinimumPhase (const std::vector<float>& samples)
+        {
+            using Complex = std::complex<float>;
+
+            juce::dsp::FFT fft (getFftOrderFor (samples.size() * 4));
+            const auto size = (size_t) fft.getSize();
+            std::vector<Complex> a (size), b (size);
+
+            std::copy (samples.begin(), samples.end(), a.begin());
+            fft.perform (a.data(), b.data(), false);
+
+            // Log magnitude, floored at -140 dB so nulls don't blow up
+            for (size_t k = 0; k < size; ++k)
+                a[k] = std::log (juce::jmax (std::abs (b[k]), 1.0e-7f));
+
+            fft.perform (a.data(), b.data(), true);
+
+            // Fold the real cepstrum onto positive quefrencies
+            std::fill (a.begin(), a.end(), Complex());
+            a[0] = b[0].real();
+            for (size_t n = 1; n < size / 2; ++n)
+                a[n] = 2.0f * b[n].real();
+            a[size / 2] = b[size / 2].real();
+
+            fft.perform (a.data(), b.data(), false);
+
+            for (size_t k = 0; k < size; ++k)
+                a[k] = std::exp (b[k]);
+
+            fft.perform (a.data(), b.data(), true);
+
+            std::vector<float> result (samples.size());
+            for (size_t i = 0; i < result.size(); ++i)
+                result[i] = b[i].real();
+
+            return result;
+        }
+
+        /** Largest deviation between two magnitude responses over the audible band, ignoring deep nulls. */
+        inline float getMaxMagnitudeErrorDb (const std::vector<float>& reference, const std::vector<float>& processed, double sampleRate)
+        {
+            using Complex = std::complex<float>;
+
+            juce::dsp::FFT fft (getFftOrderFor (juce::jmax (reference.size(), processed.size()) * 2));
+            const auto size = (size_t) fft.getSize();
+            std::vector<Complex> input (size), referenceSpectrum (size), processedSpectrum (size);
+
+            std::copy (reference.begin(), reference.end(), input.begin());
+            fft.perform (input.data(), referenceSpectrum.data(), false);
+
+            std::fill (input.begin(), input.end(), Complex());
+            std::copy (processed.begin(), processed.end(), input.begin());
+            fft.perform (input.data(), processedSpectrum.data(), false);
+
+            const auto firstBin = (size_t) std::ceil (20.0 * (double) size / sampleRate);
+            const auto lastBin = juce::jmin (size / 2, (size_t) (juce::jmin (20000.0, sampleRate * 0.5) * (double) size / sampleRate));
+
+            float peak = 0.0f;
+            for (size_t k = firstBin; k <= lastBin; ++k)
+                peak = juce::jmax (peak, std::abs (referenceSpectrum[k]));
+
+            float maxError = 0.0f;
+            for (size_t k = firstBin; k <= lastBin; ++k)
+            {
+                const float magnitude = std::abs (referenceSpectrum[k]);
+                if (magnitude < peak * 0.001f) // More than 60 dB down
+                    continue;
+
+                const float error = std::abs (juce::Decibels::gainToDecibels (std::abs (processedSpectrum[k]), -200.0f)
+                                              - juce::Decibels::gainToDecibels (magnitude, -200.0f));
+                maxError = juce::jmax (maxError, error);
+            }
+
+            return maxError;
+        }
+    }
+
+    /** Applies the enabled steps to an IR in place and reports what they did. */
+    inline PreprocessingReport preprocessImpulseResponse (std::vector<float>& samples, double sampleRate, const Preprocessing& options)
+    {
+        PreprocessingReport report;
+        report.originalLength = report.processedLength = (int) samples.size();
+
+        if (! options.isEnabled() || samples.empty())
+            return report;
+
+        const auto original = samples;
+        const double totalEnergy = Detail::getEnergy (samples.data(), samples.size());
+        double removedEnergy = 0.0;
+
+        if (options.minimumPhase)
+            samples = Detail::makeMinimumPhase (samples);
+
+        if (options.trimLeadingSilence)
+        {
+            float peak = 0.0f;
+            for (auto s : samples)
+                peak = juce::jmax (peak, std::abs (s));
+
+            size_t first = 0;
+            while (first < samples.size() && std::abs (samples[first]) < peak * 0.001f)
+                ++first;
+
+            removedEnergy += Detail::getEnergy (samples.data(), first);
+            samples.erase (samples.begin(), samples.begin() + (ptrdiff_t) first);
+            report.leadingSamplesTrimmed = (int) first;
+        }
+
+        if (options.tailThresholdDb < 0.0f && ! samples.empty())
+        {
+            // Cut where what's left falls below the threshold (relative to the IR's total energy)
+            const double limit = Detail::getEnergy (samples.data(), samples.size())
+                               * std::pow (10.0, (double) options.tailThresholdDb / 10.0);
+            double remaining = 0.0;
+            size_t end = samples.size();
+
+            while (end > 1 && remaining + (double) samples[end - 1] * samples[end - 1] <= limit)
+            {
+                --end;
+                remaining += (double) samples[end] * samples[end];
+            }
+
+            removedEnergy += remaining;
+            samples.resize (end);
+
+            const auto fadeLength = juce::jmin (samples.size(), (size_t) (options.fadeMs * 0.001 * sampleRate));
+            for (size_t i = 0; i < fadeLength; ++i)
+            {
+                const auto t = (double) (i + 1) / (double) (fadeLength + 1);
+                samples[samples.size() - 1 - i] *= (float) (0.5 - 0.5 * std::cos (juce::MathConstants<double>::pi * t));
+            }
+        }
+
+        report.applied = true;
+        report.processedLength = (int) samples.size();
+        report.removedEnergyDb = (float) (10.0 * std::log10 (juce::jmax (removedEnergy / juce::jmax (totalEnergy, 1.0e-30), 1.0e-15)));
+        report.maxMagnitudeErrorDb = Detail::getMaxMagnitudeErrorDb (original, samples, sampleRate);
+        return report;
+    }
+}
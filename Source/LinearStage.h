@@ -0,0 +1,186 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <memory>
+#include <vector>
+#include "CabinetConvolver.h"
+#include "PresetBank.h"
+#include "RectifierToneStack.h"
+
+//==============================================================================
+/**
+    Everything after the nonlinearity - tone stack, presence, cabinet and
+    master gain - is linear and time-invariant while the knobs are still, so
+    it can be rendered into one impulse response and run as one convolution.
+
+    The filter designs live here so the live filters and the renderer can't
+    drift apart. A MergedKernel remembers what it was rendered for; the amp
+    only uses it while the knobs and the cabinet still match, and falls back
+    to the live filters (crossfading) as soon as anything moves.
+*/
+namespace LinearStage
+{
+    inline std::array<float, 6> designBass (double sampleRate, float bass)
+    {
+        // Mesa Boogie Triple Rectifier tone stack frequencies (authentic values)
+        // Bass: Low shelf at 80Hz - very powerful low end
+        return juce::dsp::IIR::ArrayCoefficients<float>::makeLowShelf (
+            sampleRate, 80.0f, 0.707f,
+            juce::jmap (bass, 0.12f, 4.2f) // 0.0 -> 0.12x, 1.0 -> 4.2x (massive bass boost capability)
+        );
+    }
+
+    inline std::array<float, 6> designMid (double sampleRate, float mid)
+    {
+        // Mid: Peaking at 800Hz with wider Q for classic scooped mids (Rectifier signature)
+        // Rectifier mids can go very low (scooped) - this is the key to the Rectifier sound
+        return juce::dsp::IIR::ArrayCoefficients<float>::makePeakFilter (
+            sampleRate, 800.0f, 0.65f, // Wider Q (0.65) for more pronounced scoop
+            juce::jmap (mid, 0.08f, 2.4f) // 0.0 -> 0.08x (very scooped), 1.0 -> 2.4x
+        );
+    }
+
+    inline std::array<float, 6> designTreble (double sampleRate, float treble)
+    {
+        // Treble: High shelf at 2500Hz - bright and cutting
+        return juce::dsp::IIR::ArrayCoefficients<float>::makeHighShelf (
+            sampleRate, 2500.0f, 0.707f,
+            juce::jmap (treble, 0.18f, 2.8f) // 0.0 -> 0.18x, 1.0 -> 2.8x (bright)
+        );
+    }
+
+    inline std::array<float, 6> designPresence (double sampleRate, float presence)
+    {
+        // Presence: High shelf at 5500Hz - articulation and high-end clarity (shared by both tone stacks)
+        return juce::dsp::IIR::ArrayCoefficients<float>::makeHighShelf (
+            sampleRate, 5500.0f, 0.707f,
+            juce::jmap (presence, 0.15f, 2.6f) // 0.0 -> 0.15x, 1.0 -> 2.6x
+        );
+    }
+
+    inline float getMasterGain (float master) noexcept
+    {
+        return 0.15f + master * 11.85f; // 0.15x to 12x (Rectifier master)
+    }
+
+    //==============================================================================
+    /** The knob positions a kernel bakes in. */
+    struct Settings
+    {
+        float bass = 0.5f, mid = 0.5f, treble = 0.5f, presence = 0.5f, master = 0.0f;
+        bool passive = false;
+
+        static Settings fromParameters (const ParameterSnapshot& parameters) noexcept
+        {
+            return { parameters[ParameterSnapshot::bass], parameters[ParameterSnapshot::mid],
+                     parameters[ParameterSnapshot::treble], parameters[ParameterSnapshot::presence],
+                     parameters[ParameterSnapshot::master], parameters[ParameterSnapshot::toneStack] > 0.5f };
+        }
+
+        bool operator== (const Settings& other) const noexcept
+        {
+            return bass == other.bass && mid == other.mid && treble == other.treble
+                && presence == other.presence && master == other.master && passive == other.passive;
+        }
+
+        bool operator!= (const Settings& other) const noexcept     { return ! operator== (other); }
+    };
+
+    /** One channel's merged stage, with what it was rendered for. */
+    struct MergedKernel
+    {
+        Settings settings;
+        const Cabinet::PartitionedIR* cabinet = nullptr;   // Identity only; the convolver owns the merged IR
+        std::unique_ptr<Cabinet::Convolver> convolver;
+
+        bool matches (const Settings& current, const Cabinet::PartitionedIR* currentCabinet) const noexcept
+        {
+            return cabinet == currentCabinet && settings == current;
+        }
+    };
+
+    //==============================================================================
+    /**
+        Renders tone stack, presence, cabinet and master into one IR. The
+        passive stack needs its coefficient table (nullptr renders the classic
+        stack, as the amp does before the table is ready). Blocking.
+    */
+    inline std::shared_ptr<const Cabinet::PartitionedIR> renderKernel (const Settings& settings, const Cabinet::PartitionedIR& cabinet,
+                                                                       double sampleRate,
+                                                                       const RectifierToneStack::CoefficientTable* toneStackTable)
+    {
+        // Tone stack and presence, until the response has died away (at most 200 ms)
+        juce::dsp::IIR::Filter<float> filters[4];
+        RectifierToneStack::Filter passiveStack;
+        const bool passive = settings.passive && toneStackTable != nullptr;
+
+        *filters[0].coefficients = designBass (sampleRate, settings.bass);
+        *filters[1].coefficients = designMid (sampleRate, settings.mid);
+        *filters[2].coefficients = designTreble (sampleRate, settings.treble);
+        *filters[3].coefficients = designPresence (sampleRate, settings.presence);
+        if (passive)
+            passiveStack.setCoefficients (toneStackTable->lookup (settings.bass, settings.mid, settings.treble));
+
+        for (auto& filter : filters)
+            filter.reset();
+
+        constexpr int chunk = 256;
+        const int maxToneLength = juce::jmax (chunk, (int) (0.2 * sampleRate));
+        std::vector<float> tone;
+        double totalEnergy = 0.0;
+
+        while ((int) tone.size() < maxToneLength)
+        {
+            const auto start = tone.size();
+            tone.resize (start + chunk, 0.0f);
+            if (start == 0)
+                tone[0] = 1.0f;
+
+            double chunkEnergy = 0.0;
+            for (size_t i = start; i < tone.size(); ++i)
+            {
+                float x = tone[i];
+                if (passive)
+                    x = passiveStack.processSample (x);
+                else
+                    for (int f = 0; f < 3; ++f)
+                        x = filters[f].processSample (x);
+
+                tone[i] = filters[3].processSample (x);
+                chunkEnergy += (double) tone[i] * tone[i];
+            }
+
+            totalEnergy += chunkEnergy;
+            if (chunkEnergy < totalEnergy * 1.0e-12)
+                break;
+        }
+
+        // Convolve with the cabinet (FFT, zero padded past the full length)
+        const auto cabinetSamples = cabinet.getImpulseResponse();
+        const auto length = tone.size() + cabinetSamples.size() - 1;
+
+        int order = 1;
+        while ((size_t) (1 << order) < length)
+            ++order;
+
+        juce::dsp::FFT fft (order);
+        const auto size = (size_t) fft.getSize();
+        std::vector<float> a (2 * size, 0.0f), b (2 * size, 0.0f);
+        std::copy (tone.begin(), tone.end(), a.begin());
+        std::copy (cabinetSamples.begin(), cabinetSamples.end(), b.begin());
+        fft.performRealOnlyForwardTransform (a.data(), true);
+        fft.performRealOnlyForwardTransform (b.data(), true);
+
+        auto* spectrumA = reinterpret_cast<std::complex<float>*> (a.data());
+        const auto* spectrumB = reinterpret_cast<const std::complex<float>*> (b.data());
+        const float gain = getMasterGain (settings.master);
+
+        for (size_t k = 0; k <= size / 2; ++k)
+            spectrumA[k] *= spectrumB[k] * gain;
+
+        fft.performRealOnlyInverseTransform (a.data());
+
+        return Cabinet::PartitionedIR::create (a.data(), (int) length, sampleRate, cabinet.name + " (merged)");
+    }
+}
@@ -0,0 +1,415 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+//==============================================================================
+/**
+    Inference engine for captured amp profiles (single-layer GRU/LSTM plus a
+    dense output, as exported by Automated-GuitarAmpModelling / GuitarML).
+
+    Layer sizes are template parameters, so every matrix-vector product has
+    compile-time bounds. Weights are stored transposed (one column per hidden
+    input) so the inner loops are straight multiply-accumulates over contiguous
+    arrays that the compiler unrolls and vectorises. Nothing is allocated after
+    a model has been loaded.
+*/
+namespace NeuralAmp
+{
+    enum class UnitType { gru, lstm };
+
+    inline float sigmoid (float x) noexcept { return 1.0f / (1.0f + std::exp (-x)); }
+
+    //==============================================================================
+    /** PyTorch gate order: r, z, n. */
+    template <int HiddenSize>
+    struct GruCell
+    {
+        static constexpr int hiddenSize = HiddenSize;
+        static constexpr int numGates = 3;
+        static constexpr UnitType type = UnitType::gru;
+
+        alignas (16) std::array<float, numGates * HiddenSize> inputWeights {};
+        alignas (16) std::array<float, numGates * HiddenSize> inputBias {};
+        alignas (16) std::array<float, numGates * HiddenSize> hiddenBias {};
+        alignas (16) std::array<std::array<float, numGates * HiddenSize>, HiddenSize> hiddenWeightsT {};
+
+        alignas (16) std::array<float, HiddenSize> h {};
+
+        void reset() noexcept { h.fill (0.0f); }
+
+        inline void step (float x) noexcept
+        {
+            alignas (16) std::array<float, numGates * HiddenSize> hh = hiddenBias;
+
+            for (int j = 0; j < HiddenSize; ++j)
+            {
+                const float hj = h[(size_t) j];
+                for (int i = 0; i < numGates * HiddenSize; ++i)
+                    hh[(size_t) i] += hiddenWeightsT[(size_t) j][(size_t) i] * hj;
+            }
+
+            for (int i = 0; i < HiddenSize; ++i)
+            {
+                const auto r = (size_t) i;
+                const auto z = (size_t) (HiddenSize + i);
+                const auto n = (size_t) (2 * HiddenSize + i);
+
+                const float rGate = sigmoid (inputWeights[r] * x + inputBias[r] + hh[r]);
+                const float zGate = sigmoid (inputWeights[z] * x + inputBias[z] + hh[z]);
+                const float nGate = std::tanh (inputWeights[n] * x + inputBias[n] + rGate * hh[n]);
+
+                h[(size_t) i] = (1.0f - zGate) * nGate + zGate * h[(size_t) i];
+            }
+        }
+    };
+
+    /** PyTorch gate order: i, f, g, o. */
+    template <int HiddenSize>
+    struct LstmCell
+    {
+        static constexpr int hiddenSize = HiddenSize;
+        static constexpr int numGates = 4;
+        static constexpr UnitType type = UnitType::lstm;
+
+        alignas (16) std::array<float, numGates * HiddenSize> inputWeights {};
+        alignas (16) std::array<float, numGates * HiddenSize> inputBias {};
+        alignas (16) std::array<float, numGates * HiddenSize> hiddenBias {};
+        alignas (16) std::array<std::array<float, numGates * HiddenSize>, HiddenSize> hiddenWeightsT {};
+
+        alignas (16) std::array<float, HiddenSize> h {};
+        alignas (16) std::array<float, HiddenSize> c {};
+
+        void reset() noexcept { h.fill (0.0f); c.fill (0.0f); }
+
+        inline void step (float x) noexcept
+        {
+            alignas (16) std::array<float, numGates * HiddenSize> gates {};
+
+            for (int i = 0; i < numGates * HiddenSize; ++i)
+                gates[(size_t) i] = inputWeights[(size_t) i] * x + inputBias[(size_t) i] + hiddenBias[(size_t) i];
+
+            for (int j = 0; j < HiddenSize; ++j)
+            {
+                const float hj = h[(size_t) j];
+                for (int i = 0; i < numGates * HiddenSize; ++i)
+                    gates[(size_t) i] += hiddenWeightsT[(size_t) j][(size_t) i] * hj;
+            }
+
+            for (int i = 0; i < HiddenSize; ++i)
+            {
+                const float inGate     = sigmoid (gates[(size_t) i]);
+                const float forgetGate = sigmoid (gates[(size_t) (HiddenSize + i)]);
+                const float cellGate   = std::tanh (gates[(size_t) (2 * HiddenSize + i)]);
+                const float outGate    = sigmoid (gates[(size_t) (3 * HiddenSize + i)]);
+
+                c[(size_t) i] = forgetGate * c[(size_t) i] + inGate * cellGate;
+                h[(size_t) i] = outGate * std::tanh (c[(size_t) i]);
+            }
+        }
+    };
+
+    //==============================================================================
+    /** Type-erased model so the audio thread doesn't need to know the layer shape. */
+    class Model
+    {
+    public:
+        virtual ~Model() = default;
+
+        virtual float processSample (float input) noexcept = 0;
+        virtual void reset() noexcept = 0;
+        virtual std::unique_ptr<Model> clone() const = 0;
+
+        virtual UnitType getUnitType() const noexcept = 0;
+        virtual int getHiddenSize() const noexcept = 0;
+        virtual size_t getSizeInBytes() const noexcept = 0;
+
+        void process (float* data, int numSamples) noexcept
+        {
+            for (int i = 0; i < numSamples; ++i)
+                data[i] = processSample (data[i]);
+        }
+
+        juce::String name;
+        double sampleRate = 48000.0;        // Rate the capture was trained at
+        bool sampleRateDeclared = false;    // False if the file doesn't say, and 48 kHz is a guess
+
+        /** A recurrent capture only models the amp at the rate it was trained at. */
+        bool canRunAt (double hostSampleRate) const noexcept
+        {
+            return ! sampleRateDeclared || std::abs (hostSampleRate - sampleRate) < 1.0;
+        }
+    };
+
+    template <typename CellType>
+    class RecurrentModel : public Model
+    {
+    public:
+        static constexpr int hiddenSize = CellType::hiddenSize;
+
+        float processSample (float input) noexcept override
+        {
+            cell.step (input);
+
+            float y = outputBias;
+            for (int i = 0; i < hiddenSize; ++i)
+                y += outputWeights[(size_t) i] * cell.h[(size_t) i];
+
+            return skipConnection ? y + input : y;
+        }
+
+        void reset() noexcept override                       { cell.reset(); }
+        std::unique_ptr<Model> clone() const override        { return std::make_unique<RecurrentModel> (*this); }
+        UnitType getUnitType() const noexcept override       { return CellType::type; }
+        int getHiddenSize() const noexcept override          { return hiddenSize; }
+        size_t getSizeInBytes() const noexcept override      { return sizeof (*this) + (size_t) name.getNumBytesAsUTF8(); }
+
+        /** Copies PyTorch-layout weights in, returning false if any tensor has the wrong size. */
+        bool setWeights (const std::vector<float>& weightIH, const std::vector<float>& weightHH,
+                         const std::vector<float>& biasIH, const std::vector<float>& biasHH,
+                         const std::vector<float>& linWeight, float linBias)
+        {
+            constexpr int rows = CellType::numGates * hiddenSize;
+
+            if ((int) weightIH.size() != rows || (int) weightHH.size() != rows * hiddenSize
+                 || (int) biasIH.size() != rows || (int) biasHH.size() != rows
+                 || (int) linWeight.size() != hiddenSize)
+                return false;
+
+            for (int i = 0; i < rows; ++i)
+            {
+                cell.inputWeights[(size_t) i] = weightIH[(size_t) i];
+                cell.inputBias[(size_t) i] = biasIH[(size_t) i];
+                cell.hiddenBias[(size_t) i] = biasHH[(size_t) i];
+
+                for (int j = 0; j < hiddenSize; ++j)
+                    cell.hiddenWeightsT[(size_t) j][(size_t) i] = weightHH[(size_t) (i * hiddenSize + j)];
+            }
+
+            for (int i = 0; i < hiddenSize; ++i)
+                outputWeights[(size_t) i] = linWeight[(size_t) i];
+
+            outputBias = linBias;
+            cell.reset();
+            return true;
+        }
+
+        bool skipConnection = true;
+
+    private:
+        CellType cell;
+        alignas (16) std::array<float, hiddenSize> outputWeights {};
+        float outputBias = 0.0f;
+    };
+
+    //==============================================================================
+    /** Hidden sizes with a compiled engine. */
+    static constexpr std::array<int, 5> supportedHiddenSizes { 8, 16, 20, 32, 40 };
+
+    template <template <int> class Cell>
+    std::unique_ptr<Model> createUninitialised (int hiddenSize)
+    {
+        switch (hiddenSize)
+        {
+            case 8:  return std::make_unique<RecurrentModel<Cell<8>>>();
+            case 16: return std::make_unique<RecurrentModel<Cell<16>>>();
+            case 20: return std::make_unique<RecurrentModel<Cell<20>>>();
+            case 32: return std::make_unique<RecurrentModel<Cell<32>>>();
+            case 40: return std::make_unique<RecurrentModel<Cell<40>>>();
+            default: return {};
+        }
+    }
+
+    namespace detail
+    {
+        inline void flatten (const juce::var& v, std::vector<float>& out)
+        {
+            if (auto* array = v.getArray())
+            {
+                for (auto& element : *array)
+                    flatten (element, out);
+            }
+            else if (v.isDouble() || v.isInt() || v.isInt64())
+            {
+                out.push_back ((float) (double) v);
+            }
+        }
+
+        inline std::vector<float> tensor (const juce::var& stateDict, const char* key)
+        {
+            std::vector<float> out;
+            flatten (stateDict.getProperty (key, {}), out);
+            return out;
+        }
+
+        template <template <int> class Cell>
+        bool assign (Model& model, int hiddenSize, const std::vector<float>& wih, const std::vector<float>& whh,
+                     const std::vector<float>& bih, const std::vector<float>& bhh,
+                     const std::vector<float>& linW, float linB, bool skip)
+        {
+            bool ok = false;
+
+            auto tryAssign = [&] (auto* typed)
+            {
+                if (typed != nullptr)
+                {
+                    ok = typed->setWeights (wih, whh, bih, bhh, linW, linB);
+                    typed->skipConnection = skip;
+                }
+            };
+
+            switch (hiddenSize)
+            {
+                case 8:  tryAssign (dynamic_cast<RecurrentModel<Cell<8>>*>  (&model)); break;
+                case 16: tryAssign (dynamic_cast<RecurrentModel<Cell<16>>*> (&model)); break;
+                case 20: tryAssign (dynamic_cast<RecurrentModel<Cell<20>>*> (&model)); break;
+                case 32: tryAssign (dynamic_cast<RecurrentModel<Cell<32>>*> (&model)); break;
+                case 40: tryAssign (dynamic_cast<RecurrentModel<Cell<40>>*> (&model)); break;
+                default: break;
+            }
+
+            return ok;
+        }
+    }
+
+    /**
+        Builds a model from the Automated-GuitarAmpModelling JSON layout:
+        { "model_data": { "unit_type", "hidden_size", "skip" }, "state_dict": { "rec.*", "lin.*" } }
+    */
+    inline std::unique_ptr<Model> createFromJson (const juce::var& json, juce::String& error)
+    {
+        const auto modelData = json.getProperty ("model_data", {});
+        const auto stateDict = json.getProperty ("state_dict", {});
+
+        if (! modelData.isObject() || ! stateDict.isObject())
+        {
+            error = "Missing model_data or state_dict";
+            return {};
+        }
+
+        const auto unitName = modelData.getProperty ("unit_type", "LSTM").toString().toUpperCase();
+        const int hiddenSize = (int) modelData.getProperty ("hidden_size", 0);
+        const bool skip = (int) modelData.getProperty ("skip", 1) != 0;
+
+        if ((int) modelData.getProperty ("input_size", 1) != 1 || (int) modelData.getProperty ("num_layers", 1) != 1)
+        {
+            error = "Only single-layer mono-input models are supported";
+            return {};
+        }
+
+        const bool isGru = unitName == "GRU";
+        if (! isGru && unitName != "LSTM")
+        {
+            error = "Unsupported unit type: " + unitName;
+            return {};
+        }
+
+        auto model = isGru ? createUninitialised<GruCell> (hiddenSize)
+                           : createUninitialised<LstmCell> (hiddenSize);
+
+        if (model == nullptr)
+        {
+            error = "Unsupported hidden size: " + juce::String (hiddenSize);
+            return {};
+        }
+
+        const auto linBias = detail::tensor (stateDict, "lin.bias");
+        const auto ok = isGru
+            ? detail::assign<GruCell> (*model, hiddenSize,
+                                       detail::tensor (stateDict, "rec.weight_ih_l0"), detail::tensor (stateDict, "rec.weight_hh_l0"),
+                                       detail::tensor (stateDict, "rec.bias_ih_l0"), detail::tensor (stateDict, "rec.bias_hh_l0"),
+                                       detail::tensor (stateDict, "lin.weight"), linBias.empty() ? 0.0f : linBias.front(), skip)
+            : detail::assign<LstmCell> (*model, hiddenSize,
+                                        detail::tensor (stateDict, "rec.weight_ih_l0"), detail::tensor (stateDict, "rec.weight_hh_l0"),
+                                        detail::tensor (stateDict, "rec.bias_ih_l0"), detail::tensor (stateDict, "rec.bias_hh_l0"),
+                                        detail::tensor (stateDict, "lin.weight"), linBias.empty() ? 0.0f : linBias.front(), skip);
+
+        if (! ok)
+        {
+            error = "Weight tensors don't match the declared layer shape";
+            return {};
+        }
+
+        const auto declaredRate = modelData.getProperty ("sample_rate", json.getProperty ("samplerate", {}));
+        model->sampleRateDeclared = ! declaredRate.isVoid();
+        if (model->sampleRateDeclared)
+            model->sampleRate = (double) declaredRate;
+
+        return model;
+    }
+
+    /** Reads and parses a capture file. Blocking - call from a background thread. */
+    inline std::unique_ptr<Model> loadFromFile (const juce::File& file, juce::String& error)
+    {
+        if (! file.existsAsFile())
+        {
+            error = "File not found: " + file.getFullPathName();
+            return {};
+        }
+
+        const auto json = juce::JSON::parse (file);
+        auto model = createFromJson (json, error);
+
+        if (model != nullptr)
+            model->name = file.getFileNameWithoutExtension();
+
+        return model;
+    }
+
+    //==============================================================================
+    /** Small random weights, for benchmarking a layer shape without a capture file. */
+    inline std::unique_ptr<Model> createRandomised (UnitType type, int hiddenSize, juce::int64 seed = 1)
+    {
+        auto model = type == UnitType::gru ? createUninitialised<GruCell> (hiddenSize)
+                                           : createUninitialised<LstmCell> (hiddenSize);
+        if (model == nullptr)
+            return {};
+
+        const int rows = (type == UnitType::gru ? 3 : 4) * hiddenSize;
+        juce::Random random (seed);
+        auto fill = [&random] (int size)
+        {
+            std::vector<float> v ((size_t) size);
+            for (auto& x : v)
+                x = (random.nextFloat() - 0.5f) * 0.2f;
+            return v;
+        };
+
+        const auto ok = type == UnitType::gru
+            ? detail::assign<GruCell>  (*model, hiddenSize, fill (rows), fill (rows * hiddenSize), fill (rows), fill (rows), fill (hiddenSize), 0.0f, true)
+            : detail::assign<LstmCell> (*model, hiddenSize, fill (rows), fill (rows * hiddenSize), fill (rows), fill (rows), fill (hiddenSize), 0.0f, true);
+
+        jassert (ok);
+        juce::ignoreUnused (ok);
+        model->name = juce::String (type == UnitType::gru ? "GRU-" : "LSTM-") + juce::String (hiddenSize);
+        return model;
+    }
+
+    /**
+        Processing time divided by audio duration (lower is better; 1.0 means
+        the model only just keeps up on one core).
+    */
+    inline double measureRealTimeFactor (Model& model, double sampleRate, int blockSize, double seconds)
+    {
+        std::vector<float> block ((size_t) blockSize);
+        juce::Random random (42);
+        const auto numBlocks = juce::jmax (1, (int) (seconds * sampleRate / blockSize));
+
+        model.reset();
+        const auto start = juce::Time::getHighResolutionTicks();
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            for (auto& x : block)
+                x = random.nextFloat() * 2.0f - 1.0f;
+
+            model.process (block.data(), blockSize);
+        }
+
+        const auto elapsed = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+        return elapsed / ((double) numBlocks * blockSize / sampleRate);
+    }
+}
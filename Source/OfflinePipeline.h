@@ -0,0 +1,214 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <functional>
+
+//==============================================================================
+/** Wait-free single-producer/single-consumer queue of small trivially copyable items. */
+template <typename ItemType, int capacity>
+class SpscQueue
+{
+public:
+    bool push (const ItemType& item) noexcept
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite (1, start1, size1, start2, size2);
+
+        if (size1 + size2 == 0)
+            return false;
+
+        items[(size_t) (size1 > 0 ? start1 : start2)] = item;
+        fifo.finishedWrite (1);
+        return true;
+    }
+
+    bool pop (ItemType& item) noexcept
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead (1, start1, size1, start2, size2);
+
+        if (size1 + size2 == 0)
+            return false;
+
+        item = items[(size_t) (size1 > 0 ? start1 : start2)];
+        fifo.finishedRead (1);
+        return true;
+    }
+
+    void clear() noexcept           { fifo.reset(); }
+
+private:
+    juce::AbstractFifo fifo { capacity };
+    std::array<ItemType, (size_t) capacity> items {};
+};
+
+//==============================================================================
+/**
+    Runs the first stage of a two-stage block pipeline on its own thread.
+
+    The render thread fills a slot, submit()s it, and goes on to run the
+    second stage of the previous slot while the worker runs the first stage
+    of this one. Slots travel through lock-free SPSC queues; the events only
+    wake the other side up. waitForCompleted() blocks, so this is meant for
+    offline rendering only.
+*/
+class PipelineWorker : private juce::Thread
+{
+public:
+    using Stage = std::function<void (int slot)>;
+
+    PipelineWorker() : juce::Thread ("GAINFORGE pipeline") {}
+    ~PipelineWorker() override      { stop(); }
+
+    /** Message thread. */
+    void start (Stage stageToRun)
+    {
+        stop();
+        stage = std::move (stageToRun);
+        submitted.clear();
+        completed.clear();
+        inFlight = 0;
+        startThread (juce::Thread::Priority::high);
+    }
+
+    void stop()
+    {
+        signalThreadShouldExit();
+        workAvailable.signal();
+        stopThread (2000);
+        stage = nullptr;
+    }
+
+    bool isRunning() const noexcept { return isThreadRunning(); }
+
+    /** Render thread: hands a filled slot to the worker. */
+    void submit (int slot) noexcept
+    {
+        if (submitted.push (slot))
+        {
+            ++inFlight;
+            workAvailable.signal();
+        }
+    }
+
+    /** Render thread: blocks until the oldest submitted slot has been through the first stage. Returns -1 if nothing is in flight. */
+    int waitForCompleted() noexcept
+    {
+        if (inFlight == 0)
+            return -1;
+
+        int slot = -1;
+        while (! completed.pop (slot))
+        {
+            if (! isThreadRunning())
+                return -1;
+
+            workDone.wait (50);
+        }
+
+        --inFlight;
+        return slot;
+    }
+
+private:
+    void run() override
+    {
+        // Same float environment as the render thread, so results match the serial path bit for bit
+        juce::ScopedNoDenormals noDenormals;
+
+        while (! threadShouldExit())
+        {
+            int slot;
+            if (submitted.pop (slot))
+            {
+                stage (slot);
+                completed.push (slot);
+                workDone.signal();
+            }
+            else
+            {
+                workAvailable.wait (100);
+            }
+        }
+    }
+
+    Stage stage;
+    SpscQueue<int, 4> submitted, completed;
+    juce::WaitableEvent workAvailable, workDone;
+    int inFlight = 0; // Render thread only
+
+    JUCE_DECLARE_NON_COPYABLE (PipelineWorker)
+};
+
+//==============================================================================
+/**
+    Fixed delay for variable-sized blocks: whatever is written comes back out
+    exactly `latency` samples later, so a pipeline that produces the previous
+    block's output can still report a constant latency to the host.
+*/
+class BlockDelayFifo
+{
+public:
+    /** Message thread. maximumBlockSize must be >= every write/read size and latency. */
+    void prepare (int numChannels, int latencySamples, int maximumBlockSize)
+    {
+        latency = latencySamples;
+        buffer.setSize (numChannels, latencySamples + maximumBlockSize + 1);
+        reset();
+    }
+
+    /** Starts over with `latency` samples of silence queued. */
+    void reset() noexcept
+    {
+        buffer.clear();
+        readPosition = 0;
+        numQueued = latency;
+    }
+
+    void write (const juce::AudioBuffer<float>& source, int numChannels, int numSamples) noexcept
+    {
+        jassert (numQueued + numSamples <= buffer.getNumSamples());
+        transfer (numSamples, (readPosition + numQueued) % buffer.getNumSamples(),
+                  [&] (int bufferIndex, int sourceIndex, int count)
+                  {
+                      for (int channel = 0; channel < numChannels; ++channel)
+                          buffer.copyFrom (channel, bufferIndex, source, channel, sourceIndex, count);
+                  });
+        numQueued += numSamples;
+    }
+
+    void read (juce::AudioBuffer<float>& dest, int numChannels, int numSamples) noexcept
+    {
+        jassert (numSamples <= numQueued);
+        transfer (numSamples, readPosition,
+                  [&] (int bufferIndex, int destIndex, int count)
+                  {
+                      for (int channel = 0; channel < numChannels; ++channel)
+                          dest.copyFrom (channel, destIndex, buffer, channel, bufferIndex, count);
+                  });
+        readPosition = (readPosition + numSamples) % buffer.getNumSamples();
+        numQueued -= numSamples;
+    }
+
+    size_t getSizeInBytes() const noexcept
+    {
+        return (size_t) (buffer.getNumChannels() * buffer.getNumSamples()) * sizeof (float);
+    }
+
+private:
+    // Splits a ring-buffer span into at most two contiguous copies
+    template <typename Copy>
+    void transfer (int numSamples, int bufferStart, Copy&& copy) noexcept
+    {
+        const int size = buffer.getNumSamples();
+        const int first = juce::jmin (numSamples, size - bufferStart);
+        copy (bufferStart, 0, first);
+
+        if (first < numSamples)
+            copy (0, first, numSamples - first);
+    }
+
+    juce::AudioBuffer<float> buffer;
+    int latency = 0, readPosition = 0, numQueued = 0;
+};
@@ -182,21 +182,34 @@ GainForgeAudioProcessorEditor::GainForgeAudioProcessorEditor (GainForgeAudioProc
     // Create power LED
     powerLed = std::make_unique<PowerLed>();
     addAndMakeVisible (*powerLed);
+
+    rigPanel = std::make_unique<RigPanel> (audioProcessor);
+    addAndMakeVisible (*rigPanel);
+
+   #if GAINFORGE_ENABLE_PROFILING
+    profilerOverlay = std::make_unique<ProfilerOverlay> (audioProcessor);
+    addAndMakeVisible (*profilerOverlay);
+   #endif
     
-    // Set initial LED state based on bypass parameter (LED on = plugin not bypassed)
-    auto* bypassParam = audioProcessor.apvts.getRawParameterValue("BYPASS");
-    bool bypassed = bypassParam && bypassParam->load() > 0.5f;
-    powerLed->setOn(!bypassed); // LED on when not bypassed
+    // Keep the LED in sync with the bypass parameter, including host-driven bypass
+    // (LED on = plugin not bypassed)
+    if (auto* bypassParam = audioProcessor.getBypassParameter())
+    {
+        bypassAttachment = std::make_unique<juce::ParameterAttachment> (*bypassParam, [this] (float value)
+        {
+            if (powerLed)
+                powerLed->setOn (value < 0.5f);
+        });
+        bypassAttachment->sendInitialUpdate();
+    }
     
-    // Connect LED toggle to bypass parameter
-    powerLed->onToggle = [&](bool isOn)
+    // Connect LED toggle to bypass parameter through the host (gesture + notification)
+    powerLed->onToggle = [this](bool isOn)
     {
-        auto* bypassParam = audioProcessor.apvts.getRawParameterValue("BYPASS");
-        if (bypassParam)
+        if (bypassAttachment)
         {
             // LED on = plugin active (not bypassed), LED off = bypassed
-            float bypassValue = isOn ? 0.0f : 1.0f;
-            bypassParam->store(bypassValue);
+            bypassAttachment->setValueAsCompleteGesture (isOn ? 0.0f : 1.0f);
         }
     };
 
@@ -378,6 +391,7 @@ GainForgeAudioProcessorEditor::~GainForgeAudioProcessorEditor()
     masterAttachment.reset();
     voiceAttachment.reset();
     modeAttachment.reset();
+    bypassAttachment.reset();
     
     // NOW remove components from parent (this will trigger their destruction)
     removeAllChildren();
@@ -392,6 +406,10 @@ GainForgeAudioProcessorEditor::~GainForgeAudioProcessorEditor()
     voiceToggle.reset();
     modeToggle.reset();
     powerLed.reset();
+    rigPanel.reset();
+   #if GAINFORGE_ENABLE_PROFILING
+    profilerOverlay.reset();
+   #endif
     
     // Clear images
     panelImage = {};
@@ -624,7 +642,7 @@ void GainForgeAudioProcessorEditor::resized()
 
     // Validate components exist
     if (!gainKnob || !bassKnob || !midKnob || !trebleKnob || !presenceKnob || !masterKnob ||
-        !voiceToggle || !modeToggle || !powerLed)
+        !voiceToggle || !modeToggle || !powerLed || !rigPanel)
         return;
 
     // Panel fills window (cover mode with limited top/bottom crop) - same as paint()
@@ -706,4 +724,12 @@ void GainForgeAudioProcessorEditor::resized()
         powerBox,
         powerBox
     );
+
+    // Top right of the title zone, clear of the logo
+    rigPanel->setBounds (getLocalBounds().removeFromRight (440).removeFromTop (rigPanel->getIdealHeight() + 16).reduced (8));
+
+   #if GAINFORGE_ENABLE_PROFILING
+    profilerOverlay->setBounds (getLocalBounds().removeFromTop (150).withTrimmedLeft (130).removeFromLeft (360).reduced (8));
+    profilerOverlay->toFront (false);
+   #endif
 }
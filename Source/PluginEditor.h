@@ -18,6 +18,10 @@
 #include "KnobImageLNF.h"
 #include "ImageWithFallback.h"
 #include "TextUtilities.h"
+#include "RigPanel.h"
+#if GAINFORGE_ENABLE_PROFILING
+ #include "ProfilerOverlay.h"
+#endif
 
 //==============================================================================
 /**
@@ -60,6 +64,13 @@ private:
     // Power LED
     std::unique_ptr<PowerLed> powerLed;
 
+    // Capture and cabinet controls with their load status, in the title zone
+    std::unique_ptr<RigPanel> rigPanel;
+
+   #if GAINFORGE_ENABLE_PROFILING
+    std::unique_ptr<ProfilerOverlay> profilerOverlay; // Per-stage timings, click to reset
+   #endif
+
     // APVTS attachments
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> gainAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> bassAttachment;
@@ -70,6 +81,7 @@ private:
 
     std::unique_ptr<ThreePositionToggleAttachment> voiceAttachment;
     std::unique_ptr<ThreePositionToggleAttachment> modeAttachment;
+    std::unique_ptr<juce::ParameterAttachment> bypassAttachment; // Power LED <-> host-visible BYPASS
 
     // Hidden sliders for parameter binding (parameters use 0-1.0, knobs use 0-10)
     struct HiddenSlider
@@ -7,7 +7,15 @@
 */
 
 #include "PluginProcessor.h"
-#include "PluginEditor.h"
+
+// GAINFORGE_HEADLESS builds the processor without its editor (benchmark and test targets)
+#if ! GAINFORGE_HEADLESS
+ #include "PluginEditor.h"
+#endif
+
+#if GAINFORGE_RT_SAFETY_CHECKS
+ #include "RealtimeSafety.h"
+#endif
 
 //==============================================================================
 // AmpEmulator Implementation
@@ -42,17 +50,47 @@ void GainForgeAudioProcessor::AmpEmulator::prepare (double sampleRate, int maxBl
     trebleFilter.prepare (spec);
     presenceFilter.prepare (spec);
     
+    toneStack.reset();
+    
+    cabinetFade.reset (sampleRate, 0.05);
+    cabinetFade.setCurrentAndTargetValue (1.0f);
+    cabinetScratch.resize ((size_t) juce::jmax (1, maxBlockSize));
+    
+    mergedFade.reset (sampleRate, 0.05);
+    mergedFade.setCurrentAndTargetValue (0.0f);
+    mergedScratch.resize ((size_t) juce::jmax (1, maxBlockSize));
+    mergedWanted = false;
+    
     // Reset smoothed values (prevents loud pops on load - default parameters are now 0.0)
-    smoothedGain.reset (sampleRate, 0.05);
     smoothedBass.reset (sampleRate, 0.05);
     smoothedMid.reset (sampleRate, 0.05);
     smoothedTreble.reset (sampleRate, 0.05);
     smoothedPresence.reset (sampleRate, 0.05);
     smoothedMaster.reset (sampleRate, 0.05);
-    smoothedDrive.reset (sampleRate, 0.05);
-    smoothedRectifierMode.reset (sampleRate, 0.1);
     rectifierSagState = 0.0f;
     
+    // Oversamplers for every tier, so switching tiers on the audio thread never allocates
+    maxSubBlockSize = juce::jmax (1, maxBlockSize);
+    for (int order = 1; order <= (int) std::size (oversamplers); ++order)
+    {
+        auto& os = oversamplers[order - 1];
+        os = std::make_unique<juce::dsp::Oversampling<float>> (
+            1, (size_t) order, juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR, true);
+        os->initProcessing ((size_t) maxBlockSize);
+    }
+    
+    renderOversampler = std::make_unique<juce::dsp::Oversampling<float>> (
+        1, (size_t) Quality::getSettings (Quality::Tier::render).oversamplingOrder,
+        juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple, true, true); // Whole-sample latency
+    renderOversampler->initProcessing ((size_t) maxBlockSize);
+    
+    // Nonlinear-section smoothers and sag run at the oversampled rate
+    setQuality (tier);
+    
+    // Any prepared tables belong to the old rate - run the classic stack until new ones arrive
+    resources = nullptr;
+    usePassiveToneStack = false;
+    
     // Initialize filters with safe defaults (EQ at neutral, gain-related at 0.0)
     updateFilters (0.5f, 0.5f, 0.5f, 0.5f);
 }
@@ -63,39 +101,128 @@ void GainForgeAudioProcessor::AmpEmulator::reset()
     midFilter.reset();
     trebleFilter.reset();
     presenceFilter.reset();
+    toneStack.reset();
+    
+    if (oversampler != nullptr)
+        oversampler->reset();
+    
+    // Clear sag and land smoothers on their targets so the next block starts clean
+    rectifierSagState = 0.0f;
+    for (auto* smoothed : { &smoothedGain, &smoothedBass, &smoothedMid, &smoothedTreble, &smoothedPresence,
+                            &smoothedMaster, &smoothedDrive, &smoothedRectifierMode })
+        smoothed->setCurrentAndTargetValue (smoothed->getTargetValue());
+    
+    if (activeCaptureModel != nullptr)
+        activeCaptureModel->reset();
+    
+    if (auto* cab = cabinet.get())
+        cab->reset();
+    
+    // Drop any cabinet fade in progress; the outgoing cabinet goes once the retire slot is free
+    cabinetFade.setCurrentAndTargetValue (1.0f);
+    cabinetReleasePending = ! cabinet.releasePrevious();
+    
+    if (activeMergedKernel != nullptr)
+        activeMergedKernel->convolver->reset();
+    mergedFade.setCurrentAndTargetValue (mergedWanted ? 1.0f : 0.0f);
+}
+
+void GainForgeAudioProcessor::AmpEmulator::setQuality (Quality::Tier newTier) noexcept
+{
+    tier = newTier;
+    quality = Quality::getSettings (newTier);
+    
+    const int order = quality.linearPhase ? quality.oversamplingOrder
+                                          : juce::jlimit (0, (int) std::size (oversamplers), quality.oversamplingOrder);
+    
+    if (quality.linearPhase)
+        oversampler = renderOversampler.get();
+    else
+        oversampler = order > 0 ? oversamplers[order - 1].get() : nullptr;
+    if (oversampler != nullptr)
+        oversampler->reset();
+    
+    const double nonlinearRate = currentSampleRate * (double) (1 << order);
+    smoothedGain.reset (nonlinearRate, 0.05);
+    smoothedDrive.reset (nonlinearRate, 0.05);
+    smoothedRectifierMode.reset (nonlinearRate, 0.1);
+    
+    // Keep the sag time constant independent of the oversampling factor
+    sagCoefficient = std::pow (0.94f, 1.0f / (float) (1 << order));
+    sagInputGain = order == 0 ? 0.06f : 1.0f - sagCoefficient; // 1.0f - 0.94f isn't exactly 0.06f
+}
+
+int GainForgeAudioProcessor::AmpEmulator::getLatencySamples (Quality::Tier forTier) const noexcept
+{
+    if (! Quality::getSettings (forTier).linearPhase || hasCaptureModel())
+        return 0;
+    
+    return getMaximumLatencySamples();
+}
+
+int GainForgeAudioProcessor::AmpEmulator::getMaximumLatencySamples() const noexcept
+{
+    return renderOversampler != nullptr ? juce::roundToInt (renderOversampler->getLatencyInSamples()) : 0;
+}
+
+size_t GainForgeAudioProcessor::AmpEmulator::getSizeInBytes() const noexcept
+{
+    // Each oversampling stage buffers its (doubled) output for the largest block; the filter
+    // states are small beside that
+    auto oversamplerBytes = [this] (const juce::dsp::Oversampling<float>* os)
+    {
+        if (os == nullptr)
+            return (size_t) 0;
+
+        return sizeof (*os) + (size_t) maxSubBlockSize * (2 * os->getOversamplingFactor() - 2) * sizeof (float);
+    };
+
+    size_t bytes = (cabinetScratch.capacity() + mergedScratch.capacity()) * sizeof (float)
+                 + oversamplerBytes (renderOversampler.get());
+
+    for (auto& os : oversamplers)
+        bytes += oversamplerBytes (os.get());
+
+    return bytes + captureBytes.load() + cabinetBytes.load() + mergedBytes.load();
+}
+
+void GainForgeAudioProcessor::AmpEmulator::setToneStackMode (bool passive)
+{
+    // Fall back to the classic stack until the table for this rate has been built
+    passive = passive && resources != nullptr && resources->toneStackTable != nullptr;
+    
+    if (passive == usePassiveToneStack)
+        return;
+    
+    // The inactive implementation holds stale state from the last time it ran
+    if (passive)
+        toneStack.reset();
+    else
+    {
+        bassFilter.reset();
+        midFilter.reset();
+        trebleFilter.reset();
+    }
+    
+    usePassiveToneStack = passive;
 }
 
 void GainForgeAudioProcessor::AmpEmulator::updateFilters (float bass, float mid, float treble, float presence)
 {
-    // Mesa Boogie Triple Rectifier tone stack frequencies (authentic values)
-    // Bass: Low shelf at 80Hz - very powerful low end
-    auto bassCoeffs = juce::dsp::IIR::Coefficients<float>::makeLowShelf (
-        currentSampleRate, 80.0, 0.707, 
-        juce::jmap (bass, 0.12f, 4.2f) // 0.0 -> 0.12x, 1.0 -> 4.2x (massive bass boost capability)
-    );
-    *bassFilter.coefficients = *bassCoeffs;
-    
-    // Mid: Peaking at 800Hz with wider Q for classic scooped mids (Rectifier signature)
-    // Rectifier mids can go very low (scooped) - this is the key to the Rectifier sound
-    auto midCoeffs = juce::dsp::IIR::Coefficients<float>::makePeakFilter (
-        currentSampleRate, 800.0, 0.65, // Wider Q (0.65) for more pronounced scoop
-        juce::jmap (mid, 0.08f, 2.4f) // 0.0 -> 0.08x (very scooped), 1.0 -> 2.4x
-    );
-    *midFilter.coefficients = *midCoeffs;
-    
-    // Treble: High shelf at 2500Hz - bright and cutting
-    auto trebleCoeffs = juce::dsp::IIR::Coefficients<float>::makeHighShelf (
-        currentSampleRate, 2500.0, 0.707,
-        juce::jmap (treble, 0.18f, 2.8f) // 0.0 -> 0.18x, 1.0 -> 2.8x (bright)
-    );
-    *trebleFilter.coefficients = *trebleCoeffs;
-    
-    // Presence: High shelf at 5500Hz - articulation and high-end clarity
-    auto presenceCoeffs = juce::dsp::IIR::Coefficients<float>::makeHighShelf (
-        currentSampleRate, 5500.0, 0.707,
-        juce::jmap (presence, 0.15f, 2.6f) // 0.0 -> 0.15x, 1.0 -> 2.6x
-    );
-    *presenceFilter.coefficients = *presenceCoeffs;
+    // ArrayCoefficients design in place - no allocation, so this can run several times per block.
+    // The designs are shared with the merged-kernel renderer (LinearStage.h)
+    *presenceFilter.coefficients = LinearStage::designPresence (currentSampleRate, presence);
+    
+    // Passive network: one table lookup replaces three filter designs
+    if (usePassiveToneStack)
+    {
+        toneStack.setCoefficients (resources->toneStackTable->lookup (bass, mid, treble));
+        return;
+    }
+    
+    *bassFilter.coefficients = LinearStage::designBass (currentSampleRate, bass);
+    *midFilter.coefficients = LinearStage::designMid (currentSampleRate, mid);
+    *trebleFilter.coefficients = LinearStage::designTreble (currentSampleRate, treble);
 }
 
 float GainForgeAudioProcessor::AmpEmulator::applyPreampStage (float input, float stageGain, int stageNumber)
@@ -111,9 +238,9 @@ float GainForgeAudioProcessor::AmpEmulator::applyPreampStage (float input, float
     // Softer asymmetric tube saturation (more analog-like)
     // Gentle asymmetric clipping for warmth
     if (output > 0.0f)
-        output = std::tanh (output * saturationAmount * 1.3f) * 0.75f; // Softer, warmer
+        output = shape (output * saturationAmount * 1.3f) * 0.75f; // Softer, warmer
     else
-        output = std::tanh (output * saturationAmount * 1.1f) * 0.80f; // Softer negative cycle
+        output = shape (output * saturationAmount * 1.1f) * 0.80f; // Softer negative cycle
     
     return output;
 }
@@ -129,146 +256,467 @@ float GainForgeAudioProcessor::AmpEmulator::applyRectifierSaturation (float inpu
     if (rectifierMode < 0.5f) // Silicon Diode mode - tight but smoother
     {
         // Tighter clipping but with softer curve
-        driven = std::tanh (driven * 2.0f) * 0.70f; // Softer clipping, higher output
+        driven = shape (driven * 2.0f) * 0.70f; // Softer clipping, higher output
     }
     else // Tube Rectifier mode - saggy and compressed
     {
         // Simulate rectifier sag (voltage drop under load - characteristic tube rectifier behavior)
         float sagAmount = std::abs (driven) * 0.15f;
-        rectifierSagState = rectifierSagState * 0.94f + sagAmount * 0.06f; // More sag response
+        rectifierSagState = rectifierSagState * sagCoefficient + sagAmount * sagInputGain; // More sag response
         driven *= (1.0f - rectifierSagState * 0.30f); // More voltage sag effect
         
         // Softer tube rectifier saturation - more vintage feel
-        driven = std::tanh (driven * 1.6f) * 0.75f; // Softer, warmer
+        driven = shape (driven * 1.6f) * 0.75f; // Softer, warmer
     }
     
     return driven;
 }
 
-void GainForgeAudioProcessor::AmpEmulator::processBlock (juce::AudioBuffer<float>& buffer, 
-                                                          float gain, float bass, float mid, float treble, 
-                                                          float presence, float master, float drive, float rectifierMode,
-                                                          float voice, float mode)
+void GainForgeAudioProcessor::AmpEmulator::resetTo (const ParameterSnapshot& parameters)
+{
+    // Land the smoothers on the new values so a freshly started engine doesn't ramp from stale ones
+    smoothedGain.setCurrentAndTargetValue (parameters[ParameterSnapshot::gain]);
+    smoothedBass.setCurrentAndTargetValue (parameters[ParameterSnapshot::bass]);
+    smoothedMid.setCurrentAndTargetValue (parameters[ParameterSnapshot::mid]);
+    smoothedTreble.setCurrentAndTargetValue (parameters[ParameterSnapshot::treble]);
+    smoothedPresence.setCurrentAndTargetValue (parameters[ParameterSnapshot::presence]);
+    smoothedMaster.setCurrentAndTargetValue (parameters[ParameterSnapshot::master]);
+    smoothedDrive.setCurrentAndTargetValue (parameters[ParameterSnapshot::drive]);
+    smoothedRectifierMode.setCurrentAndTargetValue (parameters[ParameterSnapshot::rectifierMode]);
+    
+    reset();
+}
+
+void GainForgeAudioProcessor::AmpEmulator::processNonlinear (float* channelData, int numSamples,
+                                                              const ParameterSnapshot& parameters,
+                                                              StageProfiler::BlockProfile& profile)
 {
-    if (buffer.getNumSamples() == 0)
+    if (numSamples == 0)
         return;
     
+    const float gain = parameters[ParameterSnapshot::gain];
+    const float drive = parameters[ParameterSnapshot::drive];
+    const float rectifierMode = parameters[ParameterSnapshot::rectifierMode];
+    // Voice and Mode are choice indices: 0 = Raw/Cln, 1 = Mid/Cru, 2 = Mod
+    const int voice = juce::roundToInt (parameters[ParameterSnapshot::voice]);
+    const int mode = juce::roundToInt (parameters[ParameterSnapshot::mode]);
+    
+    // Pick up a newly loaded (or cleared) capture; a fresh model starts from silence.
+    // The linear stage logs the change, so only the audio thread ever writes to the log
+    auto* captured = captureModel.acquire();
+    if (captured != activeCaptureModel)
+    {
+        if (captured != nullptr)
+            captured->reset();
+        activeCaptureModel = captured;
+        
+        pendingCaptureLog.store (captured != nullptr ? captured->getHiddenSize() + 1 : 1);
+    }
+    
     // Update smoothed values
     smoothedGain.setTargetValue (gain);
-    smoothedBass.setTargetValue (bass);
-    smoothedMid.setTargetValue (mid);
-    smoothedTreble.setTargetValue (treble);
-    smoothedPresence.setTargetValue (presence);
-    smoothedMaster.setTargetValue (master);
     smoothedDrive.setTargetValue (drive);
     smoothedRectifierMode.setTargetValue (rectifierMode);
     
-    // Update filter coefficients at the start of the block
-    updateFilters (bass, mid, treble, presence);
-    
+    // The oversamplers only have room for the prepared block size, and hosts are allowed to
+    // exceed it now and then - run longer blocks in pieces (same output, the state carries over)
+    for (int start = 0; start < numSamples; start += maxSubBlockSize)
+        processNonlinearSubBlock (channelData + start, juce::jmin (maxSubBlockSize, numSamples - start), voice, mode, profile);
+}
+
+void GainForgeAudioProcessor::AmpEmulator::processNonlinearSubBlock (float* channelData, int numSamples, int voice, int mode,
+                                                                      StageProfiler::BlockProfile& profile)
+{
     // Create DSP audio block
-    juce::dsp::AudioBlock<float> block (buffer);
-    juce::dsp::ProcessContextReplacing<float> context (block);
+    juce::dsp::AudioBlock<float> block (&channelData, 1, (size_t) numSamples);
     
-    // Process each sample for gain, drive, and master (these need per-sample smoothing)
-    auto* channelData = buffer.getWritePointer (0);
-    for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+    profile.start();
+    
+    // Nonlinear section runs oversampled, except for captures: they were trained at the base rate
+    auto* nonlinearOversampler = activeCaptureModel == nullptr ? oversampler : nullptr;
+    auto nonlinearBlock = nonlinearOversampler != nullptr ? nonlinearOversampler->processSamplesUp (block) : block;
+    float* nonlinearData = nonlinearBlock.getChannelPointer (0);
+    const int numNonlinearSamples = (int) nonlinearBlock.getNumSamples();
+    profile.lap (StageProfiler::oversampling);
+    
+    // One pass per stage over the block (per-sample smoothing inside each), so the profiler reads
+    // the clock once per stage per block. Every stage keeps its own state, so the order within a
+    // sample is unchanged
+    if (mode <= 0) // Cln - clean, minimal saturation
     {
-        float input = channelData[sample];
-        float currentMode = mode; // Use current mode value
-        
-        // Apply Mode control EARLY - Clean mode bypasses most saturation
-        if (currentMode < 0.25f) // Cln - clean, minimal saturation
+        for (int sample = 0; sample < numNonlinearSamples; ++sample)
         {
             // Clean mode - bypass saturation stages, just gentle gain boost
             float currentGain = smoothedGain.getNextValue();
             float gainAmount = 0.8f + currentGain * 2.2f; // Gentle 0.8x to 3.0x range
-            input *= gainAmount;
+            float input = nonlinearData[sample] * gainAmount;
             // Very gentle saturation - almost transparent
-            input = std::tanh (input * 0.8f) * 1.0f;
             // Bypass all other processing stages for clean sound
+            nonlinearData[sample] = shape (input * 0.8f) * 1.0f;
+        }
+        profile.lap (StageProfiler::preamp);
+    }
+    else
+    {
+        // Crunch and Modern modes - apply full preamp processing
+        if (activeCaptureModel != nullptr)
+        {
+            // Captured amp replaces the preamp cascade and rectifier
+            // Gain trims the level into the model (0.5x to 2x around the capture level)
+            for (int sample = 0; sample < numNonlinearSamples; ++sample)
+            {
+                float currentGain = smoothedGain.getNextValue();
+                smoothedDrive.getNextValue();
+                smoothedRectifierMode.getNextValue();
+                nonlinearData[sample] = activeCaptureModel->processSample (nonlinearData[sample] * std::exp2 ((currentGain - 0.5f) * 2.0f));
+            }
+            profile.lap (StageProfiler::preamp);
         }
         else
         {
-            // Crunch and Modern modes - apply full preamp processing
-            float currentGain = smoothedGain.getNextValue();
-            // More reasonable gain range: 1.0x to 12x (less harsh)
-            float gainAmount = 1.0f + currentGain * 11.0f;
-            
-            // Stage 1: Initial gain boost
-            input *= gainAmount * 0.3f;
-            input = applyPreampStage (input, 1.0f, 1);
-            
-            // Stage 2: Second gain stage
-            input *= gainAmount * 0.4f;
-            input = applyPreampStage (input, 1.0f, 2);
-            
-            // Stage 3: Third gain stage (high gain)
-            input *= gainAmount * 0.5f;
-            input = applyPreampStage (input, 1.0f, 3);
-            
-            // Stage 4: Final preamp stage
-            input *= gainAmount * 0.6f;
-            input = applyPreampStage (input, 1.0f, 4);
+            for (int sample = 0; sample < numNonlinearSamples; ++sample)
+            {
+                float input = nonlinearData[sample];
+                
+                // More reasonable gain range: 1.0x to 12x (less harsh)
+                float gainAmount = 1.0f + smoothedGain.getNextValue() * 11.0f;
+                
+                // Stage 1: Initial gain boost
+                input *= gainAmount * 0.3f;
+                input = applyPreampStage (input, 1.0f, 1);
+                
+                // Stage 2: Second gain stage
+                input *= gainAmount * 0.4f;
+                input = applyPreampStage (input, 1.0f, 2);
+                
+                // Stage 3: Third gain stage (high gain)
+                input *= gainAmount * 0.5f;
+                input = applyPreampStage (input, 1.0f, 3);
+                
+                // Stage 4: Final preamp stage
+                input *= gainAmount * 0.6f;
+                nonlinearData[sample] = applyPreampStage (input, 1.0f, 4);
+            }
+            profile.lap (StageProfiler::preamp);
             
             // Apply rectifier saturation (after preamp, before tone stack)
-            float currentDrive = smoothedDrive.getNextValue();
-            float currentRectifierMode = smoothedRectifierMode.getNextValue();
-            input = applyRectifierSaturation (input, currentDrive, currentRectifierMode);
+            for (int sample = 0; sample < numNonlinearSamples; ++sample)
+            {
+                float currentDrive = smoothedDrive.getNextValue();
+                float currentRectifierMode = smoothedRectifierMode.getNextValue();
+                nonlinearData[sample] = applyRectifierSaturation (nonlinearData[sample], currentDrive, currentRectifierMode);
+            }
+            profile.lap (StageProfiler::rectifier);
+        }
+        
+        // Apply Voice control (Raw/Mid/Mod) - Triple Rectifier channel voicing
+        // Voice: 0 = Raw (aggressive, tight, less compression), 
+        //        1 = Mid (balanced, classic Rectifier), 
+        //        2 = Mod (smooth, modern, more compression)
+        for (int sample = 0; sample < numNonlinearSamples; ++sample)
+        {
+            float input = nonlinearData[sample];
             
-            // Apply Voice control (Raw/Mid/Mod) - Triple Rectifier channel voicing
-            // Voice: 0.0 = Raw (aggressive, tight, less compression), 
-            //        0.5 = Mid (balanced, classic Rectifier), 
-            //        1.0 = Mod (smooth, modern, more compression)
-            if (voice < 0.25f) // Raw - aggressive, tight, less compressed
+            if (voice <= 0) // Raw - aggressive, tight, less compressed
             {
                 // More aggressive, tighter saturation - less compression
-                input = std::tanh (input * 1.6f) * 0.75f; // Softer than before
+                input = shape (input * 1.6f) * 0.75f; // Softer than before
             }
-            else if (voice < 0.75f) // Mid - balanced, classic Rectifier sound
+            else if (voice == 1) // Mid - balanced, classic Rectifier sound
             {
                 // Balanced Rectifier tone - slight smoothing
-                input = std::tanh (input * 1.3f) * 0.80f; // Softer, warmer
+                input = shape (input * 1.3f) * 0.80f; // Softer, warmer
             }
             else // Mod - smooth, modern, more compressed
             {
                 // Smoother, more compressed - modern high-gain sound
-                input = std::tanh (input * 1.2f) * 0.85f; // Softer, more compressed
+                input = shape (input * 1.2f) * 0.85f; // Softer, more compressed
             }
             
             // Apply Mode control for Crunch vs Modern
-            if (currentMode < 0.75f) // Cru - crunch, moderate gain
+            if (mode == 1) // Cru - crunch, moderate gain
             {
                 // Crunch mode - moderate gain boost, classic crunch
                 input *= 1.2f; // Moderate gain boost
-                input = std::tanh (input * 1.1f) * 0.85f; // Classic crunch saturation
+                input = shape (input * 1.1f) * 0.85f; // Classic crunch saturation
             }
             else // Mod - modern high gain, maximum saturation
             {
                 // Modern mode - high gain, but softer saturation
                 input *= 1.4f; // High gain boost
-                input = std::tanh (input * 1.4f) * 0.75f; // Softer saturation
+                input = shape (input * 1.4f) * 0.75f; // Softer saturation
             }
+            
+            nonlinearData[sample] = input;
         }
+        profile.lap (StageProfiler::voiceMode);
+    }
+    
+    if (nonlinearOversampler != nullptr)
+        nonlinearOversampler->processSamplesDown (block);
+    
+    profile.lap (StageProfiler::oversampling);
+}
+
+void GainForgeAudioProcessor::AmpEmulator::processLinear (float* channelData, int numSamples,
+                                                           const ParameterSnapshot& parameters,
+                                                           StageProfiler::BlockProfile& profile)
+{
+    if (numSamples == 0)
+        return;
+    
+    const float bass = parameters[ParameterSnapshot::bass];
+    const float mid = parameters[ParameterSnapshot::mid];
+    const float treble = parameters[ParameterSnapshot::treble];
+    const float presence = parameters[ParameterSnapshot::presence];
+    const float master = parameters[ParameterSnapshot::master];
+    const float toneStackMode = parameters[ParameterSnapshot::toneStack];
+    
+    if (const int captureLog = pendingCaptureLog.exchange (0); captureLog != 0 && log != nullptr)
+        log->push (RealtimeLog::Event::captureModelChanged, logChannel, (float) (captureLog - 1));
+    
+    smoothedBass.setTargetValue (bass);
+    smoothedMid.setTargetValue (mid);
+    smoothedTreble.setTargetValue (treble);
+    smoothedPresence.setTargetValue (presence);
+    smoothedMaster.setTargetValue (master);
+    
+    setToneStackMode (toneStackMode > 0.5f);
+    
+    updateCabinet();
+    updateMergedKernel (numSamples, { bass, mid, treble, presence, master, usePassiveToneStack });
+    
+    // The merged kernel runs on a copy of the input while the live filters fade against it
+    const bool runMerged = mergedFade.isSmoothing() || mergedFade.getCurrentValue() > 0.0f;
+    const bool runLive = mergedFade.isSmoothing() || mergedFade.getCurrentValue() < 1.0f;
+    
+    profile.start();
+    
+    if (runMerged)
+    {
+        std::copy_n (channelData, numSamples, mergedScratch.data());
+        activeMergedKernel->convolver->process (mergedScratch.data(), numSamples);
+        profile.lap (StageProfiler::cabinet);
+    }
+    
+    juce::dsp::AudioBlock<float> block (&channelData, 1, (size_t) numSamples);
+    
+    // Apply tone stack filters (block processing) - positioned after preamp in Rectifier.
+    // Coefficients follow the smoothed knobs every few samples, or jump once per block on the cheapest tier
+    const int updateInterval = quality.coefficientUpdateInterval > 0 ? quality.coefficientUpdateInterval : numSamples;
+    for (int start = 0; runLive && start < numSamples; start += updateInterval)
+    {
+        const int length = juce::jmin (updateInterval, numSamples - start);
         
-        channelData[sample] = input;
+        if (quality.coefficientUpdateInterval > 0)
+            updateFilters (smoothedBass.skip (length), smoothedMid.skip (length),
+                           smoothedTreble.skip (length), smoothedPresence.skip (length));
+        else
+            updateFilters (bass, mid, treble, presence);
+        
+        auto subBlock = block.getSubBlock ((size_t) start, (size_t) length);
+        juce::dsp::ProcessContextReplacing<float> context (subBlock);
+        
+        if (usePassiveToneStack)
+        {
+            toneStack.process (channelData + start, length);
+        }
+        else
+        {
+            bassFilter.process (context);
+            midFilter.process (context);
+            trebleFilter.process (context);
+        }
+        presenceFilter.process (context);
     }
     
-    // Apply tone stack filters (block processing) - positioned after preamp in Rectifier
-    bassFilter.process (context);
-    midFilter.process (context);
-    trebleFilter.process (context);
-    presenceFilter.process (context);
+    // Block-rate updates (and blocks the merged kernel ran alone) still advance the ramps,
+    // so a tier change or a knob move picks up where they are
+    if (quality.coefficientUpdateInterval <= 0 || ! runLive)
+        for (auto* smoothed : { &smoothedBass, &smoothedMid, &smoothedTreble, &smoothedPresence })
+            smoothed->skip (numSamples);
     
-    // Apply master volume (per-sample for smoothing)
-    for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+    profile.lap (StageProfiler::toneStack);
+    
+    // Speaker cabinet, ahead of the master so the limiter sees the final spectrum
+    if (runLive)
+        processCabinet (channelData, numSamples);
+    
+    profile.lap (StageProfiler::cabinet);
+    
+    // Apply master volume (per-sample for smoothing); the merged kernel has it baked in
+    int clippedSamples = 0, nonFiniteSamples = 0;
+    float blockPeak = 0.0f;
+    for (int sample = 0; sample < numSamples; ++sample)
     {
-        float currentMaster = smoothedMaster.getNextValue();
-        channelData[sample] *= (0.15f + currentMaster * 11.85f); // 0.15x to 12x (Rectifier master)
+        const float masterGain = LinearStage::getMasterGain (smoothedMaster.getNextValue());
+        
+        if (! runLive)
+        {
+            channelData[sample] = mergedScratch[(size_t) sample];
+        }
+        else
+        {
+            const float live = channelData[sample] * masterGain;
+            channelData[sample] = runMerged ? live + mergedFade.getNextValue() * (mergedScratch[(size_t) sample] - live) : live;
+        }
+        
+        // Track what the limiter is about to do (for the event log)
+        const float magnitude = std::abs (channelData[sample]);
+        if (! std::isfinite (magnitude))
+            ++nonFiniteSamples;
+        else if (magnitude > 0.98f)
+        {
+            ++clippedSamples;
+            blockPeak = juce::jmax (blockPeak, magnitude);
+        }
         
         // Final soft clipping to prevent harsh digital distortion (gentler)
         channelData[sample] = juce::jlimit (-0.98f, 0.98f, channelData[sample]);
     }
+    
+    profile.lap (StageProfiler::master);
+    
+    if (log != nullptr)
+    {
+        // Log clipping as runs (start + summary) rather than every block
+        if (clippedSamples > 0)
+        {
+            if (! isClipping)
+            {
+                log->push (RealtimeLog::Event::clippingStarted, logChannel, blockPeak);
+                isClipping = true;
+                clippingRunSamples = 0;
+                clippingRunPeak = 0.0f;
+            }
+            clippingRunSamples += clippedSamples;
+            clippingRunPeak = juce::jmax (clippingRunPeak, blockPeak);
+        }
+        else if (isClipping)
+        {
+            log->push (RealtimeLog::Event::clippingStopped, logChannel, (float) clippingRunSamples, clippingRunPeak);
+            isClipping = false;
+        }
+        
+        if (nonFiniteSamples > 0)
+            log->push (RealtimeLog::Event::nonFiniteSample, logChannel, (float) nonFiniteSamples);
+    }
+}
+
+void GainForgeAudioProcessor::AmpEmulator::updateCabinet()
+{
+    if (cabinetReleasePending)
+        cabinetReleasePending = ! cabinet.releasePrevious();
+    
+    // A new cabinet (or none) fades in over 50ms while the outgoing one keeps running
+    auto* cab = cabinet.acquireKeepingPrevious();
+    if (cab != activeCabinet)
+    {
+        activeCabinet = cab;
+        cabinetFade.setCurrentAndTargetValue (0.0f);
+        cabinetFade.setTargetValue (1.0f);
+    }
+}
+
+void GainForgeAudioProcessor::AmpEmulator::processCabinet (float* channelData, int numSamples)
+{
+    auto* cab = activeCabinet;
+    
+    if (! cabinetFade.isSmoothing())
+    {
+        if (cab != nullptr)
+            cab->process (channelData, numSamples);
+        return;
+    }
+    
+    // Both cabinets hear the same amp, so a linear fade keeps the level
+    auto* outgoing = cabinet.getPrevious();
+    const int scratchSize = (int) cabinetScratch.size();
+    
+    for (int start = 0; start < numSamples; start += scratchSize)
+    {
+        const int length = juce::jmin (scratchSize, numSamples - start);
+        float* data = channelData + start;
+        float* old = cabinetScratch.data();
+        
+        std::copy_n (data, length, old);
+        if (outgoing != nullptr)
+            outgoing->process (old, length);
+        if (cab != nullptr)
+            cab->process (data, length);
+        
+        for (int i = 0; i < length; ++i)
+            data[i] = old[i] + cabinetFade.getNextValue() * (data[i] - old[i]);
+    }
+    
+    if (! cabinetFade.isSmoothing())
+        cabinetReleasePending = ! cabinet.releasePrevious();
+}
+
+void GainForgeAudioProcessor::AmpEmulator::resetLiveStage()
+{
+    bassFilter.reset();
+    midFilter.reset();
+    trebleFilter.reset();
+    presenceFilter.reset();
+    toneStack.reset();
+    
+    if (activeCabinet != nullptr)
+        activeCabinet->reset();
+    
+    // A cabinet swapped in while the merged kernel ran alone would fade from an outgoing convolver
+    // still holding audio from before the merge. The live side fades in from the kernel anyway
+    if (cabinetFade.isSmoothing())
+    {
+        cabinetFade.setCurrentAndTargetValue (1.0f);
+        cabinetReleasePending = ! cabinet.releasePrevious();
+    }
+}
+
+void GainForgeAudioProcessor::AmpEmulator::updateMergedKernel (int numSamples, const LinearStage::Settings& settings)
+{
+    if (mergedReleasePending)
+        mergedReleasePending = ! mergedKernel.releasePrevious();
+    
+    auto* kernel = mergedKernel.acquireKeepingPrevious();
+    const bool merging = mergedFade.isSmoothing() || mergedFade.getCurrentValue() > 0.0f;
+    
+    if (numSamples > (int) mergedScratch.size())
+    {
+        // Larger block than prepared for - the kernel can't run at all, so this one cuts
+        if (merging)
+            resetLiveStage();
+        
+        mergedWanted = false;
+        mergedFade.setCurrentAndTargetValue (0.0f);
+        return;
+    }
+    
+    // A replaced or withdrawn kernel keeps running until the live side has faded back in
+    if (kernel != activeMergedKernel && ! merging)
+    {
+        activeMergedKernel = kernel;
+        mergedReleasePending = ! mergedKernel.releasePrevious();
+    }
+    
+    // Only while nothing the kernel bakes in is moving: knobs, tone stack type, cabinet
+    const bool settled = ! (smoothedBass.isSmoothing() || smoothedMid.isSmoothing() || smoothedTreble.isSmoothing()
+                            || smoothedPresence.isSmoothing() || smoothedMaster.isSmoothing() || cabinetFade.isSmoothing());
+    const bool wanted = settled && kernel != nullptr && kernel == activeMergedKernel
+                     && kernel->matches (settings, activeCabinet != nullptr ? activeCabinet->getExactImpulseResponse()
+                                                                            : nullptr);
+    
+    if (wanted == mergedWanted)
+        return;
+    
+    // A side that has been idle starts from silence rather than stale state
+    if (wanted && mergedFade.getCurrentValue() == 0.0f)
+        kernel->convolver->reset();
+    else if (! wanted && mergedFade.getCurrentValue() == 1.0f)
+        resetLiveStage();
+    
+    mergedWanted = wanted;
+    mergedFade.setTargetValue (wanted ? 1.0f : 0.0f);
 }
 
 //==============================================================================
@@ -299,10 +747,39 @@ GainForgeAudioProcessor::GainForgeAudioProcessor()
     voiceParam = apvts.getRawParameterValue("VOICE");
     modeParam = apvts.getRawParameterValue("MODE");
     bypassParam = apvts.getRawParameterValue("BYPASS");
+    toneStackParam = apvts.getRawParameterValue("TONE_STACK");
+    qualityParam = apvts.getRawParameterValue("QUALITY");
+    
+    // Audio-thread event log
+    const auto instanceName = "GAINFORGE#" + juce::String::toHexString ((juce::pointer_sized_int) this);
+    logWriter->addRing (&logRing, instanceName);
+    deadlineWriter->addMonitor (&deadlineMonitor, instanceName);
+    for (auto& bank : ampEmulator)
+        for (int channel = 0; channel < 2; ++channel)
+            bank[channel].setLog (&logRing, channel);
+    
+    activeBankParameters = readParameters();
+    
+    // Any parameter change invalidates the cached state blob
+    for (auto* param : getParameters())
+        if (auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*> (param))
+            apvts.addParameterListener (withID->paramID, this);
+    
+    // Watches for settled knobs when the merged linear stage is enabled
+    startTimerHz (10);
 }
 
 GainForgeAudioProcessor::~GainForgeAudioProcessor()
 {
+    stopTimer();
+    pipelineWorker.stop();
+    
+    for (auto* param : getParameters())
+        if (auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*> (param))
+            apvts.removeParameterListener (withID->paramID, this);
+    
+    logWriter->removeRing (&logRing);
+    deadlineWriter->removeMonitor (&deadlineMonitor);
 }
 
 //==============================================================================
@@ -340,144 +817,1216 @@ bool GainForgeAudioProcessor::isMidiEffect() const
 
 double GainForgeAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return cabinetTailSeconds.load();
 }
 
 int GainForgeAudioProcessor::getNumPrograms()
 {
-    return 1;
+    return presetBank.getNumPresets();
 }
 
 int GainForgeAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return currentProgram;
 }
 
 void GainForgeAudioProcessor::setCurrentProgram (int index)
 {
+    if (! juce::isPositiveAndBelow (index, presetBank.getNumPresets()))
+        return;
+    
+    currentProgram = index;
+    applyParameterSnapshot (presetBank.getPreset (index).parameters);
 }
 
 const juce::String GainForgeAudioProcessor::getProgramName (int index)
 {
-    return {};
+    if (! juce::isPositiveAndBelow (index, presetBank.getNumPresets()))
+        return {};
+    
+    return presetBank.getPreset (index).name;
 }
 
 void GainForgeAudioProcessor::changeProgramName (int index, const juce::String& newName)
 {
+    presetBank.setName (index, newName);
+    updateHostDisplay (juce::AudioProcessor::ChangeDetails().withProgramChanged (true));
 }
 
-//==============================================================================
-void GainForgeAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
+int GainForgeAudioProcessor::saveUserPreset (const juce::String& name)
 {
-    currentSampleRate = sampleRate;
+    currentProgram = presetBank.saveUserPreset (name, getCurrentParameters());
+    updateHostDisplay (juce::AudioProcessor::ChangeDetails().withProgramChanged (true));
+    return currentProgram;
+}
+
+void GainForgeAudioProcessor::applyLibraryPreset (const PresetLibrary& library, int index)
+{
+    if (! library.isOpen() || ! juce::isPositiveAndBelow (index, library.getNumPresets()))
+        return;
     
-    for (int channel = 0; channel < 2; ++channel)
-    {
-        ampEmulator[channel].prepare (sampleRate, samplesPerBlock);
-    }
+    applyParameterSnapshot (library.getParameters (index, getCurrentParameters()));
 }
 
-void GainForgeAudioProcessor::releaseResources()
+void GainForgeAudioProcessor::applyParameterSnapshot (const ParameterSnapshot& parameters)
 {
-    for (int channel = 0; channel < 2; ++channel)
-    {
-        ampEmulator[channel].reset();
-    }
+    PresetChange change { parameters, ++presetSequence };
+    
+    // Audio thread gets the whole snapshot at once and crossfades to it...
+    presetChanges.publish (std::make_unique<PresetChange> (change));
+    
+    // ...while the host sees one coalesced round of parameter updates
+    hostParameterUpdater.post (change);
 }
 
-#ifndef JucePlugin_PreferredChannelConfigurations
-bool GainForgeAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+ParameterSnapshot GainForgeAudioProcessor::getCurrentParameters() const noexcept
 {
-  #if JucePlugin_IsMidiEffect
-    juce::ignoreUnused (layouts);
-    return true;
-  #else
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-        return false;
+    return readParameters();
+}
 
-   #if ! JucePlugin_IsSynth
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-        return false;
+StageProfiler::Stats GainForgeAudioProcessor::getStageStats (StageProfiler::Stage stage) const
+{
+   #if GAINFORGE_ENABLE_PROFILING
+    return stageProfiler.getStats (stage);
+   #else
+    juce::ignoreUnused (stage);
+    return {};
    #endif
+}
 
-    return true;
-  #endif
+void GainForgeAudioProcessor::resetStageStats()
+{
+   #if GAINFORGE_ENABLE_PROFILING
+    stageProfiler.reset();
+   #endif
 }
-#endif
 
-void GainForgeAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+ParameterSnapshot GainForgeAudioProcessor::readParameters() const noexcept
 {
-    juce::ignoreUnused (midiMessages);
+    ParameterSnapshot s;
+    s[ParameterSnapshot::gain] = gainParam->load();
+    s[ParameterSnapshot::bass] = bassParam->load();
+    s[ParameterSnapshot::mid] = midParam->load();
+    s[ParameterSnapshot::treble] = trebleParam->load();
+    s[ParameterSnapshot::presence] = presenceParam->load();
+    s[ParameterSnapshot::master] = masterParam->load();
+    s[ParameterSnapshot::drive] = driveParam->load();
+    s[ParameterSnapshot::rectifierMode] = rectifierModeParam->load() > 0.5f ? 1.0f : 0.0f; // Convert bool to float
     
-    juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels  = getTotalNumInputChannels();
-    auto totalNumOutputChannels = getTotalNumOutputChannels();
+    // Voice and mode hold the choice index (0, 1, 2)
+    s[ParameterSnapshot::voice] = voiceParam ? voiceParam->load() : 1.0f; // Default to Mid if not found
+    s[ParameterSnapshot::mode] = modeParam ? modeParam->load() : 2.0f;    // Default to Mod if not found
+    s[ParameterSnapshot::toneStack] = toneStackParam ? toneStackParam->load() : 0.0f; // Default to Classic
+    return s;
+}
+
+//==============================================================================
+void GainForgeAudioProcessor::HostParameterUpdater::post (const PresetChange& change)
+{
+    {
+        const juce::SpinLock::ScopedLockType sl (lock);
+        pending = change;
+    }
+    
+    triggerAsyncUpdate();
+}
+
+void GainForgeAudioProcessor::HostParameterUpdater::handleAsyncUpdate()
+{
+    PresetChange change;
+    {
+        const juce::SpinLock::ScopedLockType sl (lock);
+        change = pending;
+    }
+    
+    // Only parameters that actually change notify the host
+    for (int i = 0; i < ParameterSnapshot::numParameters; ++i)
+    {
+        if (auto* param = owner.apvts.getParameter (ParameterSnapshot::getParameterID (i)))
+        {
+            const float normalised = param->convertTo0to1 (change.parameters[i]);
+            if (param->getValue() != normalised)
+            {
+                param->beginChangeGesture();
+                param->setValueNotifyingHost (normalised);
+                param->endChangeGesture();
+            }
+        }
+    }
+    
+    owner.appliedPresetSequence.store (change.sequence);
+}
+
+//==============================================================================
+void GainForgeAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
+{
+    const bool sampleRateChanged = sampleRate != currentSampleRate;
+    const bool blockSizeGrew = samplesPerBlock > currentBlockSize;
+    currentSampleRate = sampleRate;
+    currentBlockSize = samplesPerBlock;
+    
+    // Start on the chosen tier (the render tier for bounces); in Auto the governor starts from Standard
+    const int qualityChoice = qualityParam != nullptr ? (int) qualityParam->load() : legacyQualityChoice;
+    governorActive = qualityChoice == 0;
+    activeTier = governorActive ? Quality::Tier::standard
+                                : (Quality::Tier) juce::jlimit (0, Quality::numLiveTiers - 1, qualityChoice - 1);
+    if (isNonRealtime())
+        activeTier = Quality::Tier::render;
+    currentQualityTier = (int) activeTier;
+    wantedTier = activeTier;
+    governor.prepare (sampleRate, activeTier);
+    deadlineMonitor.prepare (sampleRate);
+    
+    // Offline pipelining is set up here; the worker must be idle while the emulators are prepared
+    pipelineWorker.stop();
+    pipelineActive = isNonRealtime() && offlinePipeliningEnabled.load();
+    pipelineInUse = pipelineActive;
+    pipelineLatency = pipelineActive ? samplesPerBlock : 0;
+    pipelineOutput.prepare (2, pipelineLatency, samplesPerBlock);
+    
+    for (auto& bank : ampEmulator)
+    {
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            bank[channel].prepare (sampleRate, samplesPerBlock);
+            bank[channel].setQuality (activeTier);
+        }
+    }
+    
+    // Engine crossfade for preset switches (30ms equal-power)
+    engineFade.reset (sampleRate, 0.03);
+    engineFade.setCurrentAndTargetValue (1.0f);
+    engineCrossfadePending = false;
+    lastChunkCrossfaded = false;
+    nextChunk = 0;
+    for (auto& chunk : chunks)
+    {
+        chunk.audio.setSize (2, samplesPerBlock);
+        chunk.fadeAudio.setSize (2, samplesPerBlock);
+    }
+    
+    // Bypass crossfade (20ms) - start settled in whatever state the parameter is in
+    const bool bypassed = bypassParam && bypassParam->load() > 0.5f;
+    bypassWetGain.reset (sampleRate, 0.02);
+    bypassWetGain.setCurrentAndTargetValue (bypassed ? 0.0f : 1.0f);
+    dryBuffer.setSize (2, samplesPerBlock);
+    engineIsReset = bypassed;
+    
+    // Enough dry delay for the render tier's latency (plus the pipeline's), whichever tier is running now
+    dryDelay.setMaximumDelayInSamples (juce::jmax (1, ampEmulator[0][0].getMaximumLatencySamples() + pipelineLatency));
+    dryDelay.prepare ({ sampleRate, (juce::uint32) samplesPerBlock, 2 });
+    latencyForCapture = ampEmulator[0][0].hasCaptureModel();
+    setActiveTierLatency();
+    
+    if (pipelineActive)
+        pipelineWorker.start ([this] (int slot)
+        {
+           #if GAINFORGE_RT_SAFETY_CHECKS
+            const RealtimeSafety::ScopedAudioCallback audioCallback; // The worker itself never has to wait mid-block
+           #endif
+            runNonlinearStage (chunks[slot]);
+        });
+    
+    // Tables etc. are built on a worker thread; the emulators run their fallback path until then
+    preparer.prepare (sampleRate, samplesPerBlock, *sharedResources, backgroundJobs, preparedResources);
+    
+    // A capture only runs at the rate it was trained at; check it again against the new one
+    if (sampleRateChanged && apvts.state.hasProperty ("ampModelPath"))
+        loadAmpModel (juce::File (apvts.state.getProperty ("ampModelPath").toString()));
+    
+    // The cabinet was resampled for the old rate, or its convolvers leave the tail worker too
+    // little time at the new block size; drop it and rebuild it in the background
+    if ((sampleRateChanged || blockSizeGrew) && (apvts.state.hasProperty ("cabinetPath") || apvts.state.hasProperty ("cabinetBlend")))
+    {
+        for (auto& bank : ampEmulator)
+            for (int channel = 0; channel < 2; ++channel)
+                bank[channel].setCabinet (nullptr);
+        
+        recallCabinet();
+    }
+}
+
+void GainForgeAudioProcessor::releaseResources()
+{
+    pipelineWorker.stop();
+    pipelineActive = pipelineInUse = false;
+    
+    for (auto& bank : ampEmulator)
+        for (int channel = 0; channel < 2; ++channel)
+            bank[channel].reset();
+}
+
+#ifndef JucePlugin_PreferredChannelConfigurations
+bool GainForgeAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+  #if JucePlugin_IsMidiEffect
+    juce::ignoreUnused (layouts);
+    return true;
+  #else
+    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
+     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+        return false;
+
+   #if ! JucePlugin_IsSynth
+    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
+        return false;
+   #endif
+
+    return true;
+  #endif
+}
+#endif
+
+void GainForgeAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused (midiMessages);
+    
+   #if GAINFORGE_RT_SAFETY_CHECKS
+    const RealtimeSafety::ScopedAudioCallback audioCallback (isNonRealtime()); // Allocations (and live, locks) from here on are reported
+   #endif
+    
+    // Times the whole callback, bypassed or not, against the block's real-time budget
+    const DeadlineWatchdog::ScopedCallback deadline (deadlineMonitor, buffer.getNumSamples(), activeBankParameters, ! isNonRealtime());
+    
+    juce::ScopedNoDenormals noDenormals;
+    auto totalNumInputChannels  = getTotalNumInputChannels();
+    auto totalNumOutputChannels = getTotalNumOutputChannels();
 
     // Clear unused output channels
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    // Check bypass state - if bypassed, pass audio through unchanged
+    // Check bypass state - crossfade on every transition, then do no work at all
     bool bypassed = bypassParam && bypassParam->load() > 0.5f;
-    if (bypassed)
-        return; // Pass audio through unchanged
-
-    // Get parameter values
-    float gain = gainParam->load();
-    float bass = bassParam->load();
-    float mid = midParam->load();
-    float treble = trebleParam->load();
-    float presence = presenceParam->load();
-    float master = masterParam->load();
-    float drive = driveParam->load();
-    float rectifierMode = rectifierModeParam->load() > 0.5f ? 1.0f : 0.0f; // Convert bool to float
-    
-    // Get voice and mode parameters (AudioParameterChoice returns normalized 0.0-1.0)
-    float voice = voiceParam ? voiceParam->load() : 0.5f; // Default to Mid if not found
-    float mode = modeParam ? modeParam->load() : 1.0f;    // Default to Mod if not found
-
-    // Process each channel
-    for (int channel = 0; channel < totalNumInputChannels && channel < 2; ++channel)
-    {
-        // Create a single-channel buffer for processing
-        juce::AudioBuffer<float> singleChannelBuffer (1, buffer.getNumSamples());
-        singleChannelBuffer.copyFrom (0, 0, buffer, channel, 0, buffer.getNumSamples());
+    if (bypassed != lastBypassed)
+    {
+        logRing.push (RealtimeLog::Event::bypassChanged, -1, bypassed ? 1.0f : 0.0f);
+        lastBypassed = bypassed;
+    }
+    bypassWetGain.setTargetValue (bypassed ? 0.0f : 1.0f);
+    
+    const auto blockStartTicks = juce::Time::getHighResolutionTicks();
+    const int numSamples = buffer.getNumSamples();
+    const int numFadeChannels = juce::jmin (totalNumInputChannels, 2);
+    
+    // Pipelining only while the host is actually rendering offline
+    const bool pipelined = pipelineActive && isNonRealtime();
+    if (pipelined != pipelineInUse)
+    {
+        flushPipeline();
+        pipelineInUse = pipelined;
+        setActiveTierLatency();
+    }
+    
+    // Captures skip the oversampler, so loading or clearing one changes the render tier's latency.
+    // The dry delay belongs to this thread, so the change is picked up here rather than by the loader
+    const bool captureLoaded = ampEmulator[0][0].hasCaptureModel();
+    if (captureLoaded != latencyForCapture)
+    {
+        latencyForCapture = captureLoaded;
+        setActiveTierLatency();
+    }
+    
+    // With latency reported, the dry path is delayed to line up with the processed one
+    if (dryDelaySamples > 0)
+    {
+        juce::dsp::AudioBlock<float> dryBlock (buffer.getArrayOfWritePointers(), (size_t) numFadeChannels, (size_t) numSamples);
+        
+        if (bypassed && ! bypassWetGain.isSmoothing())
+        {
+            dryDelay.process (juce::dsp::ProcessContextReplacing<float> (dryBlock));
+        }
+        else
+        {
+            dryBuffer.setSize (2, numSamples, false, false, true);
+            juce::dsp::AudioBlock<float> delayedBlock (dryBuffer.getArrayOfWritePointers(), (size_t) numFadeChannels, (size_t) numSamples);
+            dryDelay.process (juce::dsp::ProcessContextNonReplacing<float> (dryBlock, delayedBlock));
+        }
+    }
+    
+    if (bypassed && ! bypassWetGain.isSmoothing())
+    {
+        // Fade has finished - clear filter/sag state once so re-enabling starts clean
+        if (! engineIsReset)
+        {
+            flushPipeline();
+            for (auto& bank : ampEmulator)
+                for (int channel = 0; channel < 2; ++channel)
+                    bank[channel].reset();
+            engineIsReset = true;
+        }
+        if (! isNonRealtime())
+            governor.updateIdle (blockStartTicks, numSamples);
+        return; // Pass audio through unchanged (apart from any latency compensation)
+    }
+    engineIsReset = false;
+    
+    // Keep the dry signal while fading in or out
+    const bool crossfading = bypassWetGain.isSmoothing();
+    if (crossfading && dryDelaySamples == 0)
+    {
+        dryBuffer.setSize (2, numSamples, false, false, true); // Only allocates if the host exceeds the prepared size
+        for (int channel = 0; channel < numFadeChannels; ++channel)
+            dryBuffer.copyFrom (channel, 0, buffer, channel, 0, numSamples);
+    }
+    
+    const int numEngineChannels = juce::jmin (totalNumInputChannels, 2);
+    
+    auto applyPreparedResources = [this]
+    {
+        // Pick up prepared tables; anything built for another sample rate is ignored
+        const auto* resources = preparedResources.acquire();
+        if (resources != nullptr && resources->sampleRate != currentSampleRate)
+            resources = nullptr;
+        
+        for (auto& bank : ampEmulator)
+            for (int channel = 0; channel < 2; ++channel)
+                bank[channel].setResources (resources);
+    };
+    
+    if (pipelineInUse)
+    {
+        // The worker has to be done with the previous block before this one's settings are decided
+        const int previous = pipelineWorker.waitForCompleted();
         
-        // Process the channel with amp emulator
-        ampEmulator[channel].processBlock (singleChannelBuffer, gain, bass, mid, treble, presence, master, drive, rectifierMode, voice, mode);
+        const int slot = nextChunk;
+        nextChunk ^= 1;
+        beginChunk (chunks[slot], buffer, numEngineChannels, numSamples);
+        pipelineWorker.submit (slot);
+        
+        // Meanwhile, finish the previous block here; the output comes back one block later
+        applyPreparedResources();
+        if (previous >= 0)
+        {
+            auto& finished = chunks[previous];
+            runLinearStage (finished);
+            pipelineOutput.write (finished.audio, finished.numChannels, finished.numSamples);
+        }
+        
+        pipelineOutput.read (buffer, numEngineChannels, numSamples);
+    }
+    else
+    {
+        auto& chunk = chunks[0];
+        beginChunk (chunk, buffer, numEngineChannels, numSamples);
+        runNonlinearStage (chunk);
+        applyPreparedResources();
+        runLinearStage (chunk);
         
-        // Copy processed audio back to main buffer
-        buffer.copyFrom (channel, 0, singleChannelBuffer, 0, 0, buffer.getNumSamples());
+        for (int channel = 0; channel < numEngineChannels; ++channel)
+            buffer.copyFrom (channel, 0, chunk.audio, channel, 0, numSamples);
     }
+    
+    // Bypass crossfade: wet = dry + gain * (processed - dry)
+    if (crossfading)
+    {
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            const float wetGain = bypassWetGain.getNextValue();
+            for (int channel = 0; channel < numFadeChannels; ++channel)
+            {
+                const float dry = dryBuffer.getSample (channel, sample);
+                buffer.setSample (channel, sample, dry + wetGain * (buffer.getSample (channel, sample) - dry));
+            }
+        }
+    }
+    
+    updateQualityTier (blockStartTicks, numSamples);
+}
+
+void GainForgeAudioProcessor::beginChunk (EngineChunk& chunk, const juce::AudioBuffer<float>& input,
+                                          int numChannels, int numSamples)
+{
+    // Preset switches arrive as one snapshot; render it until the host parameters catch up
+    if (const auto* change = presetChanges.acquire())
+    {
+        if (change->sequence != lastPresetSequence)
+        {
+            lastPresetSequence = change->sequence;
+            presetOverride = change->parameters;
+            presetOverrideActive = true;
+            engineCrossfadePending = true;
+        }
+    }
+    
+    if (presetOverrideActive && appliedPresetSequence.load() >= lastPresetSequence)
+        presetOverrideActive = false;
+    
+    const ParameterSnapshot parameters = presetOverrideActive ? presetOverride : readParameters();
+    
+    logParameterChanges (parameters);
+    
+    // Preset switches and tier changes fade across to the idle bank once it's free: no fade
+    // running, and the last faded block out of the pipeline (it still needs the outgoing bank)
+    if ((engineCrossfadePending || wantedTier != activeTier) && ! engineFade.isSmoothing() && ! lastChunkCrossfaded)
+    {
+        engineCrossfadePending = false;
+        
+        if (wantedTier != activeTier)
+        {
+            activeTier = wantedTier;
+            currentQualityTier = (int) wantedTier;
+            setActiveTierLatency(); // Only changes on the way in or out of the render tier
+        }
+        
+        startEngineCrossfade (parameters);
+    }
+    
+    // Capture everything both stages need, and move the fade on past this block
+    chunk.numChannels = numChannels;
+    chunk.numSamples = numSamples;
+    chunk.bank = activeBank;
+    chunk.crossfading = engineFade.isSmoothing();
+    chunk.parameters = parameters;
+    chunk.fadingParameters = fadingBankParameters;
+    chunk.fade = engineFade;
+    
+    if (chunk.crossfading)
+        engineFade.skip (numSamples);
+    
+    lastChunkCrossfaded = chunk.crossfading;
+    activeBankParameters = parameters;
+    
+    // Only allocates if the host exceeds the prepared size
+    chunk.audio.setSize (2, numSamples, false, false, true);
+    for (int channel = 0; channel < numChannels; ++channel)
+        chunk.audio.copyFrom (channel, 0, input, channel, 0, numSamples);
+    
+    // Outgoing bank keeps running on a copy of the input with its old settings
+    if (chunk.crossfading)
+    {
+        chunk.fadeAudio.setSize (2, numSamples, false, false, true);
+        for (int channel = 0; channel < numChannels; ++channel)
+            chunk.fadeAudio.copyFrom (channel, 0, input, channel, 0, numSamples);
+    }
+}
+
+void GainForgeAudioProcessor::runNonlinearStage (EngineChunk& chunk)
+{
+    // One profile for the whole chunk, so stage costs are per sample of the instance
+    StageProfiler::BlockProfile profile;
+    
+    for (int channel = 0; channel < chunk.numChannels; ++channel)
+    {
+        ampEmulator[chunk.bank][channel].processNonlinear (chunk.audio.getWritePointer (channel), chunk.numSamples,
+                                                           chunk.parameters, profile);
+        
+        if (chunk.crossfading)
+            ampEmulator[chunk.bank ^ 1][channel].processNonlinear (chunk.fadeAudio.getWritePointer (channel), chunk.numSamples,
+                                                                   chunk.fadingParameters, profile);
+    }
+    
+   #if GAINFORGE_ENABLE_PROFILING
+    profile.commit (&stageProfiler, chunk.numSamples);
+   #endif
+}
+
+void GainForgeAudioProcessor::runLinearStage (EngineChunk& chunk)
+{
+    StageProfiler::BlockProfile profile;
+    
+    for (int channel = 0; channel < chunk.numChannels; ++channel)
+    {
+        ampEmulator[chunk.bank][channel].processLinear (chunk.audio.getWritePointer (channel), chunk.numSamples,
+                                                        chunk.parameters, profile);
+        
+        if (chunk.crossfading)
+            ampEmulator[chunk.bank ^ 1][channel].processLinear (chunk.fadeAudio.getWritePointer (channel), chunk.numSamples,
+                                                                chunk.fadingParameters, profile);
+    }
+    
+   #if GAINFORGE_ENABLE_PROFILING
+    profile.commit (&stageProfiler, chunk.numSamples);
+   #endif
+    
+    // Equal-power mix so a switch between unrelated sounds doesn't dip in level
+    if (chunk.crossfading)
+    {
+        for (int sample = 0; sample < chunk.numSamples; ++sample)
+        {
+            const float t = chunk.fade.getNextValue() * juce::MathConstants<float>::halfPi;
+            const float newGain = std::sin (t);
+            const float oldGain = std::cos (t);
+            
+            for (int channel = 0; channel < chunk.numChannels; ++channel)
+                chunk.audio.setSample (channel, sample, newGain * chunk.audio.getSample (channel, sample)
+                                                      + oldGain * chunk.fadeAudio.getSample (channel, sample));
+        }
+    }
+}
+
+void GainForgeAudioProcessor::flushPipeline()
+{
+    // Let the worker finish (its block is dropped), then start over with an empty delay line
+    pipelineWorker.waitForCompleted();
+    pipelineOutput.reset();
+    lastChunkCrossfaded = false;
+}
+
+void GainForgeAudioProcessor::startEngineCrossfade (const ParameterSnapshot& newParameters)
+{
+    fadingBankParameters = activeBankParameters;
+    activeBank ^= 1;
+    
+    // The incoming bank starts from a clean state already settled at its new settings
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        ampEmulator[activeBank][channel].setQuality (activeTier);
+        ampEmulator[activeBank][channel].resetTo (newParameters);
+    }
+    
+    engineFade.setCurrentAndTargetValue (0.0f);
+    engineFade.setTargetValue (1.0f);
+}
+
+void GainForgeAudioProcessor::updateQualityTier (juce::int64 blockStartTicks, int numSamples)
+{
+    const int choice = qualityParam != nullptr ? (int) qualityParam->load() : legacyQualityChoice;
+    const bool automatic = choice == 0;
+    
+    // Switching to Auto: the governor carries on from the tier that's running
+    if (automatic && ! governorActive)
+        governor.setTier (activeTier);
+    governorActive = automatic;
+    
+    if (isNonRealtime())
+    {
+        // Bounces always get the render tier, whatever the live setting (and load means nothing offline)
+        wantedTier = Quality::Tier::render;
+    }
+    else
+    {
+        // Always measured, so the load readout works with a manual tier too
+        const auto governed = governor.update (blockStartTicks, numSamples);
+        wantedTier = automatic ? governed
+                               : (Quality::Tier) juce::jlimit (0, Quality::numLiveTiers - 1, choice - 1);
+    }
+    
+    // The change itself waits for the next block, then fades across like a preset switch
+}
+
+void GainForgeAudioProcessor::setNonRealtime (bool isNonRealtime) noexcept
+{
+    juce::AudioProcessor::setNonRealtime (isNonRealtime);
+    
+    // Hosts switch this before a bounce starts, so the new latency is known up front.
+    // The tier itself changes on the next block (or straight away if the host re-prepares)
+    const int latency = isNonRealtime ? ampEmulator[0][0].getLatencySamples (Quality::Tier::render)
+                                          + (pipelineActive ? pipelineLatency : 0)
+                                      : 0;
+    if (latency != getLatencySamples())
+        setLatencySamples (latency);
+}
+
+void GainForgeAudioProcessor::setActiveTierLatency()
+{
+    dryDelaySamples = ampEmulator[0][0].getLatencySamples (activeTier) + (pipelineInUse ? pipelineLatency : 0);
+    dryDelay.reset();
+    dryDelay.setDelay ((float) dryDelaySamples);
+    
+    if (dryDelaySamples != getLatencySamples())
+        setLatencySamples (dryDelaySamples);
+}
+
+void GainForgeAudioProcessor::logParameterChanges (const ParameterSnapshot& parameters)
+{
+    if (hasParameterHistory)
+    {
+        // Anything that moves more than 20% in one block is worth knowing about (automation jumps, state loads)
+        for (int i = ParameterSnapshot::gain; i <= ParameterSnapshot::drive; ++i)
+            if (std::abs (parameters[i] - lastLoggedParameters[i]) > 0.2f)
+                logRing.push (RealtimeLog::Event::parameterJump, -1, (float) i, lastLoggedParameters[i], parameters[i]);
+        
+        auto logSwitch = [&] (int index, RealtimeLog::Event event)
+        {
+            if (parameters[index] != lastLoggedParameters[index])
+                logRing.push (event, -1, lastLoggedParameters[index], parameters[index]);
+        };
+        
+        logSwitch (ParameterSnapshot::mode, RealtimeLog::Event::modeSwitch);
+        logSwitch (ParameterSnapshot::voice, RealtimeLog::Event::voiceSwitch);
+        logSwitch (ParameterSnapshot::rectifierMode, RealtimeLog::Event::rectifierSwitch);
+        logSwitch (ParameterSnapshot::toneStack, RealtimeLog::Event::toneStackSwitch);
+    }
+    
+    lastLoggedParameters = parameters;
+    hasParameterHistory = true;
 }
 
 //==============================================================================
 bool GainForgeAudioProcessor::hasEditor() const
 {
+   #if GAINFORGE_HEADLESS
+    return false;
+   #else
     return true;
+   #endif
 }
 
 juce::AudioProcessorEditor* GainForgeAudioProcessor::createEditor()
 {
+   #if GAINFORGE_HEADLESS
+    return nullptr;
+   #else
     return new GainForgeAudioProcessorEditor (*this);
+   #endif
+}
+
+//==============================================================================
+juce::AudioProcessorParameter* GainForgeAudioProcessor::getBypassParameter() const
+{
+    return apvts.getParameter ("BYPASS");
+}
+
+GainForgeAudioProcessor::PrivateMemory GainForgeAudioProcessor::getPrivateMemory() const
+{
+    auto bufferBytes = [] (const juce::AudioBuffer<float>& buffer)
+    {
+        return (size_t) (buffer.getNumChannels() * buffer.getNumSamples()) * sizeof (float);
+    };
+
+    PrivateMemory memory;
+    memory.object = sizeof (*this);
+
+    for (auto& bank : ampEmulator)
+        for (auto& emulator : bank)
+            memory.emulators += emulator.getSizeInBytes();
+
+    memory.mergedKernel = mergedKernelBytes.load();
+
+    for (auto& chunk : chunks)
+        memory.buffers += bufferBytes (chunk.audio) + bufferBytes (chunk.fadeAudio);
+
+    memory.buffers += bufferBytes (dryBuffer) + pipelineOutput.getSizeInBytes()
+                    + (size_t) (2 * (dryDelay.getMaximumDelayInSamples() + 1)) * sizeof (float); // Prepared for 2 channels
+
+    memory.presetsAndState = (size_t) presetBank.getNumPresets() * sizeof (PresetBank::Preset) + cachedState.getSize();
+    return memory;
+}
+
+juce::String GainForgeAudioProcessor::getMemoryReport()
+{
+    const auto memory = getPrivateMemory();
+
+    juce::String report;
+    report << "Private: " << (juce::int64) memory.getTotal() << " bytes (object " << (juce::int64) memory.object
+           << ", emulators " << (juce::int64) memory.emulators << ", merged kernel " << (juce::int64) memory.mergedKernel
+           << ", buffers " << (juce::int64) memory.buffers << ", presets and state " << (juce::int64) memory.presetsAndState
+           << ")" << juce::newLine;
+
+    return report + sharedResources->createMemoryReport (sharedResources.getReferenceCount(), memory.getTotal());
+}
+
+//==============================================================================
+void GainForgeAudioProcessor::loadAmpModel (const juce::File& modelFile)
+{
+    apvts.state.setProperty ("ampModelPath", modelFile.getFullPathName(), nullptr);
+    stateDirty = true;
+
+    juce::uint32 generation;
+    {
+        const juce::ScopedLock sl (ampModelLock);
+        generation = ++ampModelGeneration;
+        ampModelStatus = { false, "Loading " + modelFile.getFileNameWithoutExtension() + "..." };
+    }
+
+    backgroundJobs.addJob ([this, modelFile, generation, sampleRate = currentSampleRate]
+    {
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+
+        juce::String error;
+        auto model = NeuralAmp::loadFromFile (modelFile, error);
+
+        if (model != nullptr && ! model->canRunAt (sampleRate))
+        {
+            error = "trained at " + juce::String (model->sampleRate / 1000.0, 1) + " kHz, the session runs at "
+                  + juce::String (sampleRate / 1000.0, 1) + " kHz";
+            model = nullptr;
+        }
+
+        if (model == nullptr)
+        {
+            // The session names this capture, so nothing else keeps running in its place
+            const juce::ScopedLock sl (ampModelLock);
+            if (generation != ampModelGeneration)
+                return;
+
+            for (int channel = 0; channel < 2; ++channel)
+                for (auto& bank : ampEmulator)
+                    bank[channel].setCaptureModel (nullptr);
+
+            ampModelName = {};
+            ampModelStatus = { true, "Couldn't load " + modelFile.getFileName() + ": " + error };
+            return;
+        }
+
+        // Each channel runs its own recurrent state
+        std::unique_ptr<NeuralAmp::Model> clones[2][2];
+        for (auto& bankClones : clones)
+            for (auto& clone : bankClones)
+                clone = model->clone();
+
+        const auto loadMilliseconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks) * 1.0e3;
+
+        // A later load or a clear owns the slot now; this result is stale
+        const juce::ScopedLock sl (ampModelLock);
+        if (generation != ampModelGeneration)
+            return;
+
+        for (int channel = 0; channel < 2; ++channel)
+            for (int bank = 0; bank < 2; ++bank)
+                ampEmulator[bank][channel].setCaptureModel (std::move (clones[bank][channel]));
+
+        ampModelName = model->name;
+        ampModelStatus = { false, "Ready in " + juce::String (loadMilliseconds, 1) + " ms"
+                                  + (model->sampleRateDeclared ? juce::String() : " (no sample rate in the file; assumed it matches the session)") };
+    });
+}
+
+void GainForgeAudioProcessor::clearAmpModel()
+{
+    apvts.state.removeProperty ("ampModelPath", nullptr);
+    stateDirty = true;
+
+    // Under the lock, so a load still in flight sees the new generation before it can publish
+    const juce::ScopedLock sl (ampModelLock);
+    ++ampModelGeneration;
+
+    for (int channel = 0; channel < 2; ++channel)
+        for (auto& bank : ampEmulator)
+            bank[channel].setCaptureModel (nullptr);
+
+    ampModelName = {};
+    ampModelStatus = {};
+}
+
+juce::String GainForgeAudioProcessor::getAmpModelName() const
+{
+    const juce::ScopedLock sl (ampModelLock);
+    return ampModelName;
+}
+
+GainForgeAudioProcessor::LoadStatus GainForgeAudioProcessor::getAmpModelStatus() const
+{
+    const juce::ScopedLock sl (ampModelLock);
+    return ampModelStatus;
+}
+
+void GainForgeAudioProcessor::loadCabinetIR (const juce::File& irFile)
+{
+    apvts.state.setProperty ("cabinetPath", irFile.getFullPathName(), nullptr);
+    apvts.state.removeProperty ("cabinetBlend", nullptr);
+    stateDirty = true;
+
+    loadCabinet ([this, irFile, options = getCabinetPreprocessing()] (double sampleRate, juce::String& error)
+                 {
+                     return Cabinet::loadImpulseResponse (irFile, sampleRate, options, *sharedResources, error);
+                 },
+                 irFile.getFileNameWithoutExtension());
+}
+
+void GainForgeAudioProcessor::loadCabinetBlend (const std::vector<Cabinet::MicSource>& mics)
+{
+    apvts.state.setProperty ("cabinetBlend", Cabinet::blendToXmlString (mics), nullptr);
+    apvts.state.removeProperty ("cabinetPath", nullptr);
+    stateDirty = true;
+
+    juce::StringArray names;
+    for (auto& mic : mics)
+        names.add (mic.file.getFileNameWithoutExtension());
+
+    loadCabinet ([this, mics, options = getCabinetPreprocessing()] (double sampleRate, juce::String& error)
+                 {
+                     return Cabinet::blendImpulseResponses (mics, sampleRate, options, *sharedResources, error);
+                 },
+                 names.joinIntoString (" + "));
+}
+
+void GainForgeAudioProcessor::loadCabinet (CabinetBuilder build, const juce::String& name)
+{
+    const double sampleRate = currentSampleRate;
+    const int maxBlockSize = currentBlockSize;
+    const int approximationSections = getCabinetApproximation();
+
+    juce::uint32 generation;
+    {
+        const juce::ScopedLock sl (ampModelLock);
+        generation = ++cabinetGeneration;
+        cabinetStatus = { false, "Loading " + name + "..." };
+    }
+
+    backgroundJobs.addJob ([this, build = std::move (build), name, sampleRate, maxBlockSize, approximationSections, generation]
+    {
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+
+        juce::String error;
+        auto cached = build (sampleRate, error);
+
+        if (cached == nullptr)
+        {
+            const juce::ScopedLock sl (ampModelLock);
+            if (generation == cabinetGeneration)
+                cabinetStatus = { true, "Couldn't load " + name + ": " + error };
+            return;
+        }
+
+        Cabinet::IirFit::Result fit;
+        if (approximationSections > 0)
+            fit = Cabinet::IirFit::fit (cached->getImpulseResponse(), sampleRate, approximationSections);
+
+        const auto loadMilliseconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks) * 1.0e3;
+
+        // One handle per instance, so the cache counts instances (not convolvers) as holders;
+        // each channel of each bank shares the transformed IR but keeps its own convolution state
+        std::shared_ptr<const Cabinet::PartitionedIR> ir (cached.get(), [cached] (const Cabinet::PartitionedIR*) {});
+
+        std::unique_ptr<Cabinet::Stage> stages[2][2];
+        for (auto& bankStages : stages)
+            for (auto& stage : bankStages)
+            {
+                if (approximationSections > 0)
+                    stage = std::make_unique<Cabinet::BiquadCascade> (fit.sections);
+                else
+                    stage = std::make_unique<Cabinet::Convolver> (ir, *cabinetWorker, maxBlockSize);
+            }
+
+        // A later load or a clear owns the slot now; this result is stale
+        const juce::ScopedLock sl (ampModelLock);
+        if (generation != cabinetGeneration)
+            return;
+
+        for (int channel = 0; channel < 2; ++channel)
+            for (int bank = 0; bank < 2; ++bank)
+                ampEmulator[bank][channel].setCabinet (std::move (stages[bank][channel]));
+
+        cabinetTailSeconds = ir->length / sampleRate;
+        clearMergedKernels();
+
+        cabinetName = name;
+        cabinetStatus = { false, "Ready in " + juce::String (loadMilliseconds, 1) + " ms" };
+        cabinetReport = ir->preprocessing.toString();
+        cabinetFitReport = fit.report;
+        mergeableCabinet = approximationSections > 0 ? nullptr : ir;
+        loadedCabinet = ir;
+    });
+}
+
+void GainForgeAudioProcessor::recallCabinet()
+{
+    const auto blend = apvts.state.getProperty ("cabinetBlend").toString();
+    const auto path = apvts.state.getProperty ("cabinetPath").toString();
+
+    if (blend.isNotEmpty())
+        loadCabinetBlend (Cabinet::blendFromXmlString (blend));
+    else if (path.isNotEmpty())
+        loadCabinetIR (juce::File (path));
+    else
+        clearCabinetIR();
+}
+
+void GainForgeAudioProcessor::clearCabinetIR()
+{
+    apvts.state.removeProperty ("cabinetPath", nullptr);
+    apvts.state.removeProperty ("cabinetBlend", nullptr);
+    stateDirty = true;
+
+    // Under the lock, so a load still in flight sees the new generation before it can publish
+    const juce::ScopedLock sl (ampModelLock);
+    ++cabinetGeneration;
+
+    for (int channel = 0; channel < 2; ++channel)
+        for (auto& bank : ampEmulator)
+            bank[channel].setCabinet (nullptr);
+
+    cabinetTailSeconds = 0.0;
+    clearMergedKernels();
+
+    cabinetName = {};
+    cabinetStatus = {};
+    cabinetReport = {};
+    cabinetFitReport = {};
+    mergeableCabinet = nullptr;
+    loadedCabinet = nullptr;
+}
+
+std::vector<Cabinet::MicSource> GainForgeAudioProcessor::getCabinetBlend() const
+{
+    return Cabinet::blendFromXmlString (apvts.state.getProperty ("cabinetBlend").toString());
+}
+
+juce::String GainForgeAudioProcessor::getCabinetName() const
+{
+    const juce::ScopedLock sl (ampModelLock);
+    return cabinetName;
+}
+
+GainForgeAudioProcessor::LoadStatus GainForgeAudioProcessor::getCabinetStatus() const
+{
+    const juce::ScopedLock sl (ampModelLock);
+    return cabinetStatus;
+}
+
+void GainForgeAudioProcessor::setCabinetPreprocessing (const Cabinet::Preprocessing& options)
+{
+    if (options.isEnabled())
+        apvts.state.setProperty ("cabinetPreprocessing", options.toXmlString(), nullptr);
+    else
+        apvts.state.removeProperty ("cabinetPreprocessing", nullptr);
+
+    stateDirty = true;
+
+    if (apvts.state.hasProperty ("cabinetPath") || apvts.state.hasProperty ("cabinetBlend"))
+        recallCabinet();
+}
+
+Cabinet::Preprocessing GainForgeAudioProcessor::getCabinetPreprocessing() const
+{
+    return Cabinet::Preprocessing::fromXmlString (apvts.state.getProperty ("cabinetPreprocessing").toString());
+}
+
+juce::String GainForgeAudioProcessor::getCabinetReport() const
+{
+    const juce::ScopedLock sl (ampModelLock);
+    return cabinetReport;
+}
+
+void GainForgeAudioProcessor::setCabinetApproximation (int numSections)
+{
+    if (numSections > 0)
+        apvts.state.setProperty ("cabinetApproximation",
+                                 juce::jlimit (Cabinet::IirFit::minSections, Cabinet::IirFit::maxSections, numSections), nullptr);
+    else
+        apvts.state.removeProperty ("cabinetApproximation", nullptr);
+
+    stateDirty = true;
+
+    // Reloaded through the shared cache, which still holds the partitioned IR (loadedCabinet keeps it
+    // alive while an approximation runs), so only the fit - if any - costs anything
+    if (apvts.state.hasProperty ("cabinetPath") || apvts.state.hasProperty ("cabinetBlend"))
+        recallCabinet();
+}
+
+int GainForgeAudioProcessor::getCabinetApproximation() const
+{
+    return (int) apvts.state.getProperty ("cabinetApproximation", 0);
+}
+
+Cabinet::IirFit::Report GainForgeAudioProcessor::getCabinetFitReport() const
+{
+    const juce::ScopedLock sl (ampModelLock);
+    return cabinetFitReport;
+}
+
+void GainForgeAudioProcessor::setLinearStageMerging (bool enabled)
+{
+    if (enabled)
+        apvts.state.setProperty ("mergeLinearStage", true, nullptr);
+    else
+        apvts.state.removeProperty ("mergeLinearStage", nullptr);
+    
+    stateDirty = true;
+    
+    if (! enabled)
+        clearMergedKernels();
+}
+
+bool GainForgeAudioProcessor::isLinearStageMergingEnabled() const
+{
+    return apvts.state.getProperty ("mergeLinearStage", false);
+}
+
+void GainForgeAudioProcessor::clearMergedKernels()
+{
+    for (auto& bank : ampEmulator)
+        for (int channel = 0; channel < 2; ++channel)
+            bank[channel].setMergedKernel (nullptr);
+    
+    mergedKernelBytes.store (0);
+    
+    // Forget what was built, so the next settle renders again
+    const juce::ScopedLock sl (ampModelLock);
+    builtMergeCabinet = nullptr;
+}
+
+void GainForgeAudioProcessor::timerCallback()
+{
+    if (! isLinearStageMergingEnabled())
+        return;
+    
+    // Settled = unchanged for three ticks (300 ms); the emulators check the exact values again
+    const auto settings = LinearStage::Settings::fromParameters (getCurrentParameters());
+    if (settings != pendingMergeSettings)
+    {
+        pendingMergeSettings = settings;
+        mergeSettleTicks = 0;
+        return;
+    }
+    
+    if (++mergeSettleTicks < 3)
+        return;
+    
+    std::shared_ptr<const Cabinet::PartitionedIR> cabinetIR;
+    {
+        const juce::ScopedLock sl (ampModelLock);
+        if (mergeableCabinet == nullptr || (mergeableCabinet.get() == builtMergeCabinet && settings == builtMergeSettings))
+            return;
+        
+        cabinetIR = mergeableCabinet;
+        builtMergeCabinet = cabinetIR.get();
+        builtMergeSettings = settings;
+    }
+    
+    backgroundJobs.addJob ([this, settings, cabinetIR, sampleRate = cabinetIR->sampleRate, maxBlockSize = currentBlockSize]
+    {
+        // The passive stack's table comes from the shared cache, as for the live filters
+        const auto resources = AsyncPreparer::build (sampleRate, 0, *sharedResources);
+        const auto kernel = LinearStage::renderKernel (settings, *cabinetIR, sampleRate, resources->toneStackTable.get());
+        mergedKernelBytes.store (kernel->getSizeInBytes());
+        
+        for (auto& bank : ampEmulator)
+            for (int channel = 0; channel < 2; ++channel)
+            {
+                auto merged = std::make_unique<LinearStage::MergedKernel>();
+                merged->settings = settings;
+                merged->cabinet = cabinetIR.get();
+                merged->convolver = std::make_unique<Cabinet::Convolver> (kernel, *cabinetWorker, maxBlockSize);
+                bank[channel].setMergedKernel (std::move (merged));
+            }
+    });
 }
 
 //==============================================================================
 void GainForgeAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    auto state = apvts.copyState();
-    std::unique_ptr<juce::XmlElement> xml (state.createXml());
-    copyXmlToBinary (*xml, destData);
+    const juce::ScopedLock sl (stateLock);
+    
+    // Hosts poll this for autosave and undo; only re-serialise when something changed.
+    // The flag is cleared before reading so a change made meanwhile marks it dirty again.
+    if (stateDirty.exchange (false) || cachedState.isEmpty())
+    {
+        BinaryState::Contents contents;
+        contents.parameters = getCurrentParameters();
+        contents.bypass = bypassParam->load();
+        contents.quality = qualityParam->load();
+        contents.ampModelPath = apvts.state.getProperty ("ampModelPath").toString();
+        contents.cabinetPath = apvts.state.getProperty ("cabinetPath").toString();
+        contents.cabinetBlend = apvts.state.getProperty ("cabinetBlend").toString();
+        contents.cabinetPreprocessing = apvts.state.getProperty ("cabinetPreprocessing").toString();
+        contents.cabinetApproximation = getCabinetApproximation();
+        contents.mergeLinearStage = isLinearStageMergingEnabled();
+        
+        BinaryState::write (contents, cachedState);
+    }
+    
+    destData = cachedState;
 }
 
 void GainForgeAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
+    BinaryState::Contents contents;
+    contents.parameters = getCurrentParameters(); // Anything the state doesn't contain stays as it is
+    contents.bypass = bypassParam->load();
+    contents.quality = (float) legacyQualityChoice; // States from before the tiers carry no quality
+    
+    if (BinaryState::read (data, sizeInBytes, contents))
+    {
+        if (contents.version < BinaryState::choiceIndexVersion)
+            for (auto index : { ParameterSnapshot::voice, ParameterSnapshot::mode })
+                contents.parameters[index] = (float) getLegacyVoicingChoice (juce::roundToInt (contents.parameters[index]));
+        
+        applyState (contents);
+    }
+    else
+    {
+        setLegacyXmlState (data, sizeInBytes);
+    }
+}
+
+int GainForgeAudioProcessor::getLegacyVoicingChoice (int savedChoice) noexcept
+{
+    // The old chain tested the choice index against 0.25 and 0.75, so Mid and Crunch (index 1)
+    // ran the Mod branch. Mod is what those sessions sound like with the index decoding
+    return savedChoice >= 1 ? 2 : 0;
+}
+
+void GainForgeAudioProcessor::applyState (const BinaryState::Contents& contents)
+{
+    auto setParameter = [this] (const char* parameterID, float value)
+    {
+        if (auto* param = apvts.getParameter (parameterID))
+            param->setValueNotifyingHost (param->convertTo0to1 (value));
+    };
+    
+    for (int i = 0; i < ParameterSnapshot::numParameters; ++i)
+        setParameter (ParameterSnapshot::getParameterID (i), contents.parameters[i]);
+    setParameter ("BYPASS", contents.bypass);
+    setParameter ("QUALITY", contents.quality);
+    
+    // Recall the captured amp, if the session used one
+    if (contents.ampModelPath.isNotEmpty())
+        loadAmpModel (juce::File (contents.ampModelPath));
+    else
+        clearAmpModel();
+    
+    // ...and the cabinet, with the clean-up it was loaded with
+    if (contents.cabinetPreprocessing.isNotEmpty())
+        apvts.state.setProperty ("cabinetPreprocessing", contents.cabinetPreprocessing, nullptr);
+    else
+        apvts.state.removeProperty ("cabinetPreprocessing", nullptr);
+
+    setLinearStageMerging (contents.mergeLinearStage);
+
+    if (contents.cabinetApproximation > 0)
+        apvts.state.setProperty ("cabinetApproximation", contents.cabinetApproximation, nullptr);
+    else
+        apvts.state.removeProperty ("cabinetApproximation", nullptr);
+
+    if (contents.cabinetBlend.isNotEmpty())
+        loadCabinetBlend (Cabinet::blendFromXmlString (contents.cabinetBlend));
+    else if (contents.cabinetPath.isNotEmpty())
+        loadCabinetIR (juce::File (contents.cabinetPath));
+    else
+        clearCabinetIR();
+}
+
+void GainForgeAudioProcessor::setLegacyXmlState (const void* data, int sizeInBytes)
+{
+    // Sessions saved before the binary format stored the whole APVTS tree as XML
     std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
 
     if (xmlState.get() != nullptr)
         if (xmlState->hasTagName (apvts.state.getType()))
+        {
             apvts.replaceState (juce::ValueTree::fromXml (*xmlState));
+            
+            // Saved before the tiers existed - keep the sound the session was made with
+            if (xmlState->getChildByAttribute ("id", "QUALITY") == nullptr)
+                if (auto* quality = apvts.getParameter ("QUALITY"))
+                    quality->setValueNotifyingHost (quality->convertTo0to1 ((float) legacyQualityChoice));
+            
+            // ...including the voicing the old Voice/Mode decoding gave it
+            for (auto* parameterID : { "VOICE", "MODE" })
+                if (auto* choice = apvts.getParameter (parameterID))
+                    choice->setValueNotifyingHost (choice->convertTo0to1 ((float) getLegacyVoicingChoice (
+                        juce::roundToInt (choice->convertFrom0to1 (choice->getValue()))))));
+
+            // Recall the captured amp, if the session used one
+            auto modelPath = apvts.state.getProperty ("ampModelPath").toString();
+            if (modelPath.isNotEmpty())
+                loadAmpModel (juce::File (modelPath));
+            else
+                clearAmpModel();
+            
+            recallCabinet();
+        }
+    
+    stateDirty = true;
+}
+
+void GainForgeAudioProcessor::parameterChanged (const juce::String& parameterID, float newValue)
+{
+    juce::ignoreUnused (parameterID, newValue);
+    stateDirty = true; // May be called on the audio thread - just a flag
 }
 
 //==============================================================================
@@ -542,14 +2091,14 @@ juce::AudioProcessorValueTreeState::ParameterLayout GainForgeAudioProcessor::cre
         "" // false = Silicon, true = Tube
     ));
 
-    // Voice: 3-position (Raw/Mid/Mod) - normalized 0.0, 0.5, 1.0
+    // Voice: 3-position (Raw/Mid/Mod) - choice index 0, 1, 2
     params.push_back (std::make_unique<juce::AudioParameterChoice>(
         juce::ParameterID ("VOICE", 1), "Voice",
         juce::StringArray { "Raw", "Mid", "Mod" },
         1 // Default to Mid
     ));
 
-    // Mode: 3-position (Cln/Cru/Mod) - normalized 0.0, 0.5, 1.0
+    // Mode: 3-position (Cln/Cru/Mod) - choice index 0, 1, 2
     params.push_back (std::make_unique<juce::AudioParameterChoice>(
         juce::ParameterID ("MODE", 1), "Mode",
         juce::StringArray { "Cln", "Cru", "Mod" },
@@ -562,6 +2111,22 @@ juce::AudioProcessorValueTreeState::ParameterLayout GainForgeAudioProcessor::cre
         false // Default to not bypassed (plugin on)
     ));
 
+    // Tone Stack: Classic (independent shelf/peak biquads) or Passive (interactive third-order network)
+    params.push_back (std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID ("TONE_STACK", 1), "Tone Stack",
+        juce::StringArray { "Classic", "Passive" },
+        0 // Default to Classic
+    ));
+
+    // Quality: Auto lets the CPU governor pick a tier from the measured load; the others pin it.
+    // New instances start on Eco, the cheapest tier and the one older sessions load onto;
+    // Auto and the oversampled tiers are opt-in
+    params.push_back (std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID ("QUALITY", 1), "Quality",
+        juce::StringArray { "Auto", "Eco", "Standard", "High" },
+        legacyQualityChoice // Default to Eco
+    ));
+
     return { params.begin(), params.end() };
 }
 
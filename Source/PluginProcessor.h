@@ -9,6 +9,23 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "RectifierToneStack.h"
+#include "AsyncPreparation.h"
+#include "SharedDspResources.h"
+#include "PresetBank.h"
+#include "PresetLibrary.h"
+#include "BinaryState.h"
+#include "QualityTier.h"
+#include "CpuGovernor.h"
+#include "OfflinePipeline.h"
+#include "CabinetLoader.h"
+#include "CabinetIirFit.h"
+#include "LinearStage.h"
+#include "NeuralAmpModel.h"
+#include "RealtimeHandoff.h"
+#include "RealtimeLog.h"
+#include "StageProfiler.h"
+#include "DeadlineWatchdog.h"
 
 //==============================================================================
 /**
@@ -17,6 +34,8 @@ class GainForgeAudioProcessor  : public juce::AudioProcessor
                             #if JucePlugin_Enable_ARA
                              , public juce::AudioProcessorARAExtension
                             #endif
+                             , private juce::AudioProcessorValueTreeState::Listener
+                             , private juce::Timer
 {
 public:
     //==============================================================================
@@ -56,6 +75,12 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
+    // Bounces run the render quality tier (and report its latency) automatically
+    void setNonRealtime (bool isNonRealtime) noexcept override;
+
+    // Host-visible bypass (BYPASS parameter)
+    juce::AudioProcessorParameter* getBypassParameter() const override;
+
     //==============================================================================
     // Parameter management
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
@@ -70,9 +95,104 @@ public:
     std::atomic<float>* masterParam = nullptr;
     std::atomic<float>* driveParam = nullptr;
     std::atomic<float>* rectifierModeParam = nullptr; // 0.0 = Silicon, 1.0 = Tube
-    std::atomic<float>* voiceParam = nullptr; // 0.0 = Raw, 0.5 = Mid, 1.0 = Mod
-    std::atomic<float>* modeParam = nullptr;  // 0.0 = Cln, 0.5 = Cru, 1.0 = Mod
+    std::atomic<float>* voiceParam = nullptr; // Choice index: 0 = Raw, 1 = Mid, 2 = Mod
+    std::atomic<float>* modeParam = nullptr;  // Choice index: 0 = Cln, 1 = Cru, 2 = Mod
     std::atomic<float>* bypassParam = nullptr; // 0.0 = not bypassed (on), 1.0 = bypassed (off)
+    std::atomic<float>* toneStackParam = nullptr; // 0 = Classic (four biquads), 1 = Passive (single third-order stack)
+    std::atomic<float>* qualityParam = nullptr;   // 0 = Auto (CPU governor), 1..3 = Eco/Standard/High
+    static constexpr int legacyQualityChoice = 1; // Eco: what states saved before the tiers load with
+    
+    // Voice/Mode choice that reproduces how a session saved before the choice-index decoding sounded
+    static int getLegacyVoicingChoice (int savedChoice) noexcept;
+
+    //==============================================================================
+    // Outcome of the latest capture or cabinet load, for the editor: the error if it failed,
+    // otherwise progress or how long it took. Empty when nothing is loaded
+    struct LoadStatus
+    {
+        bool failed = false;
+        juce::String message;
+    };
+
+    //==============================================================================
+    // Neural amp capture (replaces the preamp/rectifier section while loaded)
+    void loadAmpModel (const juce::File& modelFile);
+    void clearAmpModel();
+    juce::String getAmpModelName() const;
+    LoadStatus getAmpModelStatus() const;
+
+    // Speaker cabinet IR (WAV/AIFF/FLAC or .gfir), resampled to the session rate on a background thread.
+    // A blend mixes up to three mic IRs into one composite IR; every change crossfades in
+    void loadCabinetIR (const juce::File& irFile);
+    void loadCabinetBlend (const std::vector<Cabinet::MicSource>& mics);
+    void clearCabinetIR();
+    std::vector<Cabinet::MicSource> getCabinetBlend() const; // Empty unless a blend is loaded
+    juce::String getCabinetName() const;
+    LoadStatus getCabinetStatus() const;
+
+    // Load-time IR clean-up (minimum phase, leading silence, tail truncation); reloads the current cabinet.
+    // The report says what the loaded IR lost (error) and gained (length, so CPU)
+    void setCabinetPreprocessing (const Cabinet::Preprocessing& options);
+    Cabinet::Preprocessing getCabinetPreprocessing() const;
+    juce::String getCabinetReport() const;
+
+    // Live-rig cabinet: 8-16 biquads fitted to the loaded IR's magnitude response instead of the
+    // convolution (0 = exact). Fitted in the background; switching either way crossfades
+    void setCabinetApproximation (int numSections);
+    int getCabinetApproximation() const;
+    Cabinet::IirFit::Report getCabinetFitReport() const;
+
+    // Once the tone knobs settle, tone stack + presence + cabinet + master are rendered into one
+    // convolution in the background and crossfaded in; moving a knob crossfades back to the live filters.
+    // Only with an exact (convolved) cabinet loaded
+    void setLinearStageMerging (bool enabled);
+    bool isLinearStageMergingEnabled() const;
+
+    // Session-load cost of the last prepareToPlay (blocking time vs. time until tables were ready)
+    AsyncPreparer::Timings getPrepareTimings() const { return preparer.getTimings(); }
+
+    // Heap each instance owns, by component. Message thread
+    struct PrivateMemory
+    {
+        size_t object = 0;          // The processor itself, emulators' inline state included
+        size_t emulators = 0;       // Scratch, oversamplers, capture clones, cabinet and merged-kernel convolvers
+        size_t mergedKernel = 0;    // The merged IR all emulators share
+        size_t buffers = 0;         // Chunk, dry, dry-delay and pipeline buffers
+        size_t presetsAndState = 0;
+
+        size_t getTotal() const noexcept    { return object + emulators + mergedKernel + buffers + presetsAndState; }
+    };
+
+    PrivateMemory getPrivateMemory() const;
+
+    // Memory footprint per instance (the private components summed, plus shared tables divided
+    // across all live instances)
+    juce::String getMemoryReport();
+
+    //==============================================================================
+    // Presets: switching publishes a snapshot to the audio thread and crossfades,
+    // while the host-facing parameters are updated once on the message thread
+    PresetBank& getPresetBank() noexcept { return presetBank; }
+    int saveUserPreset (const juce::String& name);
+    void applyParameterSnapshot (const ParameterSnapshot& parameters);
+
+    // Recalls a library preset straight from its mapped record; parameters the library
+    // doesn't store keep their current values
+    void applyLibraryPreset (const PresetLibrary& library, int index);
+    ParameterSnapshot getCurrentParameters() const noexcept;
+
+    //==============================================================================
+    // Quality tier actually running (the governor's choice in Auto) and the smoothed CPU load behind it
+    Quality::Tier getCurrentQualityTier() const noexcept { return (Quality::Tier) currentQualityTier.load(); }
+    float getCpuLoad() const noexcept { return governor.getSmoothedLoad(); }
+
+    // Offline bounces split the chain across two cores (one block of extra latency, same output).
+    // Takes effect at the next prepareToPlay
+    void setOfflinePipeliningEnabled (bool enabled) noexcept { offlinePipeliningEnabled = enabled; }
+
+    // Per-stage cost of the amp chain (message thread). All zero unless built with GAINFORGE_ENABLE_PROFILING
+    StageProfiler::Stats getStageStats (StageProfiler::Stage stage) const;
+    void resetStageStats();
 
 private:
     //==============================================================================
@@ -83,10 +203,63 @@ private:
         AmpEmulator();
         void prepare (double sampleRate, int maxBlockSize);
         void reset();
-        void processBlock (juce::AudioBuffer<float>& buffer, 
-                          float gain, float bass, float mid, float treble, 
-                          float presence, float master, float drive, float rectifierMode,
-                          float voice, float mode);
+        void resetTo (const ParameterSnapshot& parameters);
+        
+        // The chain in two stages with disjoint state, so they can run on different threads for
+        // consecutive blocks: preamp/rectifier (or capture), then tone stack, presence and master.
+        // Stage times are added to the caller's profile (empty unless GAINFORGE_ENABLE_PROFILING)
+        void processNonlinear (float* channelData, int numSamples, const ParameterSnapshot& parameters,
+                               StageProfiler::BlockProfile& profile);
+        void processLinear (float* channelData, int numSamples, const ParameterSnapshot& parameters,
+                            StageProfiler::BlockProfile& profile);
+        
+        // Captured amp model, published from the loader thread (nullptr restores the tanh chain)
+        void setCaptureModel (std::unique_ptr<NeuralAmp::Model> model)
+        {
+            const bool loaded = model != nullptr;
+            captureBytes.store (loaded ? model->getSizeInBytes() : 0);
+            captureModel.publish (std::move (model));
+            captureLoaded.store (loaded);
+        }
+        
+        bool hasCaptureModel() const noexcept { return captureLoaded.load(); }
+        
+        // Cabinet (convolution or fitted biquads) after the presence filter, published from the loader thread
+        // (nullptr = no cabinet). Each new cabinet crossfades in from the one it replaces
+        void setCabinet (std::unique_ptr<Cabinet::Stage> stage)
+        {
+            cabinetBytes.store (stage != nullptr ? stage->getSizeInBytes() : 0);
+            cabinet.publish (std::move (stage));
+        }
+        
+        // Tone stack, presence, cabinet and master as one convolution, published once the knobs settle.
+        // Only runs while the knobs and cabinet match what it was rendered for; crossfades both ways
+        // The kernel's IR is shared by every emulator and counted by the processor
+        void setMergedKernel (std::unique_ptr<LinearStage::MergedKernel> kernel)
+        {
+            mergedBytes.store (kernel != nullptr ? sizeof (*kernel) + kernel->convolver->getSizeInBytes() : 0);
+            mergedKernel.publish (std::move (kernel));
+        }
+        
+        // Tables built by the async preparer; nullptr (or a stale rate) selects the fallback path
+        void setResources (const PreparedResources* newResources) noexcept { resources = newResources; }
+        
+        // Audio-thread event log (clipping, NaNs, capture changes)
+        void setLog (RealtimeLog::Ring* ring, int channel) { log = ring; logChannel = channel; }
+        
+        // Oversampling, tanh kernel and coefficient update rate. Doesn't allocate,
+        // but resets the ramps - only call on an engine that is about to be faded in
+        void setQuality (Quality::Tier newTier) noexcept;
+        Quality::Tier getQuality() const noexcept { return tier; }
+        
+        // Whole samples of delay a tier adds (only the linear-phase render tier has any, and none
+        // while a capture runs, as captures skip the oversampler). Needs prepare()
+        int getLatencySamples (Quality::Tier forTier) const noexcept;
+        int getMaximumLatencySamples() const noexcept; // Render tier without a capture
+        
+        // Heap bytes owned by this emulator: scratch, oversamplers and what was last published
+        // to it (capture, cabinet, merged kernel). Message thread; needs prepare()
+        size_t getSizeInBytes() const noexcept;
         
     private:
         // Tone stack filters
@@ -94,7 +267,12 @@ private:
         juce::dsp::IIR::Filter<float> midFilter;
         juce::dsp::IIR::Filter<float> trebleFilter;
         juce::dsp::IIR::Filter<float> presenceFilter;
-        
+
+        // Passive Bass/Mid/Treble network (replaces the three tone biquads in Passive mode)
+        // Its coefficient table lives in the prepared resources; until those arrive the classic stack runs
+        const PreparedResources* resources = nullptr;
+        RectifierToneStack::Filter toneStack;
+        bool usePassiveToneStack = false;
         
         // Smoothing for parameter changes
         juce::LinearSmoothedValue<float> smoothedGain;
@@ -108,16 +286,238 @@ private:
         
         // Rectifier sag simulation (for tube mode)
         float rectifierSagState = 0.0f;
+        float sagCoefficient = 0.94f; // Per (oversampled) sample
+        float sagInputGain = 0.06f;   // 1 - sagCoefficient (the original constant at 1x)
+        
+        // Quality tier; one preallocated IIR oversampler per live factor (index = order - 1),
+        // plus the linear-phase one for offline renders
+        Quality::Tier tier = Quality::Tier::standard;
+        Quality::Settings quality = Quality::getSettings (Quality::Tier::standard);
+        std::unique_ptr<juce::dsp::Oversampling<float>> oversamplers[2];
+        std::unique_ptr<juce::dsp::Oversampling<float>> renderOversampler;
+        juce::dsp::Oversampling<float>* oversampler = nullptr;
+        int maxSubBlockSize = 1; // What the oversamplers were initialised for; longer blocks run in pieces
+        
+        // Event logging state
+        RealtimeLog::Ring* log = nullptr;
+        int logChannel = 0;
+        bool isClipping = false;
+        int clippingRunSamples = 0;
+        float clippingRunPeak = 0.0f;
         
         double currentSampleRate = 44100.0;
         
+        // Captured amp model, published from the loader thread
+        RealtimeHandoff<NeuralAmp::Model> captureModel;
+        NeuralAmp::Model* activeCaptureModel = nullptr;
+        std::atomic<bool> captureLoaded { false }; // Set once published, so latency follows within a block
+        std::atomic<int> pendingCaptureLog { 0 }; // Hidden size + 1 (1 = cleared), logged by the linear stage
+        
+        // Speaker cabinet (linear stage); the outgoing one keeps running during the fade
+        RealtimeHandoff<Cabinet::Stage> cabinet;
+        Cabinet::Stage* activeCabinet = nullptr;
+        juce::LinearSmoothedValue<float> cabinetFade;
+        std::vector<float> cabinetScratch;
+        bool cabinetReleasePending = false;
+        
+        // Merged linear stage (fade 0 = live filters, 1 = merged kernel). A withdrawn or replaced
+        // kernel keeps running as the handoff's previous object until the fade back to live ends
+        RealtimeHandoff<LinearStage::MergedKernel> mergedKernel;
+        LinearStage::MergedKernel* activeMergedKernel = nullptr;
+        juce::LinearSmoothedValue<float> mergedFade;
+        std::vector<float> mergedScratch;
+        bool mergedWanted = false;
+        bool mergedReleasePending = false;
+        
+        // Sizes of the objects last published, as the handoffs' current objects belong to the audio thread
+        std::atomic<size_t> captureBytes { 0 }, cabinetBytes { 0 }, mergedBytes { 0 };
+
         void updateFilters (float bass, float mid, float treble, float presence);
+        void processNonlinearSubBlock (float* channelData, int numSamples, int voice, int mode,
+                                       StageProfiler::BlockProfile& profile);
+        void updateCabinet();
+        void processCabinet (float* channelData, int numSamples);
+        void updateMergedKernel (int numSamples, const LinearStage::Settings& settings);
+        void resetLiveStage();
+        void setToneStackMode (bool passive);
         float applyRectifierSaturation (float input, float drive, float rectifierMode);
         float applyPreampStage (float input, float stageGain, int stageNumber);
+        
+        float shape (float x) const noexcept { return quality.accurateTanh ? std::tanh (x) : Quality::fastTanh (x); }
+        
+       #if GAINFORGE_HEADLESS
+        friend struct AmpEmulatorProbe; // Micro-benchmarks time the private stages in isolation
+       #endif
     };
     
-    AmpEmulator ampEmulator[2]; // One per channel (stereo)
+    // Lock-free event log, drained to a rotating file by a shared writer thread
+    RealtimeLog::Ring logRing;
+    juce::SharedResourcePointer<RealtimeLog::Writer> logWriter;
+
+    // Every live callback timed against its deadline; a shared thread saves the summary
+    DeadlineWatchdog::Monitor deadlineMonitor;
+    juce::SharedResourcePointer<DeadlineWatchdog::Writer> deadlineWriter;
+
+   #if GAINFORGE_ENABLE_PROFILING
+    StageProfiler::Accumulator stageProfiler; // One block per chunk and stage, summed over every emulator that ran
+   #endif
+
+    // Computes cabinet convolution tails for every instance; outlives the emulators' convolvers
+    juce::SharedResourcePointer<Cabinet::TailWorker> cabinetWorker;
+
+    // Last block's parameter values, for logging jumps and switches
+    ParameterSnapshot lastLoggedParameters;
+    bool lastBypassed = false;
+    bool hasParameterHistory = false;
+
+    void logParameterChanges (const ParameterSnapshot& parameters);
+
+    // Two engine banks of one emulator per channel (stereo). Only the active bank
+    // runs normally; the other renders the outgoing sound during a crossfade.
+    AmpEmulator ampEmulator[2][2]; // [bank][channel]
+    int activeBank = 0;
+    ParameterSnapshot activeBankParameters;   // What the active bank rendered last block
+    ParameterSnapshot fadingBankParameters;   // Frozen settings of the outgoing bank
+    juce::LinearSmoothedValue<float> engineFade; // 0 -> 1 as the active bank fades in
+    bool engineCrossfadePending = false;
+    bool lastChunkCrossfaded = false;            // A new fade waits until the last one has left the pipeline
+
+    /**
+        One block on its way through the engine. Everything the two stages need
+        is captured when the block starts, so the nonlinear stage of one block
+        can run on the pipeline worker while the audio thread runs the linear
+        stage of the block before it.
+    */
+    struct EngineChunk
+    {
+        juce::AudioBuffer<float> audio;       // Input, then the active bank's output, then the mix
+        juce::AudioBuffer<float> fadeAudio;   // Outgoing bank during a crossfade
+        int numChannels = 0;
+        int numSamples = 0;
+        int bank = 0;
+        bool crossfading = false;
+        ParameterSnapshot parameters, fadingParameters;
+        juce::LinearSmoothedValue<float> fade;
+    };
+
+    EngineChunk chunks[2];
+    int nextChunk = 0;
+
+    ParameterSnapshot readParameters() const noexcept;
+    void startEngineCrossfade (const ParameterSnapshot& newParameters); // Incoming bank runs activeTier
+    void beginChunk (EngineChunk& chunk, const juce::AudioBuffer<float>& input, int numChannels, int numSamples);
+    void runNonlinearStage (EngineChunk& chunk);
+    void runLinearStage (EngineChunk& chunk);
+    void updateQualityTier (juce::int64 blockStartTicks, int numSamples);
+    void setActiveTierLatency();
+
     double currentSampleRate = 44100.0;
+    int currentBlockSize = 512;   // Convolvers size their audio-thread head to it
+
+    // Quality tiers: a change is applied to the idle bank and crossfaded in like a preset switch
+    CpuGovernor governor;
+    Quality::Tier activeTier = Quality::Tier::standard;
+    Quality::Tier wantedTier = Quality::Tier::standard; // Applied when the next block starts
+    std::atomic<int> currentQualityTier { (int) Quality::Tier::standard };
+    bool governorActive = false;
+
+    // Offline renders switch to the render tier; its FIR latency is reported and the dry path delayed to match
+    juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::None> dryDelay;
+    int dryDelaySamples = 0;
+
+    // Offline pipelining: nonlinear stage on a worker, one block behind on the audio thread.
+    // Chosen in prepareToPlay; the extra block of latency is reported along with the tier's
+    std::atomic<bool> offlinePipeliningEnabled { true };
+    bool pipelineActive = false;      // Prepared for offline pipelining
+    bool pipelineInUse = false;       // ...and the host is rendering offline right now
+    bool latencyForCapture = false;   // Whether the dry delay and reported latency assume a capture
+    int pipelineLatency = 0;
+    BlockDelayFifo pipelineOutput;
+    PipelineWorker pipelineWorker;    // After the emulators and chunks it works on
+
+    void flushPipeline();
+
+    // Cabinet loading: builds the IR for the current rate on backgroundJobs and hands it to every emulator
+    using CabinetBuilder = std::function<std::shared_ptr<const Cabinet::PartitionedIR> (double sampleRate, juce::String& error)>;
+    void loadCabinet (CabinetBuilder build, const juce::String& name);
+    void recallCabinet();
+
+    // Preset switching
+    PresetBank presetBank;
+    int currentProgram = 0;
+    std::atomic<int> presetSequence { 0 };
+    std::atomic<int> appliedPresetSequence { 0 };
+    RealtimeHandoff<PresetChange> presetChanges;
+    int lastPresetSequence = 0;          // Audio thread
+    bool presetOverrideActive = false;   // Audio thread: render the preset until the APVTS has caught up
+    ParameterSnapshot presetOverride;
+
+    /** Pushes a snapshot to the host-visible parameters, coalescing rapid switches into one update. */
+    class HostParameterUpdater : public juce::AsyncUpdater
+    {
+    public:
+        explicit HostParameterUpdater (GainForgeAudioProcessor& p) : owner (p) {}
+        ~HostParameterUpdater() override { cancelPendingUpdate(); }
+
+        void post (const PresetChange& change);
+        void handleAsyncUpdate() override;
+
+    private:
+        GainForgeAudioProcessor& owner;
+        juce::SpinLock lock;
+        PresetChange pending;
+    };
+
+    HostParameterUpdater hostParameterUpdater { *this };
+
+    // Heavy prepare-time work runs on backgroundJobs and arrives here when done
+    RealtimeHandoff<PreparedResources> preparedResources;
+    AsyncPreparer preparer;
+    juce::SharedResourcePointer<SharedDspResourceCache> sharedResources; // Shared by every instance in the process
+
+    // Bypass crossfade: 1.0 = fully processed, 0.0 = fully dry
+    juce::LinearSmoothedValue<float> bypassWetGain;
+    juce::AudioBuffer<float> dryBuffer; // Preallocated in prepareToPlay
+    bool engineIsReset = false;         // Set once the bypass fade has finished and state is cleared
+
+    // Loaded capture and cabinet, for display and session recall. Every load and clear takes a new
+    // generation; a background load only publishes if its generation is still the latest
+    juce::CriticalSection ampModelLock;
+    juce::uint32 ampModelGeneration = 0, cabinetGeneration = 0;
+    juce::String ampModelName;
+    LoadStatus ampModelStatus;
+    juce::String cabinetName;
+    LoadStatus cabinetStatus;
+    juce::String cabinetReport;
+    Cabinet::IirFit::Report cabinetFitReport;
+    std::shared_ptr<const Cabinet::PartitionedIR> mergeableCabinet; // The exact cabinet IR, if one is running
+    std::shared_ptr<const Cabinet::PartitionedIR> loadedCabinet;    // Kept while an approximation runs, so the cache keeps it too
+
+    // Merged linear stage: the message-thread timer waits for the knobs to settle, then renders on backgroundJobs
+    LinearStage::Settings pendingMergeSettings, builtMergeSettings;
+    const Cabinet::PartitionedIR* builtMergeCabinet = nullptr;
+    int mergeSettleTicks = 0;
+    std::atomic<size_t> mergedKernelBytes { 0 }; // The IR last published, shared by every emulator
+
+    void timerCallback() override;
+    void clearMergedKernels();
+    std::atomic<double> cabinetTailSeconds { 0.0 };
+
+    // Serialised state, rebuilt only after a parameter or the loaded capture has changed
+    juce::CriticalSection stateLock;
+    juce::MemoryBlock cachedState;
+    std::atomic<bool> stateDirty { true };
+
+    void parameterChanged (const juce::String& parameterID, float newValue) override;
+    void applyState (const BinaryState::Contents& contents);
+    void setLegacyXmlState (const void* data, int sizeInBytes);
+
+    // Model loading and other blocking work (declared last so jobs finish before the emulators go away)
+    juce::ThreadPool backgroundJobs { 1 };
+
+   #if GAINFORGE_HEADLESS
+    friend struct AmpEmulatorProbe;
+   #endif
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GainForgeAudioProcessor)
 };
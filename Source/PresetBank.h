@@ -0,0 +1,173 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+
+//==============================================================================
+/**
+    Compact POD copy of every sound parameter (everything except BYPASS).
+
+    Values are stored in parameter units, i.e. exactly what
+    getRawParameterValue() returns: 0..1 for the knobs, 0/1 for the rectifier
+    and tone-stack switches, and the choice index (0..2) for Voice and Mode.
+*/
+struct ParameterSnapshot
+{
+    enum Index
+    {
+        gain, bass, mid, treble, presence, master, drive,
+        rectifierMode, voice, mode, toneStack,
+        numParameters
+    };
+
+    static const char* getParameterID (int index) noexcept
+    {
+        static const char* const ids[numParameters] =
+        {
+            "GAIN", "BASS", "MID", "TREBLE", "PRESENCE", "MASTER", "DRIVE",
+            "RECTIFIER_MODE", "VOICE", "MODE", "TONE_STACK"
+        };
+
+        return juce::isPositiveAndBelow (index, (int) numParameters) ? ids[index] : "";
+    }
+
+    float& operator[] (int index) noexcept             { return values[(size_t) index]; }
+    float operator[] (int index) const noexcept        { return values[(size_t) index]; }
+
+    bool operator== (const ParameterSnapshot& other) const noexcept { return values == other.values; }
+    bool operator!= (const ParameterSnapshot& other) const noexcept { return values != other.values; }
+
+    std::array<float, numParameters> values {};
+};
+
+//==============================================================================
+/** A snapshot handed to the audio thread, tagged so repeated switches are never confused. */
+struct PresetChange
+{
+    ParameterSnapshot parameters;
+    int sequence = 0;
+};
+
+//==============================================================================
+/**
+    Factory presets plus user presets saved to disk. Message thread only - the
+    audio thread only ever sees copies of snapshots.
+*/
+class PresetBank
+{
+public:
+    struct Preset
+    {
+        juce::String name;
+        ParameterSnapshot parameters;
+        bool isFactory = false;
+    };
+
+    PresetBank()
+    {
+        //                    gain   bass   mid    treb   pres   mast   drive  rect  voice mode  stack
+        addFactory ("Init",           { 0.00f, 0.50f, 0.50f, 0.50f, 0.50f, 0.00f, 0.30f, 0.0f, 1.0f, 2.0f, 0.0f });
+        addFactory ("Modern Metal",   { 0.70f, 0.65f, 0.25f, 0.60f, 0.60f, 0.40f, 0.40f, 0.0f, 2.0f, 2.0f, 0.0f });
+        addFactory ("Tight Rhythm",   { 0.60f, 0.45f, 0.35f, 0.65f, 0.55f, 0.40f, 0.30f, 0.0f, 0.0f, 2.0f, 1.0f });
+        addFactory ("Vintage Sag",    { 0.55f, 0.55f, 0.50f, 0.50f, 0.45f, 0.40f, 0.50f, 1.0f, 1.0f, 1.0f, 1.0f });
+        addFactory ("Crunch",         { 0.45f, 0.50f, 0.60f, 0.55f, 0.50f, 0.45f, 0.20f, 0.0f, 1.0f, 1.0f, 0.0f });
+        addFactory ("Lead",           { 0.80f, 0.55f, 0.55f, 0.60f, 0.65f, 0.40f, 0.60f, 1.0f, 2.0f, 2.0f, 1.0f });
+        addFactory ("Clean",          { 0.30f, 0.55f, 0.50f, 0.55f, 0.50f, 0.35f, 0.00f, 0.0f, 1.0f, 0.0f, 1.0f });
+
+        loadUserPresets();
+    }
+
+    int getNumPresets() const noexcept                  { return (int) presets.size(); }
+    const Preset& getPreset (int index) const           { return presets[(size_t) juce::jlimit (0, getNumPresets() - 1, index)]; }
+
+    void setName (int index, const juce::String& newName)
+    {
+        if (juce::isPositiveAndBelow (index, getNumPresets()) && ! presets[(size_t) index].isFactory)
+        {
+            presets[(size_t) index].name = newName;
+            saveUserPresets();
+        }
+    }
+
+    /** Adds (or overwrites, if the name exists) a user preset and saves the user bank. Returns its index. */
+    int saveUserPreset (const juce::String& name, const ParameterSnapshot& parameters)
+    {
+        for (int i = 0; i < getNumPresets(); ++i)
+        {
+            if (! presets[(size_t) i].isFactory && presets[(size_t) i].name == name)
+            {
+                presets[(size_t) i].parameters = parameters;
+                saveUserPresets();
+                return i;
+            }
+        }
+
+        presets.push_back ({ name, parameters, false });
+        saveUserPresets();
+        return getNumPresets() - 1;
+    }
+
+    void deleteUserPreset (int index)
+    {
+        if (juce::isPositiveAndBelow (index, getNumPresets()) && ! presets[(size_t) index].isFactory)
+        {
+            presets.erase (presets.begin() + index);
+            saveUserPresets();
+        }
+    }
+
+    static juce::File getUserPresetFile()
+    {
+        return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+                   .getChildFile ("CK Audio Design").getChildFile ("GAINFORGE").getChildFile ("UserPresets.xml");
+    }
+
+private:
+    void addFactory (const juce::String& name, std::initializer_list<float> values)
+    {
+        Preset preset { name, {}, true };
+        std::copy (values.begin(), values.end(), preset.parameters.values.begin());
+        presets.push_back (preset);
+    }
+
+    void loadUserPresets()
+    {
+        auto xml = juce::XmlDocument::parse (getUserPresetFile());
+        if (xml == nullptr || ! xml->hasTagName ("GAINFORGE_PRESETS"))
+            return;
+
+        for (auto* element : xml->getChildWithTagNameIterator ("PRESET"))
+        {
+            Preset preset { element->getStringAttribute ("name"), {}, false };
+
+            for (int i = 0; i < ParameterSnapshot::numParameters; ++i)
+                preset.parameters[i] = (float) element->getDoubleAttribute (ParameterSnapshot::getParameterID (i),
+                                                                             presets.front().parameters[i]);
+
+            presets.push_back (preset);
+        }
+    }
+
+    void saveUserPresets() const
+    {
+        juce::XmlElement xml ("GAINFORGE_PRESETS");
+
+        for (auto& preset : presets)
+        {
+            if (preset.isFactory)
+                continue;
+
+            auto* element = xml.createNewChildElement ("PRESET");
+            element->setAttribute ("name", preset.name);
+
+            for (int i = 0; i < ParameterSnapshot::numParameters; ++i)
+                element->setAttribute (ParameterSnapshot::getParameterID (i), (double) preset.parameters[i]);
+        }
+
+        getUserPresetFile().getParentDirectory().createDirectory();
+        xml.writeTo (getUserPresetFile());
+    }
+
+    std::vector<Preset> presets;
+};
@@ -0,0 +1,301 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+#include "PresetBank.h"
+
+//==============================================================================
+/**
+    Large read-only preset collections (thousands of artist/song tones) in a
+    single memory-mapped file.
+
+    Layout (little endian):
+        Header  (32 bytes)  magic 'GFPL', version, record count, values per record
+        Record  (192 bytes) name[56], tags[72], float values[16], repeated
+
+    Records are fixed size, so preset N lives at a known offset: browsing
+    reads names straight out of the mapping and recall copies the values into
+    a ParameterSnapshot. Search scans the mapped names and tags in place
+    without building any per-preset objects. Strings are UTF-8, zero padded
+    and truncated to fit; tags are a comma-separated list.
+*/
+class PresetLibrary
+{
+public:
+    static constexpr juce::uint32 magic = 0x4c504647; // "GFPL" read as little endian
+    static constexpr juce::uint32 currentVersion = 1;
+    static constexpr int maxNameBytes = 56;
+    static constexpr int maxTagBytes = 72;
+    static constexpr int maxValues = 16; // Room for parameters added later
+
+    struct Header
+    {
+        juce::uint32 magic;
+        juce::uint32 version;
+        juce::uint32 numRecords;
+        juce::uint32 numValues;
+        juce::uint32 reserved[4];
+    };
+
+    struct Record
+    {
+        char name[maxNameBytes];
+        char tags[maxTagBytes];
+        float values[maxValues];
+    };
+
+    static_assert (sizeof (Header) == 32, "Header layout is part of the file format");
+    static_assert (sizeof (Record) == 192, "Record layout is part of the file format");
+
+    /** One preset, as handed to write(). */
+    struct Entry
+    {
+        juce::String name;
+        juce::String tags;
+        ParameterSnapshot parameters;
+    };
+
+    //==============================================================================
+    /** Writes a library file from scratch. Message/background thread. */
+    static bool write (const juce::File& file, const std::vector<Entry>& entries)
+    {
+        juce::FileOutputStream out (file);
+        if (out.failedToOpen())
+            return false;
+
+        out.setPosition (0);
+        out.truncate();
+
+        Header header {};
+        header.magic = juce::ByteOrder::swapIfBigEndian (magic);
+        header.version = juce::ByteOrder::swapIfBigEndian (currentVersion);
+        header.numRecords = juce::ByteOrder::swapIfBigEndian ((juce::uint32) entries.size());
+        header.numValues = juce::ByteOrder::swapIfBigEndian ((juce::uint32) ParameterSnapshot::numParameters);
+        out.write (&header, sizeof (header));
+
+        for (auto& entry : entries)
+        {
+            Record record {};
+            copyString (entry.name, record.name, maxNameBytes);
+            copyString (entry.tags, record.tags, maxTagBytes);
+
+            for (int i = 0; i < ParameterSnapshot::numParameters; ++i)
+                record.values[i] = juce::ByteOrder::swapIfBigEndian (entry.parameters[i]);
+
+            out.write (&record, sizeof (record));
+        }
+
+        out.flush();
+        return out.getStatus().wasOk();
+    }
+
+    //==============================================================================
+    /** Maps a library file. Returns false (and stays closed) if it isn't a valid library. */
+    bool open (const juce::File& file)
+    {
+        close();
+
+        auto mapped = std::make_unique<juce::MemoryMappedFile> (file, juce::MemoryMappedFile::readOnly);
+        if (mapped->getData() == nullptr || mapped->getSize() < sizeof (Header))
+            return false;
+
+        Header header;
+        std::memcpy (&header, mapped->getData(), sizeof (header));
+
+        const auto count = (size_t) juce::ByteOrder::swapIfBigEndian (header.numRecords);
+        if (juce::ByteOrder::swapIfBigEndian (header.magic) != magic
+             || juce::ByteOrder::swapIfBigEndian (header.version) != currentVersion
+             || mapped->getSize() < sizeof (Header) + count * sizeof (Record))
+            return false;
+
+        numValues = juce::jmin ((int) juce::ByteOrder::swapIfBigEndian (header.numValues), maxValues);
+        records = reinterpret_cast<const Record*> (static_cast<const char*> (mapped->getData()) + sizeof (Header));
+        numRecords = (int) count;
+        mapping = std::move (mapped);
+        return true;
+    }
+
+    void close()
+    {
+        records = nullptr;
+        numRecords = 0;
+        mapping.reset();
+    }
+
+    bool isOpen() const noexcept                    { return mapping != nullptr; }
+    int getNumPresets() const noexcept              { return numRecords; }
+
+    juce::String getName (int index) const          { return readString (getRecord (index).name, maxNameBytes); }
+    juce::String getTags (int index) const          { return readString (getRecord (index).tags, maxTagBytes); }
+
+    /** Direct read into a snapshot; parameters the file doesn't know about keep their defaults. */
+    ParameterSnapshot getParameters (int index, const ParameterSnapshot& defaults = {}) const
+    {
+        auto& record = getRecord (index);
+        ParameterSnapshot snapshot = defaults;
+
+        for (int i = 0; i < juce::jmin (numValues, (int) ParameterSnapshot::numParameters); ++i)
+            snapshot[i] = juce::ByteOrder::swapIfBigEndian (record.values[i]);
+
+        return snapshot;
+    }
+
+    /**
+        Indices of presets whose name or tags contain every whitespace-separated
+        word of the query (ASCII case-insensitive). An empty query matches all.
+    */
+    std::vector<int> search (const juce::String& query, int maxResults = std::numeric_limits<int>::max()) const
+    {
+        const auto words = prepareQuery (query);
+        std::vector<int> results;
+
+        for (int i = 0; i < numRecords && (int) results.size() < maxResults; ++i)
+        {
+            auto& record = records[i];
+            bool matchesAll = true;
+
+            for (auto& word : words)
+            {
+                if (! containsIgnoringCase (record.name, maxNameBytes, word)
+                     && ! containsIgnoringCase (record.tags, maxTagBytes, word))
+                {
+                    matchesAll = false;
+                    break;
+                }
+            }
+
+            if (matchesAll)
+                results.push_back (i);
+        }
+
+        return results;
+    }
+
+    /** Indices of presets carrying the given tag (exact tag, ASCII case-insensitive). */
+    std::vector<int> filterByTag (const juce::String& tag) const
+    {
+        const auto wanted = foldAscii (tag.trim().toStdString());
+        std::vector<int> results;
+
+        for (int i = 0; i < numRecords; ++i)
+        {
+            const char* tags = records[i].tags;
+            int start = 0;
+
+            for (int pos = 0; pos <= maxTagBytes; ++pos)
+            {
+                if (pos == maxTagBytes || tags[pos] == ',' || tags[pos] == 0)
+                {
+                    if (tagEquals (tags + start, pos - start, wanted))
+                    {
+                        results.push_back (i);
+                        break;
+                    }
+
+                    if (pos == maxTagBytes || tags[pos] == 0)
+                        break;
+
+                    start = pos + 1;
+                }
+            }
+        }
+
+        return results;
+    }
+
+private:
+    const Record& getRecord (int index) const
+    {
+        jassert (juce::isPositiveAndBelow (index, numRecords));
+        return records[juce::jlimit (0, juce::jmax (0, numRecords - 1), index)];
+    }
+
+    static void copyString (const juce::String& text, char* dest, int maxBytes)
+    {
+        // Truncate on a character boundary so the stored UTF-8 stays valid
+        auto utf8 = text.toUTF8();
+        int bytes = 0;
+
+        for (auto p = utf8; ! p.isEmpty(); ++p)
+        {
+            const auto charBytes = (int) juce::CharPointer_UTF8::getBytesRequiredFor (*p);
+            if (bytes + charBytes > maxBytes)
+                break;
+
+            bytes += charBytes;
+        }
+
+        std::memcpy (dest, utf8.getAddress(), (size_t) bytes);
+    }
+
+    static juce::String readString (const char* source, int maxBytes)
+    {
+        int length = 0;
+        while (length < maxBytes && source[length] != 0)
+            ++length;
+
+        return juce::String::fromUTF8 (source, length);
+    }
+
+    static char toLowerAscii (char c) noexcept      { return (c >= 'A' && c <= 'Z') ? (char) (c + ('a' - 'A')) : c; }
+
+    // The query is folded exactly as the mapped bytes are: ASCII letters only, so a word
+    // with accented capitals matches the same bytes it would in a record
+    static std::string foldAscii (std::string text)
+    {
+        for (auto& c : text)
+            c = toLowerAscii (c);
+
+        return text;
+    }
+
+    static std::vector<std::string> prepareQuery (const juce::String& query)
+    {
+        std::vector<std::string> words;
+        for (auto& word : juce::StringArray::fromTokens (query, true))
+            if (word.isNotEmpty())
+                words.push_back (foldAscii (word.toStdString()));
+
+        return words;
+    }
+
+    static bool containsIgnoringCase (const char* field, int maxBytes, const std::string& word) noexcept
+    {
+        const int wordLength = (int) word.size();
+
+        for (int start = 0; start + wordLength <= maxBytes && field[start] != 0; ++start)
+        {
+            int i = 0;
+            while (i < wordLength && toLowerAscii (field[start + i]) == word[(size_t) i])
+                ++i;
+
+            if (i == wordLength)
+                return true;
+        }
+
+        return false;
+    }
+
+    static bool tagEquals (const char* tag, int length, const std::string& wanted) noexcept
+    {
+        while (length > 0 && *tag == ' ')               { ++tag; --length; }
+        while (length > 0 && tag[length - 1] == ' ')    --length;
+
+        if (length != (int) wanted.size())
+            return false;
+
+        for (int i = 0; i < length; ++i)
+            if (toLowerAscii (tag[i]) != wanted[(size_t) i])
+                return false;
+
+        return true;
+    }
+
+    std::unique_ptr<juce::MemoryMappedFile> mapping;
+    const Record* records = nullptr;
+    int numRecords = 0;
+    int numValues = 0;
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+//==============================================================================
+/**
+    Per-stage timing table drawn over the panel in profiling builds: mean,
+    p99 and min ns per sample, plus each stage's share of one core at the
+    current sample rate. Click to reset the statistics.
+*/
+class ProfilerOverlay : public juce::Component,
+                        private juce::Timer
+{
+public:
+    explicit ProfilerOverlay (GainForgeAudioProcessor& p) : processor (p)
+    {
+        startTimerHz (4);
+    }
+
+    void mouseUp (const juce::MouseEvent&) override
+    {
+        processor.resetStageStats();
+    }
+
+    void paint (juce::Graphics& g) override
+    {
+        g.setColour (juce::Colours::black.withAlpha (0.75f));
+        g.fillRoundedRectangle (getLocalBounds().toFloat(), 6.0f);
+
+        g.setFont (juce::Font (juce::Font::getDefaultMonospacedFontName(), 11.0f, juce::Font::plain));
+        g.setColour (juce::Colours::white);
+
+        auto area = getLocalBounds().reduced (8, 6);
+        const int lineHeight = juce::jmax (1, area.getHeight() / (StageProfiler::numStages + 2));
+
+        auto drawLine = [&] (const juce::String& text)
+        {
+            g.drawText (text, area.removeFromTop (lineHeight), juce::Justification::centredLeft, false);
+        };
+
+        drawLine ("stage          mean    p99    min  core  (ns/sample)");
+
+        const double sampleRate = processor.getSampleRate();
+        double totalMean = 0.0;
+
+        for (int stage = 0; stage < StageProfiler::numStages; ++stage)
+        {
+            const auto& s = stats[(size_t) stage];
+            totalMean += s.mean;
+            drawLine (juce::String (StageProfiler::getStageName (stage)).paddedRight (' ', 12)
+                      + juce::String (s.mean, 1).paddedLeft (' ', 7) + juce::String (s.p99, 1).paddedLeft (' ', 7)
+                      + juce::String (s.minimum, 1).paddedLeft (' ', 7)
+                      + (juce::String (s.mean * sampleRate * 1.0e-7, 1) + "%").paddedLeft (' ', 6));
+        }
+
+        drawLine (juce::String ("Total").paddedRight (' ', 12) + juce::String (totalMean, 1).paddedLeft (' ', 7)
+                  + juce::String (" ").paddedRight (' ', 14)
+                  + (juce::String (totalMean * sampleRate * 1.0e-7, 1) + "%").paddedLeft (' ', 6));
+    }
+
+private:
+    void timerCallback() override
+    {
+        for (int stage = 0; stage < StageProfiler::numStages; ++stage)
+            stats[(size_t) stage] = processor.getStageStats ((StageProfiler::Stage) stage);
+
+        repaint();
+    }
+
+    GainForgeAudioProcessor& processor;
+    std::array<StageProfiler::Stats, StageProfiler::numStages> stats {};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ProfilerOverlay)
+};
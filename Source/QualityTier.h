@@ -0,0 +1,78 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cmath>
+
+//==============================================================================
+/**
+    DSP quality tiers. Each tier trades CPU for fidelity along three axes:
+
+    - oversampling of the nonlinear preamp/rectifier section (aliasing)
+    - tanh kernel: rational approximation or std::tanh
+    - how often the tone-stack coefficients follow the smoothed knobs
+
+    Eco processes the way the chain did before tiers existed (no
+    oversampling, std::tanh, coefficients once per block). Sessions saved
+    without a quality setting load onto it with Voice and Mode mapped to the
+    branches they actually ran (Mid and Crunch never ran in that chain), and
+    GoldenRender nulls them against a verbatim copy of the original code.
+
+    Live tiers use polyphase IIR oversampling, whose short group delay isn't
+    reported, so they can be switched on the fly without touching latency.
+    The render tier is only used for offline bounces: linear-phase FIR
+    oversampling, whose latency is reported to the host.
+*/
+namespace Quality
+{
+    enum class Tier
+    {
+        eco,
+        standard,
+        high,
+        render
+    };
+
+    static constexpr int numLiveTiers = 3; // eco..high; render is never picked for live use
+
+    struct Settings
+    {
+        int oversamplingOrder = 0;          // Factor = 2^order
+        bool accurateTanh = true;
+        int coefficientUpdateInterval = 0;  // Samples between tone-stack updates; 0 = once per block
+        bool linearPhase = false;           // FIR oversampling (latency reported) instead of IIR
+    };
+
+    inline Settings getSettings (Tier tier) noexcept
+    {
+        switch (tier)
+        {
+            case Tier::eco:          return { 0, true, 0, false };
+            case Tier::high:         return { 2, true, 16, false };
+            case Tier::render:       return { 3, true, 1, true };
+            case Tier::standard:
+            default:                 return { 1, false, 64, false };
+        }
+    }
+
+    inline const char* getTierName (Tier tier) noexcept
+    {
+        switch (tier)
+        {
+            case Tier::eco:          return "Eco";
+            case Tier::standard:     return "Standard";
+            case Tier::high:         return "High";
+            case Tier::render:       return "Render";
+            default:                 return "Unknown";
+        }
+    }
+
+    /** Rational tanh approximation (max error ~1e-4), clamped so it never leaves [-1, 1]. */
+    inline float fastTanh (float x) noexcept
+    {
+        x = juce::jlimit (-4.97f, 4.97f, x);
+        const float x2 = x * x;
+        const float numerator = x * (135135.0f + x2 * (17325.0f + x2 * (378.0f + x2)));
+        const float denominator = 135135.0f + x2 * (62370.0f + x2 * (3150.0f + x2 * 28.0f));
+        return juce::jlimit (-1.0f, 1.0f, numerator / denominator);
+    }
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+
+//==============================================================================
+/**
+    Hands heap objects built on a background thread to the audio thread
+    without locks or deallocation on the audio thread.
+
+    - publish() may be called from any non-audio thread. Publishing nullptr
+      clears the current object.
+    - acquire() is called once per block on the audio thread. It swaps in the
+      newest published object and parks the previous one in a retire slot.
+    - collectGarbage() frees retired objects; call it from any non-audio thread
+      (publish() does this automatically).
+
+    The audio thread only swaps when the retire slot is empty, so an object is
+    never freed while it might still be in use.
+*/
+template <typename ObjectType>
+class RealtimeHandoff
+{
+public:
+    RealtimeHandoff() = default;
+
+    ~RealtimeHandoff()
+    {
+        delete pending.exchange (nullptr);
+        delete retired.exchange (nullptr);
+        delete previous;
+        delete current;
+    }
+
+    //==============================================================================
+    void publish (std::unique_ptr<ObjectType> next)
+    {
+        collectGarbage();
+
+        auto* box = new Box { std::move (next) };
+        delete pending.exchange (box, std::memory_order_acq_rel); // Never consumed, safe to drop
+    }
+
+    void collectGarbage()
+    {
+        delete retired.exchange (nullptr, std::memory_order_acq_rel);
+    }
+
+    //==============================================================================
+    /** Audio thread: picks up any newly published object and returns the current one. */
+    ObjectType* acquire() noexcept
+    {
+        if (pending.load (std::memory_order_relaxed) != nullptr
+             && retired.load (std::memory_order_acquire) == nullptr)
+        {
+            if (auto* next = pending.exchange (nullptr, std::memory_order_acq_rel))
+            {
+                retired.store (current, std::memory_order_release);
+                current = next;
+            }
+        }
+
+        return get();
+    }
+
+    /**
+        Audio thread: like acquire(), but the outgoing object stays usable through
+        getPrevious() until releasePrevious() - e.g. to crossfade from it. Doesn't
+        swap again while a previous object is still held.
+    */
+    ObjectType* acquireKeepingPrevious() noexcept
+    {
+        if (! holdingPrevious && pending.load (std::memory_order_relaxed) != nullptr)
+        {
+            if (auto* next = pending.exchange (nullptr, std::memory_order_acq_rel))
+            {
+                previous = current;
+                current = next;
+                holdingPrevious = true;
+            }
+        }
+
+        return get();
+    }
+
+    /** Audio thread: the object replaced by the last acquireKeepingPrevious() (may be nullptr). */
+    ObjectType* getPrevious() const noexcept
+    {
+        return previous != nullptr ? previous->object.get() : nullptr;
+    }
+
+    /** Audio thread: hands the previous object over for deletion. Returns false (try again later) while the retire slot is full. */
+    bool releasePrevious() noexcept
+    {
+        if (previous != nullptr)
+        {
+            if (retired.load (std::memory_order_acquire) != nullptr)
+                return false;
+
+            retired.store (previous, std::memory_order_release);
+            previous = nullptr;
+        }
+
+        holdingPrevious = false;
+        return true;
+    }
+
+    /** Audio thread: the object returned by the last acquire(). */
+    ObjectType* get() const noexcept
+    {
+        return current != nullptr ? current->object.get() : nullptr;
+    }
+
+private:
+    struct Box
+    {
+        std::unique_ptr<ObjectType> object;
+    };
+
+    std::atomic<Box*> pending { nullptr };
+    std::atomic<Box*> retired { nullptr };
+    Box* current = nullptr; // Owned by the audio thread
+    Box* previous = nullptr; // Ditto, between acquireKeepingPrevious() and releasePrevious()
+    bool holdingPrevious = false;
+
+    JUCE_DECLARE_NON_COPYABLE (RealtimeHandoff)
+};
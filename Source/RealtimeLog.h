@@ -0,0 +1,254 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <vector>
+
+//==============================================================================
+/**
+    Real-time-safe event logging for the audio thread.
+
+    The audio thread pushes fixed-size records into a preallocated lock-free
+    ring (one per plugin instance, single producer). A process-wide writer
+    thread drains every registered ring into a rotating log file, so nothing on
+    the audio thread allocates, locks or touches the file system.
+*/
+namespace RealtimeLog
+{
+    /** Event ids. The meaning of the numeric fields is listed per event. */
+    enum class Event : juce::uint32
+    {
+        parameterJump,      // index, old value, new value
+        modeSwitch,         // old, new
+        voiceSwitch,        // old, new
+        rectifierSwitch,    // old, new
+        toneStackSwitch,    // old, new
+        bypassChanged,      // bypassed (0/1)
+        clippingStarted,    // peak
+        clippingStopped,    // clipped samples in the run, peak
+        nonFiniteSample,    // samples in block
+        captureModelChanged // hidden size (0 = cleared)
+    };
+
+    inline const char* getEventName (juce::uint32 event) noexcept
+    {
+        static const char* const names[] =
+        {
+            "ParameterJump", "ModeSwitch", "VoiceSwitch", "RectifierSwitch", "ToneStackSwitch",
+            "BypassChanged", "ClippingStarted", "ClippingStopped", "NonFiniteSample", "CaptureModelChanged"
+        };
+
+        return event < (juce::uint32) juce::numElementsInArray (names) ? names[event] : "Unknown";
+    }
+
+    /** One log entry - 32 bytes, trivially copyable. */
+    struct Record
+    {
+        juce::int64 ticks = 0; // juce::Time::getHighResolutionTicks()
+        juce::uint32 event = 0;
+        juce::int32 channel = -1; // -1 = not channel specific
+        float values[4] {};
+    };
+
+    //==============================================================================
+    /** Single-producer/single-consumer ring. push() is wait-free and never allocates. */
+    class Ring
+    {
+    public:
+        static constexpr int capacity = 1024;
+
+        void push (Event event, int channel, float v0 = 0.0f, float v1 = 0.0f, float v2 = 0.0f, float v3 = 0.0f) noexcept
+        {
+            int start1, size1, start2, size2;
+            fifo.prepareToWrite (1, start1, size1, start2, size2);
+
+            if (size1 + size2 == 0)
+            {
+                dropped.fetch_add (1, std::memory_order_relaxed);
+                return;
+            }
+
+            auto& r = records[(size_t) (size1 > 0 ? start1 : start2)];
+            r.ticks = juce::Time::getHighResolutionTicks();
+            r.event = (juce::uint32) event;
+            r.channel = channel;
+            r.values[0] = v0;
+            r.values[1] = v1;
+            r.values[2] = v2;
+            r.values[3] = v3;
+
+            fifo.finishedWrite (1);
+        }
+
+        /** Consumer side (writer thread only). */
+        bool pop (Record& out) noexcept
+        {
+            int start1, size1, start2, size2;
+            fifo.prepareToRead (1, start1, size1, start2, size2);
+
+            if (size1 + size2 == 0)
+                return false;
+
+            out = records[(size_t) (size1 > 0 ? start1 : start2)];
+            fifo.finishedRead (1);
+            return true;
+        }
+
+        juce::uint32 takeDroppedCount() noexcept { return dropped.exchange (0, std::memory_order_relaxed); }
+
+    private:
+        juce::AbstractFifo fifo { capacity };
+        std::array<Record, capacity> records {};
+        std::atomic<juce::uint32> dropped { 0 };
+    };
+
+    //==============================================================================
+    /**
+        Process-wide drain thread. Hold it through juce::SharedResourcePointer so
+        all instances share one thread and one file.
+    */
+    class Writer : private juce::Thread
+    {
+    public:
+        static constexpr juce::int64 maxFileSize = 1024 * 1024;
+        static constexpr int numBackups = 3;
+
+        Writer()
+            : juce::Thread ("GAINFORGE log writer"),
+              anchorTicks (juce::Time::getHighResolutionTicks()),
+              anchorMillis (juce::Time::currentTimeMillis())
+        {
+            logFile = getLogDirectory().getChildFile ("GainForge_realtime.log");
+            startThread (juce::Thread::Priority::low);
+        }
+
+        ~Writer() override
+        {
+            stopThread (2000);
+        }
+
+        static juce::File getLogDirectory()
+        {
+            return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+                       .getChildFile ("CK Audio Design").getChildFile ("GAINFORGE").getChildFile ("Logs");
+        }
+
+        /** Message thread: start draining a ring. The ring must stay alive until removeRing(). */
+        void addRing (Ring* ring, const juce::String& instanceName)
+        {
+            const juce::ScopedLock sl (ringLock);
+            rings.push_back ({ ring, instanceName });
+        }
+
+        void removeRing (Ring* ring)
+        {
+            const juce::ScopedLock sl (ringLock);
+            drain (ring); // Flush what's left before the instance goes away
+            rings.erase (std::remove_if (rings.begin(), rings.end(),
+                                         [ring] (const Source& s) { return s.ring == ring; }),
+                         rings.end());
+        }
+
+    private:
+        struct Source
+        {
+            Ring* ring;
+            juce::String name;
+        };
+
+        void run() override
+        {
+            while (! threadShouldExit())
+            {
+                {
+                    const juce::ScopedLock sl (ringLock);
+                    for (auto& source : rings)
+                        drain (source.ring);
+                }
+
+                wait (200);
+            }
+
+            stream.reset();
+        }
+
+        // Called with ringLock held
+        void drain (Ring* ring)
+        {
+            juce::String name;
+            for (auto& source : rings)
+                if (source.ring == ring)
+                    name = source.name;
+
+            juce::String text;
+            Record r;
+
+            while (ring->pop (r))
+            {
+                const auto millis = anchorMillis + (juce::int64) (1000.0 * juce::Time::highResolutionTicksToSeconds (r.ticks - anchorTicks));
+
+                text << juce::Time (millis).formatted ("%Y-%m-%d %H:%M:%S.") << juce::String (millis % 1000).paddedLeft ('0', 3)
+                     << " " << name
+                     << (r.channel >= 0 ? " ch" + juce::String (r.channel) : juce::String (" --"))
+                     << " " << getEventName (r.event);
+
+                for (auto v : r.values)
+                    text << " " << juce::String (v, 4);
+
+                text << juce::newLine;
+            }
+
+            if (const auto dropped = ring->takeDroppedCount())
+                text << name << " dropped " << (int) dropped << " records" << juce::newLine;
+
+            if (text.isNotEmpty())
+                write (text);
+        }
+
+        void write (const juce::String& text)
+        {
+            if (stream == nullptr || stream->getPosition() > maxFileSize)
+                rotate();
+
+            if (stream != nullptr)
+            {
+                stream->writeText (text, false, false, nullptr);
+                stream->flush();
+            }
+        }
+
+        void rotate()
+        {
+            stream.reset();
+            logFile.getParentDirectory().createDirectory();
+
+            if (logFile.getSize() > maxFileSize)
+            {
+                auto backup = [this] (int index) { return logFile.getSiblingFile (logFile.getFileName() + "." + juce::String (index)); };
+
+                backup (numBackups).deleteFile();
+                for (int i = numBackups - 1; i >= 1; --i)
+                    backup (i).moveFileTo (backup (i + 1));
+
+                logFile.moveFileTo (backup (1));
+            }
+
+            stream = std::make_unique<juce::FileOutputStream> (logFile);
+            if (stream->failedToOpen())
+                stream.reset();
+        }
+
+        juce::CriticalSection ringLock;
+        std::vector<Source> rings;
+
+        juce::File logFile;
+        std::unique_ptr<juce::FileOutputStream> stream;
+
+        const juce::int64 anchorTicks;
+        const juce::int64 anchorMillis;
+
+        JUCE_DECLARE_NON_COPYABLE (Writer)
+    };
+}
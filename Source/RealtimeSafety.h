@@ -0,0 +1,168 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+#if JUCE_LINUX || JUCE_MAC
+ #include <execinfo.h>
+#endif
+
+//==============================================================================
+/**
+    Debug/test check that the audio thread never allocates, frees or blocks on
+    a lock.
+
+    With GAINFORGE_RT_SAFETY_CHECKS=1, processBlock marks the calling thread
+    for the duration of the callback (and the offline pipeline's worker for
+    each block it processes). An offline callback waits for that worker by
+    design, so for those only allocations and frees are reported. The hooks that call report() - malloc,
+    free, new/delete, pthread mutex and condition waits, futex syscalls - are
+    interposed by the checking executable (Tools/RealtimeSafetyCheck), never
+    by the plugin itself. Without the flag none of this is compiled in.
+
+    report() only records: a fixed slot with the violation and its raw stack
+    frames, no allocation and no locks. Symbolising happens in getReport(),
+    after the audio thread has stopped.
+*/
+namespace RealtimeSafety
+{
+    enum class Violation
+    {
+        allocation,
+        deallocation,
+        mutexLock,
+        conditionWait,
+        futex
+    };
+
+    inline const char* getViolationName (Violation kind) noexcept
+    {
+        switch (kind)
+        {
+            case Violation::allocation:     return "allocation";
+            case Violation::deallocation:   return "deallocation";
+            case Violation::mutexLock:      return "mutex lock";
+            case Violation::conditionWait:  return "condition wait";
+            case Violation::futex:          return "futex";
+            default:                        return "unknown";
+        }
+    }
+
+    static constexpr int maxFrames = 32;
+    static constexpr int maxRecords = 256;
+
+    struct Record
+    {
+        Violation kind = Violation::allocation;
+        size_t bytes = 0;
+        int numFrames = 0;
+        std::array<void*, maxFrames> frames {};
+    };
+
+    namespace Detail
+    {
+        inline thread_local int callbackDepth = 0;
+        inline thread_local int waitingDepth = 0;     // Callbacks that are allowed to block
+        inline thread_local bool reporting = false;    // Guards against hooks fired while recording
+        inline std::array<Record, maxRecords> records;
+        inline std::atomic<int> numReported { 0 };     // Past maxRecords violations are only counted
+        inline std::atomic<bool> enabled { false };
+    }
+
+    /** Marks the current thread as inside an audio callback for its lifetime. */
+    struct ScopedAudioCallback
+    {
+        explicit ScopedAudioCallback (bool mayWait = false) noexcept
+            : waits (mayWait)
+        {
+            ++Detail::callbackDepth;
+            Detail::waitingDepth += waits ? 1 : 0;
+        }
+
+        ~ScopedAudioCallback() noexcept
+        {
+            --Detail::callbackDepth;
+            Detail::waitingDepth -= waits ? 1 : 0;
+        }
+
+        const bool waits;
+    };
+
+    inline bool isInAudioCallback() noexcept
+    {
+        return Detail::callbackDepth > 0;
+    }
+
+    /** Called from the interposed hooks on any thread; records only inside audio callbacks. */
+    inline void report (Violation kind, size_t bytes = 0) noexcept
+    {
+        if (Detail::callbackDepth == 0 || Detail::reporting || ! Detail::enabled.load (std::memory_order_relaxed))
+            return;
+
+        const bool isWait = kind == Violation::mutexLock || kind == Violation::conditionWait || kind == Violation::futex;
+        if (isWait && Detail::waitingDepth > 0)
+            return;
+
+        Detail::reporting = true;
+        const int index = Detail::numReported.fetch_add (1, std::memory_order_relaxed);
+
+        if (index < maxRecords)
+        {
+            auto& record = Detail::records[(size_t) index];
+            record.kind = kind;
+            record.bytes = bytes;
+           #if JUCE_LINUX || JUCE_MAC
+            record.numFrames = backtrace (record.frames.data(), maxFrames);
+           #else
+            record.numFrames = 0;
+           #endif
+        }
+
+        Detail::reporting = false;
+    }
+
+    /** Starts recording. Call before the audio thread starts (the first backtrace allocates). */
+    inline void enable()
+    {
+       #if JUCE_LINUX || JUCE_MAC
+        void* warmUp[2];
+        backtrace (warmUp, 2);
+       #endif
+        Detail::enabled = true;
+    }
+
+    inline void disable() noexcept                  { Detail::enabled = false; }
+    inline void clear() noexcept                    { Detail::numReported = 0; }
+    inline int getNumViolations() noexcept          { return Detail::numReported.load(); }
+
+    /** Every recorded violation with its stack. Call once the audio thread has stopped. */
+    inline juce::String getReport()
+    {
+        const int numReported = getNumViolations();
+        juce::String text;
+
+        for (int i = 0; i < juce::jmin (numReported, maxRecords); ++i)
+        {
+            const auto& record = Detail::records[(size_t) i];
+            text << "#" << (i + 1) << " " << getViolationName (record.kind);
+            if (record.bytes > 0)
+                text << " (" << (juce::int64) record.bytes << " bytes)";
+            text << juce::newLine;
+
+           #if JUCE_LINUX || JUCE_MAC
+            if (auto** symbols = backtrace_symbols (record.frames.data(), record.numFrames))
+            {
+                for (int frame = 1; frame < record.numFrames; ++frame) // Frame 0 is report() itself
+                    text << "    " << symbols[frame] << juce::newLine;
+                ::free (symbols);
+            }
+           #endif
+        }
+
+        if (numReported > maxRecords)
+            text << (numReported - maxRecords) << " more not recorded" << juce::newLine;
+
+        return text;
+    }
+}
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+//==============================================================================
+/**
+    Passive Bass/Mid/Treble tone stack modelled as one third-order IIR section.
+
+    The analog transfer function is the classic passive network analysed by
+    Yeh & Smith, here with Rectifier-style component values. Because the
+    network's coefficients depend on all three pots at once, the knobs interact
+    the way they do on the real amp instead of acting as independent bands.
+
+    The bilinear-transformed coefficients are tabulated over a grid of knob
+    positions when the sample rate is known, so a block only needs a trilinear
+    lookup instead of a filter redesign.
+*/
+namespace RectifierToneStack
+{
+    /** Normalised third-order coefficients (a0 is implicitly 1). */
+    struct Coefficients
+    {
+        double b0 = 1.0, b1 = 0.0, b2 = 0.0, b3 = 0.0;
+        double a1 = 0.0, a2 = 0.0, a3 = 0.0;
+    };
+
+    //==============================================================================
+    /** Component values of the passive network. */
+    struct Components
+    {
+        double r1 = 250.0e3; // Treble pot
+        double r2 = 250.0e3; // Bass pot
+        double r3 = 25.0e3;  // Mid pot
+        double r4 = 47.0e3;  // Slope resistor
+        double c1 = 500.0e-12;
+        double c2 = 22.0e-9;
+        double c3 = 22.0e-9;
+    };
+
+    /** Designs the digital filter for one set of knob positions (all 0..1). */
+    inline Coefficients design (const Components& k, double sampleRate,
+                                float bass, float mid, float treble, double makeupGain = 1.0)
+    {
+        const double R1 = k.r1, R2 = k.r2, R3 = k.r3, R4 = k.r4;
+        const double C1 = k.c1, C2 = k.c2, C3 = k.c3;
+
+        // The bass pot is log taper, mid and treble are linear
+        const double l = std::exp ((juce::jlimit (0.0f, 1.0f, bass) - 1.0) * 3.4);
+        const double m = juce::jlimit (0.0f, 1.0f, mid);
+        const double t = juce::jlimit (0.0f, 1.0f, treble);
+
+        // Analog H(s) = (b1 s + b2 s^2 + b3 s^3) / (1 + a1 s + a2 s^2 + a3 s^3)
+        const double b1 = t * C1 * R1 + m * C3 * R3 + l * (C1 * R2 + C2 * R2) + (C1 * R3 + C2 * R3);
+
+        const double b2 = t * (C1 * C2 * R1 * R4 + C1 * C3 * R1 * R4)
+                        - m * m * (C1 * C3 * R3 * R3 + C2 * C3 * R3 * R3)
+                        + m * (C1 * C3 * R1 * R3 + C1 * C3 * R3 * R3 + C2 * C3 * R3 * R3)
+                        + l * (C1 * C2 * R1 * R2 + C1 * C2 * R2 * R4 + C1 * C3 * R2 * R4)
+                        + l * m * (C1 * C3 * R2 * R3 + C2 * C3 * R2 * R3)
+                        + (C1 * C2 * R1 * R3 + C1 * C2 * R3 * R4 + C1 * C3 * R3 * R4);
+
+        const double b3 = l * m * (C1 * C2 * C3 * R1 * R2 * R3 + C1 * C2 * C3 * R2 * R3 * R4)
+                        - m * m * (C1 * C2 * C3 * R1 * R3 * R3 + C1 * C2 * C3 * R3 * R3 * R4)
+                        + m * (C1 * C2 * C3 * R1 * R3 * R3 + C1 * C2 * C3 * R3 * R3 * R4)
+                        + t * C1 * C2 * C3 * R1 * R3 * R4
+                        - t * m * C1 * C2 * C3 * R1 * R3 * R4
+                        + t * l * C1 * C2 * C3 * R1 * R2 * R4;
+
+        const double a1 = (C1 * R1 + C1 * R3 + C2 * R3 + C2 * R4 + C3 * R4) + m * C3 * R3 + l * (C1 * R2 + C2 * R2);
+
+        const double a2 = m * (C1 * C3 * R1 * R3 - C2 * C3 * R3 * R4 + C1 * C3 * R3 * R3 + C2 * C3 * R3 * R3)
+                        + l * m * (C1 * C3 * R2 * R3 + C2 * C3 * R2 * R3)
+                        - m * m * (C1 * C3 * R3 * R3 + C2 * C3 * R3 * R3)
+                        + l * (C1 * C2 * R2 * R4 + C1 * C2 * R1 * R2 + C1 * C3 * R2 * R4 + C2 * C3 * R2 * R4)
+                        + (C1 * C2 * R1 * R4 + C1 * C3 * R1 * R4 + C1 * C2 * R3 * R4
+                           + C1 * C2 * R1 * R3 + C1 * C3 * R3 * R4 + C2 * C3 * R3 * R4);
+
+        const double a3 = l * m * (C1 * C2 * C3 * R1 * R2 * R3 + C1 * C2 * C3 * R2 * R3 * R4)
+                        - m * m * (C1 * C2 * C3 * R1 * R3 * R3 + C1 * C2 * C3 * R3 * R3 * R4)
+                        + m * (C1 * C2 * C3 * R3 * R3 * R4 + C1 * C2 * C3 * R1 * R3 * R3 - C1 * C2 * C3 * R1 * R3 * R4)
+                        + l * C1 * C2 * C3 * R1 * R2 * R4
+                        + C1 * C2 * C3 * R1 * R3 * R4;
+
+        // Bilinear transform
+        const double c = 2.0 * sampleRate;
+        const double c2 = c * c;
+        const double c3 = c2 * c;
+
+        const double B0 = -b1 * c - b2 * c2 - b3 * c3;
+        const double B1 = -b1 * c + b2 * c2 + 3.0 * b3 * c3;
+        const double B2 =  b1 * c + b2 * c2 - 3.0 * b3 * c3;
+        const double B3 =  b1 * c - b2 * c2 + b3 * c3;
+
+        const double A0 = -1.0 - a1 * c - a2 * c2 - a3 * c3;
+        const double A1 = -3.0 - a1 * c + a2 * c2 + 3.0 * a3 * c3;
+        const double A2 = -3.0 + a1 * c + a2 * c2 - 3.0 * a3 * c3;
+        const double A3 = -1.0 + a1 * c - a2 * c2 + a3 * c3;
+
+        Coefficients out;
+        out.b0 = makeupGain * B0 / A0;
+        out.b1 = makeupGain * B1 / A0;
+        out.b2 = makeupGain * B2 / A0;
+        out.b3 = makeupGain * B3 / A0;
+        out.a1 = A1 / A0;
+        out.a2 = A2 / A0;
+        out.a3 = A3 / A0;
+        return out;
+    }
+
+    /** Magnitude of a digital design at the given frequency. */
+    inline double getMagnitude (const Coefficients& c, double frequency, double sampleRate)
+    {
+        const auto w = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+        const auto z1 = std::polar (1.0, -w);
+        const auto z2 = z1 * z1;
+        const auto z3 = z2 * z1;
+
+        const auto num = c.b0 + c.b1 * z1 + c.b2 * z2 + c.b3 * z3;
+        const auto den = 1.0 + c.a1 * z1 + c.a2 * z2 + c.a3 * z3;
+        return std::abs (num / den);
+    }
+
+    //==============================================================================
+    /**
+        Precomputed grid of coefficients over (bass, mid, treble).
+
+        Build once per sample rate (off the audio thread's hot path), then call
+        lookup() per block. The network is passive and loses around 8 dB with the
+        knobs at noon, so a makeup gain is folded into every entry to keep the
+        level comparable with the classic biquad tone stack.
+    */
+    class CoefficientTable
+    {
+    public:
+        static constexpr int gridSize = 11; // 0.1 knob steps
+
+        void build (double newSampleRate, const Components& components = {})
+        {
+            sampleRate = newSampleRate;
+
+            const auto noon = design (components, sampleRate, 0.5f, 0.5f, 0.5f);
+            const auto makeupGain = 1.0 / juce::jmax (1.0e-6, getMagnitude (noon, 1000.0, sampleRate));
+
+            table.resize ((size_t) (gridSize * gridSize * gridSize));
+
+            for (int b = 0; b < gridSize; ++b)
+                for (int m = 0; m < gridSize; ++m)
+                    for (int t = 0; t < gridSize; ++t)
+                        table[index (b, m, t)] = design (components, sampleRate,
+                                                         (float) b / (gridSize - 1),
+                                                         (float) m / (gridSize - 1),
+                                                         (float) t / (gridSize - 1),
+                                                         makeupGain);
+        }
+
+        bool isReady() const noexcept                  { return ! table.empty(); }
+        double getSampleRate() const noexcept          { return sampleRate; }
+        size_t getSizeInBytes() const noexcept         { return table.size() * sizeof (Coefficients); }
+
+        /** Trilinear interpolation between the eight surrounding grid points. */
+        Coefficients lookup (float bass, float mid, float treble) const noexcept
+        {
+            jassert (isReady());
+
+            int bi, mi, ti;
+            float bf, mf, tf;
+            split (bass, bi, bf);
+            split (mid, mi, mf);
+            split (treble, ti, tf);
+
+            Coefficients out { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+
+            for (int corner = 0; corner < 8; ++corner)
+            {
+                const int db = (corner >> 2) & 1;
+                const int dm = (corner >> 1) & 1;
+                const int dt = corner & 1;
+
+                const double w = (db ? bf : 1.0f - bf) * (dm ? mf : 1.0f - mf) * (dt ? tf : 1.0f - tf);
+                if (w == 0.0)
+                    continue;
+
+                const auto& c = table[index (bi + db, mi + dm, ti + dt)];
+                out.b0 += w * c.b0;
+                out.b1 += w * c.b1;
+                out.b2 += w * c.b2;
+                out.b3 += w * c.b3;
+                out.a1 += w * c.a1;
+                out.a2 += w * c.a2;
+                out.a3 += w * c.a3;
+            }
+
+            return out;
+        }
+
+    private:
+        static size_t index (int b, int m, int t) noexcept
+        {
+            return (size_t) ((b * gridSize + m) * gridSize + t);
+        }
+
+        static void split (float knob, int& cell, float& fraction) noexcept
+        {
+            const float pos = juce::jlimit (0.0f, 1.0f, knob) * (gridSize - 1);
+            cell = juce::jmin ((int) pos, gridSize - 2);
+            fraction = pos - (float) cell;
+        }
+
+        std::vector<Coefficients> table;
+        double sampleRate = 0.0;
+    };
+
+    //==============================================================================
+    /** Third-order transposed direct form II section, processed in double precision. */
+    class Filter
+    {
+    public:
+        void setCoefficients (const Coefficients& newCoefficients) noexcept { coeffs = newCoefficients; }
+
+        void reset() noexcept { s1 = s2 = s3 = 0.0; }
+
+        inline float processSample (float input) noexcept
+        {
+            const double x = input;
+            const double y = coeffs.b0 * x + s1;
+            s1 = coeffs.b1 * x - coeffs.a1 * y + s2;
+            s2 = coeffs.b2 * x - coeffs.a2 * y + s3;
+            s3 = coeffs.b3 * x - coeffs.a3 * y;
+            return (float) y;
+        }
+
+        void process (float* data, int numSamples) noexcept
+        {
+            for (int i = 0; i < numSamples; ++i)
+                data[i] = processSample (data[i]);
+
+            // Flush denormal tails once per block rather than per sample
+            if (std::abs (s1) < 1.0e-15) s1 = 0.0;
+            if (std::abs (s2) < 1.0e-15) s2 = 0.0;
+            if (std::abs (s3) < 1.0e-15) s3 = 0.0;
+        }
+
+    private:
+        Coefficients coeffs;
+        double s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    };
+}
@@ -0,0 +1,321 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+//==============================================================================
+/**
+    Capture and cabinet controls in the panel's title zone: choose or clear a
+    neural amp capture, choose or clear the cabinet IR or a blend of up to
+    three mics (with a level for each), the load-time clean-up and what it
+    changed, exact convolution or a fitted biquad approximation with its fit
+    error, merging the linear stages into one convolution (off unless
+    switched on), and the outcome of the latest load of each (progress, time
+    taken, or why it failed). Polls the processor at 4 Hz, so a session
+    recall or a load that finishes in the background shows up without any
+    callbacks.
+*/
+class RigPanel : public juce::Component,
+                 private juce::Timer
+{
+public:
+    explicit RigPanel (GainForgeAudioProcessor& p) : processor (p)
+    {
+        addAndMakeVisible (loadCaptureButton);
+        loadCaptureButton.onClick = [this] { chooseCapture(); };
+
+        addAndMakeVisible (clearCaptureButton);
+        clearCaptureButton.onClick = [this] { processor.clearAmpModel(); };
+
+        addAndMakeVisible (loadCabinetButton);
+        loadCabinetButton.onClick = [this] { chooseCabinet(); };
+
+        addAndMakeVisible (blendButton);
+        blendButton.onClick = [this] { chooseBlend(); };
+
+        addAndMakeVisible (clearCabinetButton);
+        clearCabinetButton.onClick = [this] { processor.clearCabinetIR(); };
+
+        // Levels only take effect on release: every change re-mixes the composite IR
+        for (auto& slider : micLevels)
+        {
+            slider.setSliderStyle (juce::Slider::LinearHorizontal);
+            slider.setTextBoxStyle (juce::Slider::TextBoxRight, false, 44, rowHeight);
+            slider.setRange (-24.0, 12.0, 0.5);
+            slider.setTextValueSuffix (" dB");
+            slider.onDragEnd = [this] { applyMicLevels(); };
+            addAndMakeVisible (slider);
+        }
+
+        // Clean-up: each change reloads the cabinet with the new options
+        for (auto* toggle : { &minimumPhaseToggle, &trimToggle })
+        {
+            toggle->onClick = [this] { applyPreprocessing (false); };
+            addAndMakeVisible (*toggle);
+        }
+
+        tailBox.addItemList ({ "Full tail", "Tail -40 dB", "Tail -60 dB", "Tail -80 dB" }, 1);
+        tailBox.onChange = [this] { applyPreprocessing (true); };
+        addAndMakeVisible (tailBox);
+
+        // Exact convolution, or the fitted biquads for live rigs
+        approximationBox.addItem ("Exact convolution", 1);
+        for (auto sections : approximationSections)
+            approximationBox.addItem (juce::String (sections) + " biquads", sections);
+        approximationBox.onChange = [this] { applyApproximation(); };
+        addAndMakeVisible (approximationBox);
+
+        mergeToggle.onClick = [this] { processor.setLinearStageMerging (mergeToggle.getToggleState()); };
+        addAndMakeVisible (mergeToggle);
+
+        refresh();
+        startTimerHz (4);
+    }
+
+    void paint (juce::Graphics& g) override
+    {
+        g.setColour (juce::Colours::black.withAlpha (0.6f));
+        g.fillRoundedRectangle (getLocalBounds().toFloat(), 6.0f);
+
+        g.setColour (juce::Colours::white);
+        g.setFont (juce::Font (12.0f, juce::Font::bold));
+        g.drawText ("CAPTURE", captureLabelArea, juce::Justification::centredLeft, false);
+        g.drawText ("CABINET", cabinetLabelArea, juce::Justification::centredLeft, false);
+        g.drawText ("MICS", micLabelArea, juce::Justification::centredLeft, false);
+        g.drawText ("CLEAN-UP", preprocessingLabelArea, juce::Justification::centredLeft, false);
+        g.drawText ("ENGINE", engineLabelArea, juce::Justification::centredLeft, false);
+
+        g.setFont (11.0f);
+        drawStatus (g, captureStatusArea, captureName, captureStatus);
+        drawStatus (g, cabinetStatusArea, cabinetName, cabinetStatus);
+
+        g.setColour (juce::Colours::lightgrey);
+        g.drawFittedText (cabinetReport, reportArea, juce::Justification::centredLeft, 1);
+        g.drawFittedText (fitReport, fitReportArea, juce::Justification::centredLeft, 1);
+    }
+
+    int getIdealHeight() const noexcept     { return numRows * rowHeight + 12; }
+
+    void resized() override
+    {
+        auto area = getLocalBounds().reduced (8, 6);
+
+        auto captureRow = area.removeFromTop (rowHeight);
+        captureLabelArea = captureRow.removeFromLeft (labelWidth);
+        loadCaptureButton.setBounds (captureRow.removeFromLeft (56));
+        captureRow.removeFromLeft (4);
+        clearCaptureButton.setBounds (captureRow.removeFromLeft (48));
+        captureStatusArea = captureRow.withTrimmedLeft (8);
+
+        auto cabinetRow = area.removeFromTop (rowHeight);
+        cabinetLabelArea = cabinetRow.removeFromLeft (labelWidth);
+        loadCabinetButton.setBounds (cabinetRow.removeFromLeft (56));
+        cabinetRow.removeFromLeft (4);
+        blendButton.setBounds (cabinetRow.removeFromLeft (56));
+        cabinetRow.removeFromLeft (4);
+        clearCabinetButton.setBounds (cabinetRow.removeFromLeft (48));
+        cabinetStatusArea = area.removeFromTop (rowHeight);
+
+        auto micRow = area.removeFromTop (rowHeight);
+        micLabelArea = micRow.removeFromLeft (labelWidth);
+        const int micWidth = micRow.getWidth() / Cabinet::maxMics;
+        for (auto& slider : micLevels)
+            slider.setBounds (micRow.removeFromLeft (micWidth).withTrimmedRight (4));
+
+        auto preprocessingRow = area.removeFromTop (rowHeight);
+        preprocessingLabelArea = preprocessingRow.removeFromLeft (labelWidth);
+        minimumPhaseToggle.setBounds (preprocessingRow.removeFromLeft (96));
+        trimToggle.setBounds (preprocessingRow.removeFromLeft (96));
+        tailBox.setBounds (preprocessingRow.removeFromLeft (104));
+        reportArea = area.removeFromTop (rowHeight);
+
+        auto engineRow = area.removeFromTop (rowHeight);
+        engineLabelArea = engineRow.removeFromLeft (labelWidth);
+        approximationBox.setBounds (engineRow.removeFromLeft (150));
+        engineRow.removeFromLeft (8);
+        mergeToggle.setBounds (engineRow.removeFromLeft (150));
+        fitReportArea = area.removeFromTop (rowHeight);
+    }
+
+private:
+    static constexpr int rowHeight = 20;
+    static constexpr int numRows = 8;
+    static constexpr int approximationSections[] = { 8, 12, 16 };  // Item IDs too (1 = exact)
+    static constexpr float tailThresholds[] = { 0.0f, -40.0f, -60.0f, -80.0f }; // tailBox items, in order
+    static constexpr int labelWidth = 70;
+
+    void timerCallback() override
+    {
+        refresh();
+    }
+
+    void refresh()
+    {
+        captureName = processor.getAmpModelName();
+        captureStatus = processor.getAmpModelStatus();
+        clearCaptureButton.setEnabled (captureName.isNotEmpty());
+
+        cabinetName = processor.getCabinetName();
+        cabinetStatus = processor.getCabinetStatus();
+        clearCabinetButton.setEnabled (cabinetName.isNotEmpty());
+        cabinetReport = processor.getCabinetReport();
+
+        const auto options = processor.getCabinetPreprocessing();
+        minimumPhaseToggle.setToggleState (options.minimumPhase, juce::dontSendNotification);
+        trimToggle.setToggleState (options.trimLeadingSilence, juce::dontSendNotification);
+        tailBox.setSelectedItemIndex (getTailIndex (options.tailThresholdDb), juce::dontSendNotification);
+
+        // Only a loaded cabinet has a fit to report
+        const auto sections = processor.getCabinetApproximation();
+        if (approximationBox.indexOfItemId (sections > 0 ? sections : 1) >= 0)
+            approximationBox.setSelectedId (sections > 0 ? sections : 1, juce::dontSendNotification);
+        else
+            approximationBox.setText (juce::String (sections) + " biquads", juce::dontSendNotification); // Set through the API
+
+        // Merging needs the exact convolution; the choice is kept while an approximation runs
+        mergeToggle.setToggleState (processor.isLinearStageMergingEnabled(), juce::dontSendNotification);
+        mergeToggle.setEnabled (sections == 0);
+
+        fitReport = cabinetName.isNotEmpty() ? processor.getCabinetFitReport().toString() : juce::String();
+
+        // Follows recalls and new blends, but never fights a slider being dragged
+        const auto blend = processor.getCabinetBlend();
+        for (int i = 0; i < Cabinet::maxMics; ++i)
+        {
+            auto& slider = micLevels[(size_t) i];
+            const bool present = i < (int) blend.size();
+            slider.setEnabled (present);
+
+            if (present && ! slider.isMouseButtonDown())
+                slider.setValue (blend[(size_t) i].gainDecibels, juce::dontSendNotification);
+        }
+
+        repaint();
+    }
+
+    /** Name and status on one line (just the status while the first load runs); failures in red. */
+    static void drawStatus (juce::Graphics& g, juce::Rectangle<int> area, const juce::String& name,
+                            const GainForgeAudioProcessor::LoadStatus& status)
+    {
+        auto text = status.message;
+
+        if (! status.failed && name.isNotEmpty())
+            text = status.message.isNotEmpty() ? name + " - " + status.message : name;
+        else if (text.isEmpty())
+            text = "None";
+
+        g.setColour (status.failed ? juce::Colours::orangered : juce::Colours::lightgrey);
+        g.drawFittedText (text, area, juce::Justification::centredLeft, 1);
+    }
+
+    void chooseCapture()
+    {
+        chooser = std::make_unique<juce::FileChooser> ("Load amp capture", juce::File(), "*.json");
+        chooser->launchAsync (juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                              [this] (const juce::FileChooser& fc)
+                              {
+                                  if (fc.getResult() != juce::File())
+                                      processor.loadAmpModel (fc.getResult());
+                              });
+    }
+
+    void chooseCabinet()
+    {
+        chooser = std::make_unique<juce::FileChooser> ("Load cabinet IR", juce::File(), "*.wav;*.aif;*.aiff;*.flac;*.gfir");
+        chooser->launchAsync (juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                              [this] (const juce::FileChooser& fc)
+                              {
+                                  if (fc.getResult() != juce::File())
+                                      processor.loadCabinetIR (fc.getResult());
+                              });
+    }
+
+    void chooseBlend()
+    {
+        chooser = std::make_unique<juce::FileChooser> ("Blend up to " + juce::String (Cabinet::maxMics) + " mic IRs",
+                                                       juce::File(), "*.wav;*.aif;*.aiff;*.flac");
+        chooser->launchAsync (juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles
+                                | juce::FileBrowserComponent::canSelectMultipleItems,
+                              [this] (const juce::FileChooser& fc)
+                              {
+                                  // New mics start level and aligned; the levels row adjusts them
+                                  std::vector<Cabinet::MicSource> mics;
+                                  for (auto& file : fc.getResults())
+                                      if ((int) mics.size() < Cabinet::maxMics)
+                                          mics.push_back ({ file, 0.0f, 0.0f });
+
+                                  if (! mics.empty())
+                                      processor.loadCabinetBlend (mics);
+                              });
+    }
+
+    static int getTailIndex (float thresholdDb) noexcept
+    {
+        // Nearest listed threshold, so a session saved with another value still shows something sensible
+        int nearest = 0;
+        for (int i = 1; i < (int) std::size (tailThresholds); ++i)
+            if (std::abs (tailThresholds[i] - thresholdDb) < std::abs (tailThresholds[nearest] - thresholdDb))
+                nearest = i;
+
+        return nearest;
+    }
+
+    /** A threshold the list doesn't have is only replaced when the list itself was changed. */
+    void applyPreprocessing (bool tailChanged)
+    {
+        auto options = processor.getCabinetPreprocessing();
+        options.minimumPhase = minimumPhaseToggle.getToggleState();
+        options.trimLeadingSilence = trimToggle.getToggleState();
+
+        if (tailChanged)
+            options.tailThresholdDb = tailThresholds[juce::jmax (0, tailBox.getSelectedItemIndex())];
+
+        processor.setCabinetPreprocessing (options);
+    }
+
+    void applyApproximation()
+    {
+        const int id = approximationBox.getSelectedId();
+        const int sections = id > 1 ? id : 0;
+
+        if (sections != processor.getCabinetApproximation())
+            processor.setCabinetApproximation (sections);
+    }
+
+    void applyMicLevels()
+    {
+        auto mics = processor.getCabinetBlend();
+        bool changed = false;
+
+        for (size_t i = 0; i < mics.size(); ++i)
+        {
+            const auto level = (float) micLevels[i].getValue();
+            changed = changed || level != mics[i].gainDecibels;
+            mics[i].gainDecibels = level;
+        }
+
+        if (changed)
+            processor.loadCabinetBlend (mics);
+    }
+
+    GainForgeAudioProcessor& processor;
+    std::unique_ptr<juce::FileChooser> chooser;
+
+    juce::TextButton loadCaptureButton { "Load..." }, clearCaptureButton { "Clear" };
+    juce::Rectangle<int> captureLabelArea, captureStatusArea;
+    juce::String captureName;
+    GainForgeAudioProcessor::LoadStatus captureStatus;
+
+    juce::TextButton loadCabinetButton { "Load..." }, blendButton { "Blend..." }, clearCabinetButton { "Clear" };
+    std::array<juce::Slider, Cabinet::maxMics> micLevels;
+    juce::ToggleButton minimumPhaseToggle { "Min phase" }, trimToggle { "Trim start" };
+    juce::ToggleButton mergeToggle { "Merge tone + cab" };
+    juce::ComboBox tailBox, approximationBox;
+    juce::Rectangle<int> cabinetLabelArea, cabinetStatusArea, micLabelArea, preprocessingLabelArea, reportArea;
+    juce::Rectangle<int> engineLabelArea, fitReportArea;
+    juce::String cabinetReport, fitReport;
+    juce::String cabinetName;
+    GainForgeAudioProcessor::LoadStatus cabinetStatus;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RigPanel)
+};
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <map>
+#include <memory>
+
+//==============================================================================
+/**
+    Process-wide cache of immutable DSP data (tables, filter designs, IRs...).
+
+    Hold it through juce::SharedResourcePointer so every plugin instance in
+    the process sees the same cache. Entries are keyed by content and sample
+    rate and only weakly referenced: instances share one copy for as long as
+    any of them holds it, and the memory goes away with the last holder.
+
+    The lock only guards the table, so builds run outside it and a slow IR
+    partitioning doesn't hold up lookups of other keys. Concurrent lookups of
+    a key that is being built wait for that one build instead of repeating it.
+    Lookups may block or build, so never call this from the audio thread -
+    use it from the async preparation jobs.
+*/
+class SharedDspResourceCache
+{
+public:
+    /** Builds a key from a resource kind, sample rate and optional content id (e.g. a hash). */
+    static juce::String makeKey (const juce::String& kind, double sampleRate, const juce::String& contentId = {})
+    {
+        return kind + "@" + juce::String (sampleRate, 1) + (contentId.isNotEmpty() ? "/" + contentId : juce::String());
+    }
+
+    /**
+        Returns the shared object for key, calling builder() only if no live
+        copy exists. T must provide getSizeInBytes() for the memory report.
+
+        builder() runs without the lock held. Other threads asking for the same
+        key meanwhile wait for its result; if it returns nullptr or throws, the
+        in-flight marker is cleared and signalled all the same, and one of them
+        tries again with its own builder (the exception goes to this caller).
+    */
+    template <typename T, typename Builder>
+    std::shared_ptr<const T> getOrBuild (const juce::String& key, Builder&& builder)
+    {
+        std::shared_ptr<juce::WaitableEvent> inFlight;
+
+        for (;;)
+        {
+            {
+                const juce::ScopedLock sl (lock);
+                auto& entry = entries[key];
+
+                if (auto existing = entry.object.lock())
+                {
+                    ++entry.hits;
+                    ++totalHits;
+                    return std::static_pointer_cast<const T> (existing);
+                }
+
+                if (entry.building == nullptr)
+                {
+                    // This thread builds; later lookups wait on the marker
+                    entry.building = inFlight = std::make_shared<juce::WaitableEvent> (true);
+                    break;
+                }
+
+                inFlight = entry.building;
+            }
+
+            inFlight->wait (-1);
+        }
+
+        // Whatever happens to the build, the marker must not outlive it or the waiters hang
+        struct BuildFinisher
+        {
+            ~BuildFinisher()
+            {
+                {
+                    const juce::ScopedLock sl (cache.lock);
+                    auto& entry = cache.entries[key];
+                    entry.object = built;
+                    entry.sizeInBytes = sizeInBytes;
+                    entry.building.reset();
+                    ++entry.builds;
+                }
+
+                marker.signal();
+            }
+
+            SharedDspResourceCache& cache;
+            const juce::String& key;
+            juce::WaitableEvent& marker;
+            std::shared_ptr<const void> built;
+            size_t sizeInBytes = 0;
+        };
+
+        BuildFinisher finisher { *this, key, *inFlight, {}, 0 };
+        std::shared_ptr<const T> built = builder();
+
+        finisher.built = built;
+        finisher.sizeInBytes = built != nullptr ? (size_t) built->getSizeInBytes() : 0;
+        return built;
+    }
+
+    /**
+        Content id (64-bit FNV-1a hash plus size) of a file, for keys of resources built from files.
+        Remembered by path, size and modification time, so asking again for an
+        unchanged file doesn't read it.
+    */
+    juce::String getFileContentId (const juce::File& file)
+    {
+        const auto path = file.getFullPathName();
+        const auto size = file.getSize();
+        const auto modified = file.getLastModificationTime().toMilliseconds();
+
+        {
+            const juce::ScopedLock sl (lock);
+            auto known = fileIds.find (path);
+            if (known != fileIds.end() && known->second.size == size && known->second.modified == modified)
+                return known->second.id;
+        }
+
+        // Hash outside the lock; at worst two threads hash the same file once
+        auto id = hashFileContents (file);
+
+        const juce::ScopedLock sl (lock);
+        fileIds[path] = { size, modified, id };
+        return id;
+    }
+
+    static juce::String hashFileContents (const juce::File& file)
+    {
+        juce::FileInputStream in (file);
+        if (! in.openedOk())
+            return {};
+
+        juce::uint64 hash = 14695981039346656037ull;
+        juce::HeapBlock<juce::uint8> chunk (65536);
+
+        for (int bytesRead; (bytesRead = in.read (chunk, 65536)) > 0;)
+            for (int i = 0; i < bytesRead; ++i)
+                hash = (hash ^ chunk[i]) * 1099511628211ull;
+
+        return juce::String::toHexString ((juce::int64) hash) + "-" + juce::String (file.getSize());
+    }
+
+    //==============================================================================
+    struct Usage
+    {
+        int numLiveEntries = 0;
+        size_t sharedBytes = 0;     // One copy of every live entry
+        size_t unsharedBytes = 0;   // What the same holders would use without sharing
+        int hits = 0;               // Lookups served from the cache since the process started
+
+        size_t getBytesSaved() const noexcept { return unsharedBytes - sharedBytes; }
+    };
+
+    Usage getUsage()
+    {
+        const juce::ScopedLock sl (lock);
+        purgeExpired();
+
+        Usage usage;
+        usage.hits = totalHits;
+        for (auto& [key, entry] : entries)
+        {
+            if (entry.object.expired()) // Still being built
+                continue;
+
+            const auto holders = (size_t) entry.object.use_count();
+            ++usage.numLiveEntries;
+            usage.sharedBytes += entry.sizeInBytes;
+            usage.unsharedBytes += entry.sizeInBytes * holders;
+        }
+
+        return usage;
+    }
+
+    /**
+        Human-readable report of the shared footprint, divided across numInstances,
+        and what the same set of resources comes to at other instance counts.
+    */
+    juce::String createMemoryReport (int numInstances, size_t privateBytesPerInstance)
+    {
+        const juce::ScopedLock sl (lock);
+        purgeExpired();
+
+        juce::String report;
+        size_t sharedBytes = 0, unsharedBytes = 0;
+
+        for (auto& [key, entry] : entries)
+        {
+            if (entry.object.expired())
+                continue;
+
+            const auto holders = (size_t) entry.object.use_count();
+            report << key << ": " << (int) entry.sizeInBytes << " bytes, "
+                   << (int) holders << " holders, "
+                   << (int) entry.builds << " builds, " << (int) entry.hits << " hits" << juce::newLine;
+            sharedBytes += entry.sizeInBytes;
+            unsharedBytes += entry.sizeInBytes * holders;
+        }
+
+        report << "Cache hits: " << totalHits
+               << ", bytes saved by sharing: " << (juce::int64) (unsharedBytes - sharedBytes) << juce::newLine;
+
+        const auto instances = (size_t) juce::jmax (1, numInstances);
+        report << "Instances: " << numInstances
+               << ", shared: " << (int) sharedBytes << " bytes"
+               << ", per instance: " << (int) (privateBytesPerInstance + sharedBytes / instances) << " bytes"
+               << " (" << (int) privateBytesPerInstance << " private + "
+               << (int) (sharedBytes / instances) << " shared)" << juce::newLine;
+
+        // Every instance holding the same resources: one shared copy, against one copy each
+        const auto unsharedPerInstance = unsharedBytes / instances;
+        for (size_t count : { (size_t) 1, (size_t) 8, (size_t) 32, (size_t) 128 })
+            report << "At " << (int) count << " instances: " << (juce::int64) (count * privateBytesPerInstance + sharedBytes)
+                   << " bytes total, " << (juce::int64) (count * (privateBytesPerInstance + unsharedPerInstance))
+                   << " without sharing" << juce::newLine;
+
+        return report;
+    }
+
+private:
+    struct Entry
+    {
+        std::weak_ptr<const void> object;
+        std::shared_ptr<juce::WaitableEvent> building;  // Set while a thread builds this key
+        size_t sizeInBytes = 0;
+        int builds = 0;
+        int hits = 0;
+    };
+
+    void purgeExpired()
+    {
+        for (auto it = entries.begin(); it != entries.end();)
+            it = it->second.object.expired() && it->second.building == nullptr ? entries.erase (it) : std::next (it);
+    }
+
+    struct FileId
+    {
+        juce::int64 size = 0;
+        juce::int64 modified = 0;
+        juce::String id;
+    };
+
+    juce::CriticalSection lock;
+    std::map<juce::String, Entry> entries;
+    std::map<juce::String, FileId> fileIds;
+    int totalHits = 0;
+};
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+#if GAINFORGE_ENABLE_PROFILING && JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+//==============================================================================
+/**
+    Per-stage timing of the amp chain, for telling which stage makes an
+    instance heavy.
+
+    Built with GAINFORGE_ENABLE_PROFILING=1, the emulators time each stage
+    with the time-stamp counter (steady-clock ticks where there is none),
+    once per stage per block. Every emulator that runs a chunk (each channel,
+    and both banks during a crossfade) adds to one BlockProfile, which goes
+    to the instance's Accumulator as a single block: lock-free, so the audio
+    thread and the offline pipeline worker can both write. The message thread
+    reads min/mean/p99 per stage in ns per base-rate sample of the instance,
+    so mean x sample rate is the instance's share of a core.
+
+    Without the flag BlockProfile is empty and its calls compile to nothing.
+*/
+namespace StageProfiler
+{
+    enum Stage
+    {
+        oversampling,
+        preamp,
+        rectifier,
+        voiceMode,
+        toneStack,
+        cabinet,    // Also the merged linear stage while it runs
+        master,
+        numStages
+    };
+
+    inline const char* getStageName (int stage) noexcept
+    {
+        static const char* const names[numStages] =
+            { "Oversampling", "Preamp", "Rectifier", "Voice/Mode", "Tone stack", "Cabinet", "Master" };
+
+        return juce::isPositiveAndBelow (stage, (int) numStages) ? names[stage] : "";
+    }
+
+    inline juce::uint64 readTimestamp() noexcept
+    {
+       #if GAINFORGE_ENABLE_PROFILING && JUCE_INTEL
+        return (juce::uint64) __rdtsc();
+       #else
+        return (juce::uint64) juce::Time::getHighResolutionTicks();
+       #endif
+    }
+
+    /** readTimestamp() units per second; the first call calibrates for 20 ms (message thread). */
+    inline double getTimestampsPerSecond()
+    {
+       #if GAINFORGE_ENABLE_PROFILING && JUCE_INTEL
+        static const double rate = []
+        {
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+            const auto startStamp = readTimestamp();
+            juce::Thread::sleep (20);
+            const auto stamps = (double) (readTimestamp() - startStamp);
+            return stamps / juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+        }();
+        return rate;
+       #else
+        return (double) juce::Time::getHighResolutionTicksPerSecond();
+       #endif
+    }
+
+    /** One stage's cost, in ns per sample over the blocks since the last reset. */
+    struct Stats
+    {
+        double minimum = 0.0;
+        double mean = 0.0;
+        double p99 = 0.0;
+        juce::int64 blocks = 0;
+    };
+
+    //==============================================================================
+    class Accumulator
+    {
+    public:
+        Accumulator()   { reset(); }
+
+        /** Any processing thread. */
+        void add (int stage, juce::uint64 timestamps, int numSamples) noexcept
+        {
+            auto& data = stages[(size_t) stage];
+            const float perSample = (float) timestamps / (float) numSamples;
+
+            data.totalTimestamps.fetch_add (timestamps, std::memory_order_relaxed);
+            data.totalSamples.fetch_add ((juce::uint64) numSamples, std::memory_order_relaxed);
+            data.histogram[(size_t) getBucket (perSample)].fetch_add (1, std::memory_order_relaxed);
+
+            float minimum = data.minimum.load (std::memory_order_relaxed);
+            while (perSample < minimum && ! data.minimum.compare_exchange_weak (minimum, perSample, std::memory_order_relaxed))
+            {}
+        }
+
+        /** Message thread. */
+        Stats getStats (int stage) const
+        {
+            const auto& data = stages[(size_t) stage];
+            const double nsPerTimestamp = 1.0e9 / getTimestampsPerSecond();
+            Stats stats;
+
+            juce::uint64 counts[numBuckets], blocks = 0;
+            for (int b = 0; b < numBuckets; ++b)
+                blocks += (counts[b] = data.histogram[(size_t) b].load (std::memory_order_relaxed));
+
+            const auto samples = data.totalSamples.load (std::memory_order_relaxed);
+            if (blocks == 0 || samples == 0)
+                return stats;
+
+            stats.blocks = (juce::int64) blocks;
+            stats.minimum = data.minimum.load (std::memory_order_relaxed) * nsPerTimestamp;
+            stats.mean = (double) data.totalTimestamps.load (std::memory_order_relaxed) / (double) samples * nsPerTimestamp;
+
+            // Upper edge of the bucket holding the 99th percentile block
+            const auto target = (juce::uint64) std::ceil ((double) blocks * 0.99);
+            juce::uint64 seen = 0;
+            for (int b = 0; b < numBuckets; ++b)
+            {
+                seen += counts[b];
+                if (seen >= target)
+                {
+                    stats.p99 = std::exp2 ((double) (b + 1) / bucketsPerOctave) * nsPerTimestamp;
+                    break;
+                }
+            }
+
+            return stats;
+        }
+
+        /** Message thread; blocks being added meanwhile may land on either side. */
+        void reset() noexcept
+        {
+            for (auto& data : stages)
+            {
+                data.totalTimestamps = 0;
+                data.totalSamples = 0;
+                data.minimum = std::numeric_limits<float>::max();
+                for (auto& count : data.histogram)
+                    count = 0;
+            }
+        }
+
+    private:
+        // Log-spaced: 8 buckets per octave of timestamps per sample, up to 2^24
+        static constexpr int bucketsPerOctave = 8;
+        static constexpr int numBuckets = 24 * bucketsPerOctave;
+
+        static int getBucket (float perSample) noexcept
+        {
+            return perSample <= 1.0f ? 0 : juce::jmin (numBuckets - 1, (int) (std::log2 (perSample) * (float) bucketsPerOctave));
+        }
+
+        struct StageData
+        {
+            std::atomic<juce::uint64> totalTimestamps { 0 };
+            std::atomic<juce::uint64> totalSamples { 0 };
+            std::atomic<float> minimum { 0.0f };
+            std::array<std::atomic<juce::uint32>, numBuckets> histogram {};
+        };
+
+        std::array<StageData, numStages> stages;
+    };
+
+    //==============================================================================
+    /**
+        Splits one block's processing time between stages: start() before each
+        emulator's work, then lap (stage) after each stage charges the time
+        since the last lap to it. Laps from several emulators add up, and
+        commit() adds the total to the accumulator as one block.
+    */
+    class BlockProfile
+    {
+    public:
+       #if GAINFORGE_ENABLE_PROFILING
+        void start() noexcept                   { last = readTimestamp(); }
+
+        void lap (Stage stage) noexcept
+        {
+            const auto now = readTimestamp();
+            timestamps[(size_t) stage] += now - last;
+            last = now;
+        }
+
+        void commit (Accumulator* accumulator, int numSamples) noexcept
+        {
+            if (accumulator != nullptr && numSamples > 0)
+                for (int stage = 0; stage < numStages; ++stage)
+                    if (timestamps[(size_t) stage] > 0)
+                        accumulator->add (stage, timestamps[(size_t) stage], numSamples);
+        }
+
+    private:
+        juce::uint64 last = 0;
+        std::array<juce::uint64, numStages> timestamps {};
+       #else
+        void start() noexcept                   {}
+        void lap (Stage) noexcept               {}
+        void commit (Accumulator*, int) noexcept {}
+       #endif
+    };
+}
@@ -0,0 +1,316 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+//==============================================================================
+/**
+    Test signals, timing statistics and result files shared by the benchmark
+    tools. Signals are deterministic (fixed seeds) so runs on different
+    machines and builds process exactly the same samples.
+*/
+namespace Benchmark
+{
+    /** A named mono input, looped to whatever length a run needs. */
+    struct Signal
+    {
+        juce::String name;
+        std::vector<float> samples;
+    };
+
+    //==============================================================================
+    /** Log sine sweep 20 Hz - 20 kHz (capped below Nyquist) at -6 dBFS. */
+    inline Signal makeSweep (double sampleRate, double seconds)
+    {
+        Signal signal { "sweep", std::vector<float> ((size_t) (seconds * sampleRate)) };
+        const double f0 = 20.0, f1 = juce::jmin (20000.0, sampleRate * 0.45);
+        const double k = std::log (f1 / f0) / seconds;
+
+        for (size_t i = 0; i < signal.samples.size(); ++i)
+        {
+            const double t = (double) i / sampleRate;
+            signal.samples[i] = 0.5f * (float) std::sin (juce::MathConstants<double>::twoPi * f0 * (std::exp (k * t) - 1.0) / k);
+        }
+
+        return signal;
+    }
+
+    /** White noise at -12 dBFS RMS-ish. */
+    inline Signal makeNoise (double sampleRate, double seconds)
+    {
+        Signal signal { "noise", std::vector<float> ((size_t) (seconds * sampleRate)) };
+        juce::Random random (0x6a5e);
+
+        for (auto& s : signal.samples)
+            s = 0.25f * (random.nextFloat() * 2.0f - 1.0f);
+
+        return signal;
+    }
+
+    /** Karplus-Strong plucks every 250 ms over a low-E riff - close enough to a DI for timing. */
+    inline Signal makePlucks (double sampleRate, double seconds)
+    {
+        Signal signal { "plucks", std::vector<float> ((size_t) (seconds * sampleRate)) };
+        static constexpr double notes[] = { 82.41, 82.41, 98.0, 82.41, 110.0, 82.41, 123.47, 116.54 };
+        juce::Random random (0x91c4);
+
+        const auto noteLength = (size_t) (0.25 * sampleRate);
+        std::vector<float> line;
+        size_t position = 0;
+
+        for (size_t i = 0; i < signal.samples.size(); ++i)
+        {
+            if (i % noteLength == 0)
+            {
+                line.assign ((size_t) juce::jmax (2.0, sampleRate / notes[(i / noteLength) % std::size (notes)]), 0.0f);
+                for (auto& s : line)
+                    s = 0.4f * (random.nextFloat() * 2.0f - 1.0f);
+                position = 0;
+            }
+
+            const auto next = (position + 1) % line.size();
+            const float out = line[position];
+            line[position] = 0.996f * 0.5f * (line[position] + line[next]);
+            position = next;
+            signal.samples[i] = out;
+        }
+
+        return signal;
+    }
+
+    /** Digital silence: catches denormal slowdowns in decaying filters and feedback paths. */
+    inline Signal makeSilence (double sampleRate, double seconds)
+    {
+        return { "silence", std::vector<float> ((size_t) (seconds * sampleRate), 0.0f) };
+    }
+
+    inline std::vector<Signal> makeSyntheticSignals (double sampleRate, double seconds)
+    {
+        return { makeSweep (sampleRate, seconds), makeNoise (sampleRate, seconds),
+                 makePlucks (sampleRate, seconds), makeSilence (sampleRate, seconds) };
+    }
+
+    /**
+        Loads every audio file in a folder (first channel, at most maxSeconds).
+        Files play sample for sample at every benchmark rate - the content
+        matters for timing, not the pitch.
+    */
+    inline std::vector<Signal> loadCorpus (const juce::File& folder, double maxSeconds)
+    {
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+        std::vector<Signal> corpus;
+
+        for (const auto& entry : juce::RangedDirectoryIterator (folder, true, "*.wav;*.aif;*.aiff;*.flac", juce::File::findFiles))
+        {
+            std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor (entry.getFile()));
+            if (reader == nullptr || reader->lengthInSamples <= 0)
+                continue;
+
+            const auto length = (int) juce::jmin (reader->lengthInSamples, (juce::int64) (maxSeconds * reader->sampleRate));
+            juce::AudioBuffer<float> buffer (1, length);
+            reader->read (&buffer, 0, length, 0, true, false);
+
+            corpus.push_back ({ "di:" + entry.getFile().getFileNameWithoutExtension(),
+                                std::vector<float> (buffer.getReadPointer (0), buffer.getReadPointer (0) + length) });
+        }
+
+        return corpus;
+    }
+
+    /** Copies the next numSamples of a looped signal into every channel. */
+    inline void fillBlock (juce::AudioBuffer<float>& buffer, int numSamples, const Signal& signal, size_t& position)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float s = signal.samples[position];
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                buffer.setSample (channel, i, s);
+
+            if (++position >= signal.samples.size())
+                position = 0;
+        }
+    }
+
+    //==============================================================================
+    /** Per-call timings of one benchmark case. */
+    class Timings
+    {
+    public:
+        void reserve (size_t calls)                         { nanoseconds.reserve (calls); }
+        void clear()                                        { nanoseconds.clear(); totalSamples = 0; }
+
+        void add (juce::int64 ticks, int numSamples)
+        {
+            nanoseconds.push_back (juce::Time::highResolutionTicksToSeconds (ticks) * 1.0e9);
+            samplesPerCall = numSamples;
+            totalSamples += numSamples;
+        }
+
+        int getNumCalls() const noexcept                    { return (int) nanoseconds.size(); }
+        juce::int64 getTotalSamples() const noexcept        { return totalSamples; }
+
+        double getTotalNanoseconds() const noexcept
+        {
+            double total = 0.0;
+            for (auto ns : nanoseconds)
+                total += ns;
+            return total;
+        }
+
+        double getNanosecondsPerSample() const noexcept
+        {
+            return totalSamples > 0 ? getTotalNanoseconds() / (double) totalSamples : 0.0;
+        }
+
+        /** Processing time over audio time: 0.01 = 1% of one core, >= 1 can't run live. */
+        double getRealTimeFactor (double sampleRate) const noexcept
+        {
+            return getNanosecondsPerSample() * 1.0e-9 * sampleRate;
+        }
+
+        /** Percentile (0-100) of the per-call time, in ns per sample. */
+        double getPercentile (double percentile) const
+        {
+            if (nanoseconds.empty())
+                return 0.0;
+
+            auto sorted = nanoseconds;
+            const auto index = (size_t) juce::jlimit (0.0, (double) sorted.size() - 1.0,
+                                                      std::ceil (percentile / 100.0 * (double) sorted.size()) - 1.0);
+            std::nth_element (sorted.begin(), sorted.begin() + (ptrdiff_t) index, sorted.end());
+            return sorted[index] / (double) juce::jmax (1, samplesPerCall);
+        }
+
+    private:
+        std::vector<double> nanoseconds;
+        int samplesPerCall = 0;
+        juce::int64 totalSamples = 0;
+    };
+
+    //==============================================================================
+    /**
+        Result rows for regression tracking. Every row is a flat set of named
+        values; the JSON file carries the machine it ran on, the CSV is one
+        line per row with the columns of the first row.
+    */
+    class ResultWriter
+    {
+    public:
+        explicit ResultWriter (juce::String benchmarkName) : name (std::move (benchmarkName)) {}
+
+        juce::DynamicObject& addRow()
+        {
+            rows.add (new juce::DynamicObject());
+            return *rows.getLast();
+        }
+
+        const juce::ReferenceCountedArray<juce::DynamicObject>& getRows() const noexcept { return rows; }
+
+        bool writeJson (const juce::File& file) const
+        {
+            auto root = std::make_unique<juce::DynamicObject>();
+            root->setProperty ("benchmark", name);
+            root->setProperty ("time", juce::Time::getCurrentTime().toISO8601 (true));
+            root->setProperty ("cpu", juce::SystemStats::getCpuModel());
+            root->setProperty ("cores", juce::SystemStats::getNumPhysicalCpus());
+            root->setProperty ("os", juce::SystemStats::getOperatingSystemName());
+           #if JUCE_DEBUG
+            root->setProperty ("build", "debug");
+           #else
+            root->setProperty ("build", "release");
+           #endif
+
+            juce::Array<juce::var> results;
+            for (auto* row : rows)
+                results.add (juce::var (row));
+            root->setProperty ("results", results);
+
+            return file.replaceWithText (juce::JSON::toString (juce::var (root.release())));
+        }
+
+        bool writeCsv (const juce::File& file) const
+        {
+            if (rows.isEmpty())
+                return file.replaceWithText ({});
+
+            juce::StringArray columns, lines;
+            for (auto& property : rows.getFirst()->getProperties())
+                columns.add (property.name.toString());
+            lines.add (columns.joinIntoString (","));
+
+            for (auto* row : rows)
+            {
+                juce::StringArray cells;
+                for (auto& column : columns)
+                    cells.add (row->getProperty (column).toString());
+                lines.add (cells.joinIntoString (","));
+            }
+
+            return file.replaceWithText (lines.joinIntoString ("\n") + "\n");
+        }
+
+    private:
+        juce::String name;
+        juce::ReferenceCountedArray<juce::DynamicObject> rows;
+    };
+
+    //==============================================================================
+    /** True where readCycleCounter() reads the CPU's time-stamp counter rather than estimating. */
+    inline constexpr bool hasCycleCounter() noexcept
+    {
+       #if JUCE_INTEL
+        return true;
+       #else
+        return false;
+       #endif
+    }
+
+    /**
+        Time-stamp counter on x86 (constant-rate reference cycles, so turbo and
+        power states don't skew comparisons). Elsewhere, high-resolution ticks
+        scaled by the reported CPU clock.
+    */
+    inline juce::uint64 readCycleCounter() noexcept
+    {
+       #if JUCE_INTEL
+        return (juce::uint64) __rdtsc();
+       #else
+        static const double cyclesPerTick = juce::SystemStats::getCpuSpeedInMegahertz() * 1.0e6
+                                          / (double) juce::Time::getHighResolutionTicksPerSecond();
+        return (juce::uint64) ((double) juce::Time::getHighResolutionTicks() * cyclesPerTick);
+       #endif
+    }
+
+    /** Walks a buffer larger than any last-level cache, so the next call starts cold. */
+    inline void evictCaches()
+    {
+        static std::vector<juce::uint8> scratch (64 * 1024 * 1024);
+        static juce::uint8 counter = 0;
+        ++counter;
+
+        for (size_t i = 0; i < scratch.size(); i += 64)
+            scratch[i] = (juce::uint8) (scratch[i] + counter);
+    }
+
+    //==============================================================================
+    inline juce::Array<double> parseList (const juce::String& list)
+    {
+        juce::Array<double> values;
+        for (auto& token : juce::StringArray::fromTokens (list, ",", {}))
+            if (token.getDoubleValue() > 0.0)
+                values.add (token.getDoubleValue());
+
+        return values;
+    }
+}
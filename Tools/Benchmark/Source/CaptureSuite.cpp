@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    Neural capture benchmark: NeuralAmp::measureRealTimeFactor for every
+    hidden size that has a compiled engine, GRU and LSTM, at the common host
+    rates and block sizes. Weights are random (the cost doesn't depend on
+    them), so no capture files are needed.
+
+  ==============================================================================
+*/
+
+#include "Suites.h"
+#include "../../../Source/NeuralAmpModel.h"
+
+void Benchmark::runCaptureSuite (ResultWriter& results, const SuiteOptions& options)
+{
+    const double seconds = options.quick ? 0.5 : 2.0;
+    const juce::Array<double> rates = options.quick ? juce::Array<double> { 48000.0 } : juce::Array<double> { 44100.0, 48000.0, 96000.0 };
+    const juce::Array<double> blocks = ! options.blocks.isEmpty() ? options.blocks
+                                     : options.quick ? juce::Array<double> { 64.0, 512.0 }
+                                                     : juce::Array<double> { 32.0, 128.0, 512.0 };
+
+    std::cout << "model      rate   block          RTF  ns/sample" << std::endl;
+
+    for (auto type : { NeuralAmp::UnitType::gru, NeuralAmp::UnitType::lstm })
+    {
+        for (auto hiddenSize : NeuralAmp::supportedHiddenSizes)
+        {
+            auto model = NeuralAmp::createRandomised (type, hiddenSize);
+
+            for (auto rate : rates)
+            {
+                for (auto blockSize : blocks)
+                {
+                    // One short pass first so the weights are in cache and the clock is up
+                    NeuralAmp::measureRealTimeFactor (*model, rate, (int) blockSize, 0.05);
+                    const double realTimeFactor = NeuralAmp::measureRealTimeFactor (*model, rate, (int) blockSize, seconds);
+                    const double nanosecondsPerSample = realTimeFactor * 1.0e9 / rate;
+
+                    auto& row = results.addRow();
+                    row.setProperty ("model", model->name);
+                    row.setProperty ("cell", type == NeuralAmp::UnitType::gru ? "gru" : "lstm");
+                    row.setProperty ("hiddenSize", hiddenSize);
+                    row.setProperty ("sampleRate", rate);
+                    row.setProperty ("blockSize", (int) blockSize);
+                    row.setProperty ("realTimeFactor", realTimeFactor);
+                    row.setProperty ("nsPerSample", nanosecondsPerSample);
+
+                    std::cout << model->name.paddedRight (' ', 8) << juce::String (rate, 0).paddedLeft (' ', 7)
+                              << juce::String ((int) blockSize).paddedLeft (' ', 8)
+                              << juce::String (realTimeFactor, 4).paddedLeft (' ', 13)
+                              << juce::String (nanosecondsPerSample, 1).paddedLeft (' ', 11) << std::endl;
+                }
+            }
+        }
+    }
+}
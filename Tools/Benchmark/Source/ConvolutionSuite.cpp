@@ -0,0 +1,115 @@
+/*
+  ==============================================================================
+
+    Cabinet convolution benchmark: Cabinet::Convolver across IR lengths and
+    host block sizes, with the shared tail worker running as it does in the
+    plugin. Blocks are paced at real time, so the worker gets the same
+    deadline it gets live; "late" counts tail blocks the audio thread had to
+    compute itself because the worker missed it.
+
+  ==============================================================================
+*/
+
+#include <thread>
+#include "Suites.h"
+#include "../../../Source/CabinetConvolver.h"
+
+namespace
+{
+    /** Noise under an exponential decay (-60 dB at the end), like a cabinet IR without the resonances. */
+    std::vector<float> makeImpulseResponse (double sampleRate, double milliseconds)
+    {
+        std::vector<float> ir ((size_t) juce::jmax (1.0, sampleRate * milliseconds * 0.001));
+        juce::Random random (0xcab);
+
+        for (size_t i = 0; i < ir.size(); ++i)
+        {
+            const auto decay = std::pow (0.001, (double) i / (double) ir.size());
+            ir[i] = (float) decay * 0.2f * (random.nextFloat() * 2.0f - 1.0f);
+        }
+
+        return ir;
+    }
+
+    /** Busy-waits until a point on the high-resolution clock; sleeping is far too coarse at 32 samples. */
+    void waitUntil (juce::int64 ticks) noexcept
+    {
+        while (juce::Time::getHighResolutionTicks() < ticks)
+            std::this_thread::yield();
+    }
+}
+
+void Benchmark::runConvolutionSuite (ResultWriter& results, const SuiteOptions& options)
+{
+    constexpr double sampleRate = 48000.0;
+    const double seconds = options.quick ? 0.5 : 2.0;
+    const juce::Array<double> lengths = options.quick ? juce::Array<double> { 20.0, 200.0 }
+                                                      : juce::Array<double> { 20.0, 50.0, 100.0, 200.0, 500.0 };
+    const juce::Array<double> blocks = ! options.blocks.isEmpty() ? options.blocks
+                                     : options.quick ? juce::Array<double> { 64.0, 512.0 }
+                                                     : juce::Array<double> { 32.0, 64.0, 128.0, 256.0, 512.0, 1024.0 };
+
+    juce::SharedResourcePointer<Cabinet::TailWorker> worker;
+    const auto input = makeNoise (sampleRate, seconds);
+    const auto ticksPerSecond = (double) juce::Time::getHighResolutionTicksPerSecond();
+
+    std::cout << "IR ms  partitions  block    ns/sample      RTF        p99      max   late" << std::endl;
+
+    for (auto milliseconds : lengths)
+    {
+        const auto samples = makeImpulseResponse (sampleRate, milliseconds);
+        const auto ir = Cabinet::PartitionedIR::create (samples.data(), (int) samples.size(), sampleRate, "benchmark");
+
+        for (auto blockSizeValue : blocks)
+        {
+            const int blockSize = (int) blockSizeValue;
+            Cabinet::Convolver convolver (ir, *worker, blockSize);
+            std::vector<float> block ((size_t) blockSize);
+
+            Timings timings;
+            const auto numBlocks = (int) (input.samples.size() / (size_t) blockSize);
+            timings.reserve ((size_t) numBlocks);
+
+            size_t position = 0;
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            for (int b = 0; b < numBlocks; ++b)
+            {
+                waitUntil (start + (juce::int64) ((double) b * blockSize / sampleRate * ticksPerSecond));
+
+                for (auto& s : block)
+                {
+                    s = input.samples[position];
+                    position = (position + 1) % input.samples.size();
+                }
+
+                const auto before = juce::Time::getHighResolutionTicks();
+                convolver.process (block.data(), blockSize);
+                timings.add (juce::Time::getHighResolutionTicks() - before, blockSize);
+            }
+
+            const int tailBlocks = ir->numPartitions > convolver.getNumHeadPartitions()
+                                     ? (int) (timings.getTotalSamples() / Cabinet::partitionSize) : 0;
+            const double latePercent = tailBlocks > 0 ? 100.0 * convolver.getNumLateTails() / tailBlocks : 0.0;
+
+            auto& row = results.addRow();
+            row.setProperty ("irMilliseconds", milliseconds);
+            row.setProperty ("partitions", ir->numPartitions);
+            row.setProperty ("blockSize", blockSize);
+            row.setProperty ("nsPerSample", timings.getNanosecondsPerSample());
+            row.setProperty ("realTimeFactor", timings.getRealTimeFactor (sampleRate));
+            row.setProperty ("p99NsPerSample", timings.getPercentile (99.0));
+            row.setProperty ("maxNsPerSample", timings.getPercentile (100.0));
+            row.setProperty ("lateTailPercent", latePercent);
+
+            std::cout << juce::String (milliseconds, 0).paddedLeft (' ', 5)
+                      << juce::String (ir->numPartitions).paddedLeft (' ', 12)
+                      << juce::String (blockSize).paddedLeft (' ', 7)
+                      << juce::String (timings.getNanosecondsPerSample(), 1).paddedLeft (' ', 13)
+                      << juce::String (timings.getRealTimeFactor (sampleRate), 4).paddedLeft (' ', 9)
+                      << juce::String (timings.getPercentile (99.0), 1).paddedLeft (' ', 11)
+                      << juce::String (timings.getPercentile (100.0), 1).paddedLeft (' ', 9)
+                      << (juce::String (latePercent, 1) + "%").paddedLeft (' ', 7) << std::endl;
+        }
+    }
+}
@@ -0,0 +1,266 @@
+/*
+  ==============================================================================
+
+    GAINFORGE engine benchmark: runs GainForgeAudioProcessor::processBlock
+    (headless, no editor) over synthetic signals and an optional DI corpus,
+    for every MODE / VOICE / RECTIFIER_MODE combination at each sample rate
+    and block size.
+
+    Usage: Benchmark [--rates 44100,48000,...] [--blocks 16,32,...] [--seconds 1]
+                     [--quality eco,standard,high] [--corpus <folder>]
+                     [--json <file>] [--csv <file>] [--quick]
+                     [--suite engine|state|presets|cabinet|capture|memory]
+
+    Reports ns/sample, the real-time factor (processing time over audio time)
+    and p50/p95/p99/max of the per-block cost. Use a release build.
+
+    --suite runs one of the other benchmarks instead (Suites.h):
+      state    save/load time per instance, binary (changed and cached) vs XML
+      presets  open/search/tag filter over a generated 100k preset library
+      cabinet  convolution cost per IR length (20-500 ms) and block size (32-1024)
+      capture  neural capture real-time factor, GRU/LSTM at every shipped size
+      memory   footprint of 1/8/32 instances with shared tables and cabinet IR
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+#include "BenchmarkSupport.h"
+#include "Suites.h"
+
+namespace
+{
+    const juce::StringArray modeNames { "Cln", "Cru", "Mod" };
+    const juce::StringArray voiceNames { "Raw", "Mid", "Mod" };
+    const juce::StringArray rectifierNames { "Silicon", "Tube" };
+    const juce::StringArray qualityNames { "auto", "eco", "standard", "high" }; // QUALITY choice order
+
+    void setParameter (GainForgeAudioProcessor& processor, const char* id, float value)
+    {
+        if (auto* parameter = processor.apvts.getParameter (id))
+            parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+    }
+
+    /** Runs the processor over a looped signal; only the processBlock calls are timed. */
+    void run (GainForgeAudioProcessor& processor, juce::AudioBuffer<float>& buffer, const Benchmark::Signal& signal,
+              size_t& position, juce::int64 numSamples, Benchmark::Timings* timings)
+    {
+        juce::MidiBuffer midi;
+        const int blockSize = buffer.getNumSamples();
+
+        for (juce::int64 done = 0; done < numSamples; done += blockSize)
+        {
+            Benchmark::fillBlock (buffer, blockSize, signal, position);
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            processor.processBlock (buffer, midi);
+            const auto elapsed = juce::Time::getHighResolutionTicks() - start;
+
+            if (timings != nullptr)
+                timings->add (elapsed, blockSize);
+        }
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::Array<double> rates { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 };
+    juce::Array<double> blocks { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+    juce::StringArray qualities { "standard" };
+    juce::String suite ("engine");
+    double seconds = 1.0;
+    bool quick = false, blocksGiven = false;
+    juce::File corpusFolder, jsonFile, csvFile;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const juce::String arg (argv[i]);
+        const bool hasValue = i + 1 < argc;
+        const auto cwd = juce::File::getCurrentWorkingDirectory();
+
+        if (arg == "--rates" && hasValue)           rates = Benchmark::parseList (argv[++i]);
+        else if (arg == "--blocks" && hasValue)     { blocks = Benchmark::parseList (argv[++i]); blocksGiven = true; }
+        else if (arg == "--seconds" && hasValue)    seconds = juce::String (argv[++i]).getDoubleValue();
+        else if (arg == "--quality" && hasValue)    qualities = juce::StringArray::fromTokens (argv[++i], ",", {});
+        else if (arg == "--corpus" && hasValue)     corpusFolder = cwd.getChildFile (argv[++i]);
+        else if (arg == "--json" && hasValue)       jsonFile = cwd.getChildFile (argv[++i]);
+        else if (arg == "--csv" && hasValue)        csvFile = cwd.getChildFile (argv[++i]);
+        else if (arg == "--suite" && hasValue)      suite = juce::String (argv[++i]).trim().toLowerCase();
+        else if (arg == "--quick")                  { rates = { 48000.0 }; blocks = { 64, 512 }; seconds = 0.5; quick = true; }
+        else
+        {
+            std::cout << "Usage: Benchmark [--rates 44100,48000,...] [--blocks 16,32,...] [--seconds 1]" << std::endl
+                      << "                 [--quality eco,standard,high] [--corpus <folder>]" << std::endl
+                      << "                 [--json <file>] [--csv <file>] [--quick]" << std::endl
+                      << "                 [--suite engine|state|presets|cabinet|capture|memory]" << std::endl;
+            return 1;
+        }
+    }
+
+    auto writeResults = [&] (const Benchmark::ResultWriter& results)
+    {
+        bool written = true;
+        if (jsonFile != juce::File())
+            written = results.writeJson (jsonFile) && written;
+        if (csvFile != juce::File())
+            written = results.writeCsv (csvFile) && written;
+
+        if (! written)
+        {
+            std::cerr << "Couldn't write the result files" << std::endl;
+            return 2;
+        }
+
+        return 0;
+    };
+
+    if (suite != "engine")
+    {
+        Benchmark::SuiteOptions options;
+        options.quick = quick;
+        if (blocksGiven)
+            options.blocks = blocks;
+
+        std::cout << juce::SystemStats::getCpuModel() << std::endl;
+
+        if (suite == "state")
+        {
+            Benchmark::ResultWriter results ("GainForgeAudioProcessor state save/load");
+            Benchmark::runStateSuite (results, options);
+            return writeResults (results);
+        }
+
+        if (suite == "presets")
+        {
+            Benchmark::ResultWriter results ("PresetLibrary 100k presets");
+            Benchmark::runPresetSuite (results, options);
+            return writeResults (results);
+        }
+
+        if (suite == "cabinet")
+        {
+            Benchmark::ResultWriter results ("Cabinet::Convolver IR length x block size");
+            Benchmark::runConvolutionSuite (results, options);
+            return writeResults (results);
+        }
+
+        if (suite == "capture")
+        {
+            Benchmark::ResultWriter results ("NeuralAmp capture real-time factor");
+            Benchmark::runCaptureSuite (results, options);
+            return writeResults (results);
+        }
+
+        if (suite == "memory")
+        {
+            Benchmark::ResultWriter results ("GainForgeAudioProcessor shared memory footprint");
+            Benchmark::runMemorySuite (results, options);
+            return writeResults (results);
+        }
+
+        std::cerr << "Unknown suite: " << suite << std::endl;
+        return 1;
+    }
+
+    for (auto& quality : qualities)
+    {
+        if (! qualityNames.contains (quality.trim().toLowerCase()))
+        {
+            std::cerr << "Unknown quality: " << quality << std::endl;
+            return 1;
+        }
+    }
+
+    if (rates.isEmpty() || blocks.isEmpty() || seconds <= 0.0)
+    {
+        std::cerr << "Nothing to run" << std::endl;
+        return 1;
+    }
+
+    const auto corpus = corpusFolder.isDirectory() ? Benchmark::loadCorpus (corpusFolder, seconds)
+                                                   : std::vector<Benchmark::Signal>();
+    if (corpusFolder != juce::File() && corpus.empty())
+        std::cerr << "No audio files in " << corpusFolder.getFullPathName() << ", running synthetic signals only" << std::endl;
+
+    Benchmark::ResultWriter results ("GainForgeAudioProcessor::processBlock");
+
+    std::cout << juce::SystemStats::getCpuModel() << std::endl
+              << "rate    block quality  mode voice rect    signal           ns/smp     RTF    p50    p95    p99    max" << std::endl;
+
+    for (auto rate : rates)
+    {
+        auto signals = Benchmark::makeSyntheticSignals (rate, seconds);
+        signals.insert (signals.end(), corpus.begin(), corpus.end());
+
+        for (auto block : blocks)
+        {
+            const int blockSize = (int) block;
+            const auto numSamples = (juce::int64) (seconds * rate);
+
+            GainForgeAudioProcessor processor;
+            processor.setRateAndBufferSizeDetails (rate, blockSize);
+            processor.prepareToPlay (rate, blockSize);
+            juce::AudioBuffer<float> buffer (2, blockSize);
+
+            for (auto& quality : qualities)
+            for (int mode = 0; mode < modeNames.size(); ++mode)
+            for (int voice = 0; voice < voiceNames.size(); ++voice)
+            for (int rectifier = 0; rectifier < rectifierNames.size(); ++rectifier)
+            {
+                // A typical high-gain setting, so every stage does real work
+                setParameter (processor, "QUALITY", (float) qualityNames.indexOf (quality.trim().toLowerCase()));
+                setParameter (processor, "GAIN", 0.7f);
+                setParameter (processor, "DRIVE", 0.5f);
+                setParameter (processor, "MASTER", 0.3f);
+                setParameter (processor, "MODE", (float) mode);
+                setParameter (processor, "VOICE", (float) voice);
+                setParameter (processor, "RECTIFIER_MODE", (float) rectifier);
+
+                for (auto& signal : signals)
+                {
+                    // Let smoothers, crossfades and the quality tier settle before timing
+                    size_t position = 0;
+                    run (processor, buffer, signal, position, (juce::int64) (0.25 * rate), nullptr);
+
+                    Benchmark::Timings timings;
+                    timings.reserve ((size_t) (numSamples / blockSize + 1));
+                    run (processor, buffer, signal, position, numSamples, &timings);
+
+                    auto& row = results.addRow();
+                    row.setProperty ("sampleRate", rate);
+                    row.setProperty ("blockSize", blockSize);
+                    row.setProperty ("quality", quality.trim().toLowerCase());
+                    row.setProperty ("mode", modeNames[mode]);
+                    row.setProperty ("voice", voiceNames[voice]);
+                    row.setProperty ("rectifier", rectifierNames[rectifier]);
+                    row.setProperty ("signal", signal.name);
+                    row.setProperty ("samples", timings.getTotalSamples());
+                    row.setProperty ("nsPerSample", timings.getNanosecondsPerSample());
+                    row.setProperty ("realTimeFactor", timings.getRealTimeFactor (rate));
+                    row.setProperty ("p50NsPerSample", timings.getPercentile (50.0));
+                    row.setProperty ("p95NsPerSample", timings.getPercentile (95.0));
+                    row.setProperty ("p99NsPerSample", timings.getPercentile (99.0));
+                    row.setProperty ("maxNsPerSample", timings.getPercentile (100.0));
+
+                    std::cout << juce::String (rate, 0).paddedRight (' ', 8) << juce::String (blockSize).paddedRight (' ', 6)
+                              << quality.trim().toLowerCase().paddedRight (' ', 9) << modeNames[mode].paddedRight (' ', 5)
+                              << voiceNames[voice].paddedRight (' ', 6) << rectifierNames[rectifier].paddedRight (' ', 8)
+                              << signal.name.substring (0, 16).paddedRight (' ', 17)
+                              << juce::String (timings.getNanosecondsPerSample(), 1).paddedLeft (' ', 6)
+                              << juce::String (timings.getRealTimeFactor (rate), 4).paddedLeft (' ', 8)
+                              << juce::String (timings.getPercentile (50.0), 1).paddedLeft (' ', 7)
+                              << juce::String (timings.getPercentile (95.0), 1).paddedLeft (' ', 7)
+                              << juce::String (timings.getPercentile (99.0), 1).paddedLeft (' ', 7)
+                              << juce::String (timings.getPercentile (100.0), 1).paddedLeft (' ', 7) << std::endl;
+                }
+            }
+
+            processor.releaseResources();
+        }
+    }
+
+    return writeResults (results);
+}
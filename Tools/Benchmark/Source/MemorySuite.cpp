@@ -0,0 +1,105 @@
+/*
+  ==============================================================================
+
+    Memory benchmark: the footprint of N prepared instances that all load the
+    same cabinet: the shared part read from the process-wide
+    SharedDspResourceCache, the private part from each instance's own
+    components. Shows what one more instance costs, and what sharing saves
+    against every instance building its own copy.
+
+  ==============================================================================
+*/
+
+#include "Suites.h"
+#include "../../../Source/PluginProcessor.h"
+
+namespace
+{
+    /** A 200 ms decaying-noise IR written to a temporary WAV, so every instance loads the same file. */
+    bool writeImpulseResponse (const juce::File& file, double sampleRate)
+    {
+        juce::AudioBuffer<float> ir (1, (int) (0.2 * sampleRate));
+        juce::Random random (0xcab);
+
+        for (int i = 0; i < ir.getNumSamples(); ++i)
+            ir.setSample (0, i, (float) std::pow (0.001, (double) i / ir.getNumSamples()) * 0.2f * (random.nextFloat() * 2.0f - 1.0f));
+
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer (wav.createWriterFor (new juce::FileOutputStream (file),
+                                                                              sampleRate, 1, 24, {}, 0));
+        return writer != nullptr && writer->writeFromAudioSampleBuffer (ir, 0, ir.getNumSamples());
+    }
+
+    /** The background jobs build and share asynchronously; wait until the cache stops changing. */
+    SharedDspResourceCache::Usage waitForSettledUsage (SharedDspResourceCache& cache)
+    {
+        auto usage = cache.getUsage();
+
+        for (int settled = 0, waited = 0; settled < 4 && waited < 200; ++waited)
+        {
+            juce::Thread::sleep (50);
+            const auto next = cache.getUsage();
+            settled = next.sharedBytes == usage.sharedBytes && next.unsharedBytes == usage.unsharedBytes ? settled + 1 : 0;
+            usage = next;
+        }
+
+        return usage;
+    }
+}
+
+void Benchmark::runMemorySuite (ResultWriter& results, const SuiteOptions& options)
+{
+    constexpr double sampleRate = 48000.0;
+    const juce::Array<int> instanceCounts = options.quick ? juce::Array<int> { 1, 4 } : juce::Array<int> { 1, 8, 32 };
+
+    juce::TemporaryFile irFile (".wav");
+    if (! writeImpulseResponse (irFile.getFile(), sampleRate))
+    {
+        std::cerr << "Couldn't write the test impulse response" << std::endl;
+        return;
+    }
+
+    juce::SharedResourcePointer<SharedDspResourceCache> cache;
+    std::cout << "instances  entries   shared KiB  unshared KiB  KiB/instance" << std::endl;
+
+    for (auto count : instanceCounts)
+    {
+        juce::OwnedArray<GainForgeAudioProcessor> instances;
+
+        for (int i = 0; i < count; ++i)
+        {
+            auto* processor = instances.add (new GainForgeAudioProcessor());
+            processor->setPlayConfigDetails (2, 2, sampleRate, 512);
+            processor->prepareToPlay (sampleRate, 512);
+            processor->loadCabinetIR (irFile.getFile());
+        }
+
+        const auto usage = waitForSettledUsage (*cache);
+        // Each instance's own heap (convolvers, oversamplers, buffers), summed component by component
+        size_t privateBytes = 0;
+        for (auto* processor : instances)
+            privateBytes += processor->getPrivateMemory().getTotal();
+        privateBytes /= (size_t) count;
+
+        const auto perInstance = (double) privateBytes + (double) usage.sharedBytes / count;
+
+        auto& row = results.addRow();
+        row.setProperty ("instances", count);
+        row.setProperty ("sharedEntries", usage.numLiveEntries);
+        row.setProperty ("sharedBytes", (juce::int64) usage.sharedBytes);
+        row.setProperty ("unsharedBytes", (juce::int64) usage.unsharedBytes);
+        row.setProperty ("privateBytesPerInstance", (juce::int64) privateBytes);
+        row.setProperty ("bytesPerInstance", perInstance);
+
+        std::cout << juce::String (count).paddedRight (' ', 9) << juce::String (usage.numLiveEntries).paddedLeft (' ', 9)
+                  << juce::String ((double) usage.sharedBytes / 1024.0, 1).paddedLeft (' ', 13)
+                  << juce::String ((double) usage.unsharedBytes / 1024.0, 1).paddedLeft (' ', 14)
+                  << juce::String (perInstance / 1024.0, 1).paddedLeft (' ', 14) << std::endl;
+
+        if (count == instanceCounts.getLast())
+            std::cout << instances.getLast()->getMemoryReport();
+
+        for (auto* processor : instances)
+            processor->releaseResources();
+    }
+}
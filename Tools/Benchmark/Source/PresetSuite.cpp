@@ -0,0 +1,141 @@
+/*
+  ==============================================================================
+
+    Preset library benchmark: a generated library of 100k presets (artist/song
+    style names, a handful of tags each) written to a temporary file, then
+    timed for open, browsing names, recall (read, and applied to a processor),
+    free-text search and tag filter.
+    The file was just written, so open and the first scan run from the page
+    cache; that is also the case after the library has been browsed once.
+
+  ==============================================================================
+*/
+
+#include <map>
+#include "Suites.h"
+#include "../../../Source/PluginProcessor.h"
+
+namespace
+{
+    volatile float sink = 0.0f; // Keeps the read loops from being optimised away
+
+    std::vector<PresetLibrary::Entry> generateEntries (int count)
+    {
+        static const char* artists[] = { "Crimson", "Lowland", "Velvet", "Iron", "Static", "Hollow", "Neon", "Ashen",
+                                         "Silver", "Northern", "Broken", "Electric", "Paper", "Distant", "Golden", "Wild" };
+        static const char* nouns[]   = { "Engine", "Harbor", "Saints", "Machine", "Garden", "Riders", "Empire", "Choir",
+                                         "Signal", "Tide", "Wolves", "Parade", "Anthem", "Canyon", "Circuit", "Echo" };
+        static const char* tags[]    = { "clean", "crunch", "lead", "rhythm", "metal", "blues", "ambient", "funk",
+                                         "djent", "indie", "vintage", "modern", "tight", "loose", "bright", "dark" };
+
+        juce::Random random (100000);
+        std::vector<PresetLibrary::Entry> entries ((size_t) count);
+
+        for (int i = 0; i < count; ++i)
+        {
+            auto& entry = entries[(size_t) i];
+            entry.name = juce::String (artists[random.nextInt (16)]) + " " + nouns[random.nextInt (16)]
+                          + " - Song " + juce::String (i);
+
+            juce::StringArray entryTags;
+            for (int t = 1 + random.nextInt (4); --t >= 0;)
+                entryTags.addIfNotAlreadyThere (tags[random.nextInt (16)]);
+            entry.tags = entryTags.joinIntoString (",");
+
+            for (int p = 0; p < ParameterSnapshot::numParameters; ++p)
+                entry.parameters[p] = random.nextFloat();
+        }
+
+        return entries;
+    }
+
+    /** Milliseconds for one run of an operation. */
+    template <typename Operation>
+    double timeMilliseconds (Operation&& operation)
+    {
+        const auto start = juce::Time::getHighResolutionTicks();
+        operation();
+        return juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start) * 1000.0;
+    }
+}
+
+void Benchmark::runPresetSuite (ResultWriter& results, const SuiteOptions& options)
+{
+    const int numPresets = options.quick ? 10000 : 100000;
+    const int repetitions = options.quick ? 5 : 21;
+
+    juce::TemporaryFile temporary (".gfpl");
+    const auto& file = temporary.getFile();
+
+    const auto entries = generateEntries (numPresets);
+    std::map<juce::String, std::vector<double>> runs;
+    std::map<juce::String, size_t> matches;
+    GainForgeAudioProcessor processor;
+
+    for (int repetition = 0; repetition < repetitions; ++repetition)
+    {
+        runs["write"].push_back (timeMilliseconds ([&] { PresetLibrary::write (file, entries); }));
+
+        PresetLibrary library;
+        runs["open"].push_back (timeMilliseconds ([&] { library.open (file); }));
+
+        if (! library.isOpen() || library.getNumPresets() != numPresets)
+        {
+            std::cerr << "Couldn't read back the generated library" << std::endl;
+            return;
+        }
+
+        // What a browser list does when scrolled through the whole library
+        runs["names (all)"].push_back (timeMilliseconds ([&]
+        {
+            for (int i = 0; i < library.getNumPresets(); ++i)
+                sink = sink + (float) library.getName (i).length();
+        }));
+        matches["names (all)"] = (size_t) numPresets;
+
+        // 1000 recalls spread over the file
+        runs["recall x1000"].push_back (timeMilliseconds ([&]
+        {
+            for (int i = 0; i < 1000; ++i)
+                sink = sink + library.getParameters ((int) (((juce::int64) i * 7919) % numPresets))[0];
+        }));
+        matches["recall x1000"] = 1000;
+
+        // The same recalls through the processor: record -> snapshot -> audio thread and host
+        runs["apply x1000"].push_back (timeMilliseconds ([&]
+        {
+            for (int i = 0; i < 1000; ++i)
+                processor.applyLibraryPreset (library, (int) (((juce::int64) i * 7919) % numPresets));
+        }));
+        matches["apply x1000"] = 1000;
+
+        for (auto* query : { "engine", "velvet song 99", "lead dark", "nothing matches this" })
+        {
+            const auto operation = "search \"" + juce::String (query) + "\"";
+            runs[operation].push_back (timeMilliseconds ([&] { matches[operation] = library.search (query).size(); }));
+        }
+
+        for (auto* tag : { "metal", "ambient" })
+        {
+            const auto operation = "tag \"" + juce::String (tag) + "\"";
+            runs[operation].push_back (timeMilliseconds ([&] { matches[operation] = library.filterByTag (tag).size(); }));
+        }
+    }
+
+    std::cout << numPresets << " presets, " << file.getSize() / 1024 << " KiB" << std::endl
+              << "operation                          ms    matches" << std::endl;
+
+    for (auto& run : runs)
+    {
+        const double milliseconds = getMedian (run.second);
+
+        auto& row = results.addRow();
+        row.setProperty ("presets", numPresets);
+        row.setProperty ("operation", run.first);
+        row.setProperty ("milliseconds", milliseconds);
+        row.setProperty ("matches", (juce::int64) matches[run.first]);
+
+        std::cout << run.first.paddedRight (' ', 28) << juce::String (milliseconds, 3).paddedLeft (' ', 10)
+                  << juce::String ((juce::int64) matches[run.first]).paddedLeft (' ', 11) << std::endl;
+    }
+}
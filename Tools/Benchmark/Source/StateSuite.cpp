@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    State benchmark: what getStateInformation / setStateInformation cost per
+    instance as the session grows. Saves are timed right after a parameter
+    change (the blob has to be rebuilt) and again with nothing changed (the
+    cached blob is returned, as on most autosave and undo polls). The old
+    XML path (APVTS tree -> XML -> binary) is timed alongside for comparison.
+
+    Opening a session also prepares every instance, so the suite reports how
+    long prepareToPlay blocked and how long until each instance's tables were
+    ready (the processor's own AsyncPreparer timings, median over instances).
+
+  ==============================================================================
+*/
+
+#include <map>
+#include "Suites.h"
+#include "../../../Source/PluginProcessor.h"
+
+namespace
+{
+    void setParameter (GainForgeAudioProcessor& processor, const char* id, float value)
+    {
+        if (auto* parameter = processor.apvts.getParameter (id))
+            parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+    }
+
+    /** Microseconds per instance for one pass of an operation over every instance. */
+    template <typename Operation>
+    double timePerInstance (juce::OwnedArray<GainForgeAudioProcessor>& instances, Operation&& operation)
+    {
+        const auto start = juce::Time::getHighResolutionTicks();
+        for (int i = 0; i < instances.size(); ++i)
+            operation (*instances[i], i);
+        const auto elapsed = juce::Time::getHighResolutionTicks() - start;
+
+        return juce::Time::highResolutionTicksToSeconds (elapsed) * 1.0e6 / (double) instances.size();
+    }
+}
+
+void Benchmark::runStateSuite (ResultWriter& results, const SuiteOptions& options)
+{
+    const juce::Array<int> instanceCounts = options.quick ? juce::Array<int> { 1, 10 } : juce::Array<int> { 1, 10, 100 };
+    const int repetitions = options.quick ? 5 : 21;
+
+    std::cout << "instances  operation        us/instance" << std::endl;
+
+    for (auto count : instanceCounts)
+    {
+        juce::OwnedArray<GainForgeAudioProcessor> instances;
+        juce::Random random (count);
+
+        for (int i = 0; i < count; ++i)
+        {
+            auto* processor = instances.add (new GainForgeAudioProcessor());
+            for (auto* parameter : processor->getParameters())
+                parameter->setValueNotifyingHost (random.nextFloat());
+        }
+
+        std::vector<juce::MemoryBlock> binaryStates ((size_t) count), xmlStates ((size_t) count);
+        std::map<juce::String, std::vector<double>> runs;
+
+        for (int repetition = 0; repetition < repetitions; ++repetition)
+        {
+            // A knob moved since the last save, so the blob is rebuilt
+            for (auto* processor : instances)
+                setParameter (*processor, "GAIN", random.nextFloat());
+
+            runs["save (changed)"].push_back (timePerInstance (instances, [&] (GainForgeAudioProcessor& p, int i)
+            {
+                p.getStateInformation (binaryStates[(size_t) i]);
+            }));
+
+            runs["save (cached)"].push_back (timePerInstance (instances, [&] (GainForgeAudioProcessor& p, int i)
+            {
+                p.getStateInformation (binaryStates[(size_t) i]);
+            }));
+
+            runs["save (XML)"].push_back (timePerInstance (instances, [&] (GainForgeAudioProcessor& p, int i)
+            {
+                if (auto xml = p.apvts.copyState().createXml())
+                    juce::AudioProcessor::copyXmlToBinary (*xml, xmlStates[(size_t) i]);
+            }));
+
+            runs["load (binary)"].push_back (timePerInstance (instances, [&] (GainForgeAudioProcessor& p, int i)
+            {
+                p.setStateInformation (binaryStates[(size_t) i].getData(), (int) binaryStates[(size_t) i].getSize());
+            }));
+
+            runs["load (XML)"].push_back (timePerInstance (instances, [&] (GainForgeAudioProcessor& p, int i)
+            {
+                p.setStateInformation (xmlStates[(size_t) i].getData(), (int) xmlStates[(size_t) i].getSize());
+            }));
+        }
+
+        // Each instance prepares once (a repeat with the same settings returns early), so these are over instances
+        for (auto* processor : instances)
+            processor->prepareToPlay (48000.0, 512);
+
+        for (auto* processor : instances)
+        {
+            const auto giveUp = juce::Time::getMillisecondCounter() + 10000;
+            while (processor->getPrepareTimings().resourcesReadyMs <= 0.0 && juce::Time::getMillisecondCounter() < giveUp)
+                juce::Thread::sleep (1);
+
+            const auto timings = processor->getPrepareTimings();
+            runs["prepare (blocking)"].push_back (timings.prepareCallMs * 1000.0);
+            runs["prepare (ready)"].push_back (timings.resourcesReadyMs * 1000.0);
+        }
+
+        for (auto* operation : { "save (changed)", "save (cached)", "save (XML)", "load (binary)", "load (XML)",
+                                 "prepare (blocking)", "prepare (ready)" })
+        {
+            const double microseconds = getMedian (runs[operation]);
+            const juce::String name (operation);
+
+            auto& row = results.addRow();
+            row.setProperty ("instances", count);
+            row.setProperty ("operation", operation);
+            row.setProperty ("microsecondsPerInstance", microseconds);
+            if (! name.startsWith ("prepare"))
+                row.setProperty ("bytes", (juce::int64) (name.contains ("XML") ? xmlStates[0].getSize()
+                                                                               : binaryStates[0].getSize()));
+
+            std::cout << juce::String (count).paddedRight (' ', 11) << juce::String (operation).paddedRight (' ', 17)
+                      << juce::String (microseconds, 2).paddedLeft (' ', 11) << std::endl;
+        }
+    }
+}
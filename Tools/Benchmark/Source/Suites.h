@@ -0,0 +1,43 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "BenchmarkSupport.h"
+
+//==============================================================================
+/**
+    Benchmarks other than the engine sweep, picked with --suite. Each one
+    prints its own table and adds its rows to the run's ResultWriter.
+*/
+namespace Benchmark
+{
+    struct SuiteOptions
+    {
+        bool quick = false;
+        juce::Array<double> blocks; // Block sizes given with --blocks, empty for the suite's own
+    };
+
+    /** Median of a set of measurements (they're reordered). */
+    inline double getMedian (std::vector<double>& values)
+    {
+        if (values.empty())
+            return 0.0;
+
+        std::nth_element (values.begin(), values.begin() + (ptrdiff_t) (values.size() / 2), values.end());
+        return values[values.size() / 2];
+    }
+
+    /** Save/load time per instance: binary state (dirty and cached), against the old XML path. */
+    void runStateSuite (ResultWriter& results, const SuiteOptions& options);
+
+    /** A generated 100k preset library: write, open, name browsing, recall, search and tag filter. */
+    void runPresetSuite (ResultWriter& results, const SuiteOptions& options);
+
+    /** Cabinet::Convolver over IR length x block size, paced at real time with the tail worker running. */
+    void runConvolutionSuite (ResultWriter& results, const SuiteOptions& options);
+
+    /** NeuralAmp real-time factor for every compiled hidden size (8/16/20/32/40), GRU and LSTM. */
+    void runCaptureSuite (ResultWriter& results, const SuiteOptions& options);
+
+    /** Footprint of 1, 8 and 32 prepared instances sharing one cabinet, from the shared resource cache. */
+    void runMemorySuite (ResultWriter& results, const SuiteOptions& options);
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cmath>
+
+//==============================================================================
+/**
+    The amp chain as it was before quality tiers, oversampling, the passive
+    stack, cabinets and the split linear stage: 1x, std::tanh, tone-stack
+    coefficients once per block. Frozen here, decisions included, as the
+    reference a legacy session loaded onto Eco has to null against bit for bit.
+
+    Voice and Mode take the raw parameter values, exactly as the original
+    did, and go through its normalised thresholds (0.25 / 0.75). The
+    parameters delivered choice indices, so Mid and Crunch ran the Mod
+    branches - that is what old sessions sound like.
+*/
+class LegacyChain
+{
+public:
+    struct Settings
+    {
+        float gain = 0.0f, bass = 0.5f, mid = 0.5f, treble = 0.5f, presence = 0.5f, master = 0.5f, drive = 0.0f;
+        float rectifierMode = 0.0f;
+        float voice = 1.0f, mode = 2.0f;    // Raw choice values, as the original read them
+    };
+
+    LegacyChain()
+    {
+        for (auto* smoothed : { &smoothedGain, &smoothedMaster, &smoothedDrive })
+            smoothed->reset (44100.0, 0.05);
+        smoothedRectifierMode.reset (44100.0, 0.1);
+    }
+
+    void prepare (double newSampleRate, int maxBlockSize)
+    {
+        sampleRate = newSampleRate;
+
+        const juce::dsp::ProcessSpec spec { sampleRate, (juce::uint32) maxBlockSize, 1 };
+        for (auto* filter : { &bassFilter, &midFilter, &trebleFilter, &presenceFilter })
+            filter->prepare (spec);
+
+        for (auto* smoothed : { &smoothedGain, &smoothedMaster, &smoothedDrive })
+            smoothed->reset (sampleRate, 0.05);
+        smoothedRectifierMode.reset (sampleRate, 0.1);
+        rectifierSagState = 0.0f;
+
+        updateFilters (0.5f, 0.5f, 0.5f, 0.5f);
+    }
+
+    void process (float* channelData, int numSamples, const Settings& s)
+    {
+        smoothedGain.setTargetValue (s.gain);
+        smoothedMaster.setTargetValue (s.master);
+        smoothedDrive.setTargetValue (s.drive);
+        smoothedRectifierMode.setTargetValue (s.rectifierMode);
+
+        updateFilters (s.bass, s.mid, s.treble, s.presence);
+
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            float input = channelData[sample];
+
+            if (s.mode < 0.25f)
+            {
+                const float gainAmount = 0.8f + smoothedGain.getNextValue() * 2.2f;
+                input *= gainAmount;
+                input = std::tanh (input * 0.8f) * 1.0f;
+            }
+            else
+            {
+                const float gainAmount = 1.0f + smoothedGain.getNextValue() * 11.0f;
+
+                input *= gainAmount * 0.3f;
+                input = applyPreampStage (input, 1.0f, 1);
+                input *= gainAmount * 0.4f;
+                input = applyPreampStage (input, 1.0f, 2);
+                input *= gainAmount * 0.5f;
+                input = applyPreampStage (input, 1.0f, 3);
+                input *= gainAmount * 0.6f;
+                input = applyPreampStage (input, 1.0f, 4);
+
+                const float currentDrive = smoothedDrive.getNextValue();
+                const float currentRectifierMode = smoothedRectifierMode.getNextValue();
+                input = applyRectifierSaturation (input, currentDrive, currentRectifierMode);
+
+                if (s.voice < 0.25f)
+                    input = std::tanh (input * 1.6f) * 0.75f;
+                else if (s.voice < 0.75f)
+                    input = std::tanh (input * 1.3f) * 0.80f;
+                else
+                    input = std::tanh (input * 1.2f) * 0.85f;
+
+                if (s.mode < 0.75f)
+                {
+                    input *= 1.2f;
+                    input = std::tanh (input * 1.1f) * 0.85f;
+                }
+                else
+                {
+                    input *= 1.4f;
+                    input = std::tanh (input * 1.4f) * 0.75f;
+                }
+            }
+
+            channelData[sample] = input;
+        }
+
+        juce::dsp::AudioBlock<float> block (&channelData, 1, (size_t) numSamples);
+        juce::dsp::ProcessContextReplacing<float> context (block);
+        bassFilter.process (context);
+        midFilter.process (context);
+        trebleFilter.process (context);
+        presenceFilter.process (context);
+
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            const float currentMaster = smoothedMaster.getNextValue();
+            channelData[sample] *= (0.15f + currentMaster * 11.85f);
+            channelData[sample] = juce::jlimit (-0.98f, 0.98f, channelData[sample]);
+        }
+    }
+
+private:
+    void updateFilters (float bass, float mid, float treble, float presence)
+    {
+        *bassFilter.coefficients = *juce::dsp::IIR::Coefficients<float>::makeLowShelf (sampleRate, 80.0, 0.707, juce::jmap (bass, 0.12f, 4.2f));
+        *midFilter.coefficients = *juce::dsp::IIR::Coefficients<float>::makePeakFilter (sampleRate, 800.0, 0.65, juce::jmap (mid, 0.08f, 2.4f));
+        *trebleFilter.coefficients = *juce::dsp::IIR::Coefficients<float>::makeHighShelf (sampleRate, 2500.0, 0.707, juce::jmap (treble, 0.18f, 2.8f));
+        *presenceFilter.coefficients = *juce::dsp::IIR::Coefficients<float>::makeHighShelf (sampleRate, 5500.0, 0.707, juce::jmap (presence, 0.15f, 2.6f));
+    }
+
+    static float applyPreampStage (float input, float stageGain, int stageNumber)
+    {
+        float output = input * stageGain;
+        const float saturationAmount = 0.8f + stageNumber * 0.25f;
+
+        if (output > 0.0f)
+            output = std::tanh (output * saturationAmount * 1.3f) * 0.75f;
+        else
+            output = std::tanh (output * saturationAmount * 1.1f) * 0.80f;
+
+        return output;
+    }
+
+    float applyRectifierSaturation (float input, float drive, float rectifierMode)
+    {
+        float driven = input * (1.0f + drive * 10.0f);
+
+        if (rectifierMode < 0.5f)
+        {
+            driven = std::tanh (driven * 2.0f) * 0.70f;
+        }
+        else
+        {
+            const float sagAmount = std::abs (driven) * 0.15f;
+            rectifierSagState = rectifierSagState * 0.94f + sagAmount * 0.06f;
+            driven *= (1.0f - rectifierSagState * 0.30f);
+            driven = std::tanh (driven * 1.6f) * 0.75f;
+        }
+
+        return driven;
+    }
+
+    double sampleRate = 44100.0;
+    juce::dsp::IIR::Filter<float> bassFilter, midFilter, trebleFilter, presenceFilter;
+    juce::LinearSmoothedValue<float> smoothedGain, smoothedMaster, smoothedDrive, smoothedRectifierMode;
+    float rectifierSagState = 0.0f;
+};
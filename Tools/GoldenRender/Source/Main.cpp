@@ -0,0 +1,583 @@
+/*
+  ==============================================================================
+
+    GAINFORGE golden-output regression check. Renders fixed inputs through
+    every MODE / VOICE / RECTIFIER_MODE / TONE_STACK combination and through
+    the knob corners, null-tests each render against its stored reference,
+    and checks named benchmarks against stored ns/sample budgets.
+
+    It also loads states saved before the quality tiers existed and checks
+    that they land on Eco and render bit-identically to the pre-tier chain
+    (LegacyChain.h). That check needs no references and always runs.
+
+    Usage: GoldenRender [--references <folder>] [--tolerance-db -90]
+                        [--update-references] [--update-budgets [headroom]]
+                        [--add-missing] [--skip-budgets] [--filter <text>]
+
+    Without an --update option nothing is written: any difference beyond the
+    tolerance, missing reference or blown budget fails the run (exit code 3).
+    --add-missing writes only the references and budgets that don't exist
+    yet (new cases) and still checks the rest.
+
+    A folder with no references at all (or no budgets.json) hasn't been
+    generated yet rather than having lost every case: those checks are
+    skipped with a note saying how to generate them, the legacy check still
+    runs, and the exit code is 4 unless something else failed.
+
+    References are 32-bit float WAVs; budgets.json sits next to them. They are
+    committed in Tools/GoldenRender/References, which is the default folder
+    when run from anywhere inside the source tree. Budgets are per machine -
+    update them on the machine that enforces them.
+
+    Built with GAINFORGE_SYNCHRONOUS_PREPARE, so the passive tone-stack table
+    is in place from the first block and every render is deterministic.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+#include "../../Benchmark/Source/BenchmarkSupport.h"
+#include "LegacyChain.h"
+
+namespace
+{
+    constexpr double renderRate = 48000.0;
+    constexpr int renderBlockSize = 256;
+    constexpr double renderSeconds = 0.5;
+
+    /** The committed references, found from any folder inside the source tree (else ./References). */
+    juce::File findDefaultReferenceFolder()
+    {
+        const auto start = juce::File::getCurrentWorkingDirectory();
+
+        for (auto folder = start; folder.exists(); folder = folder.getParentDirectory())
+        {
+            const auto tool = folder.getChildFile ("Tools/GoldenRender");
+            if (tool.getChildFile ("GoldenRender.jucer").existsAsFile())
+                return tool.getChildFile ("References");
+
+            if (folder.isRoot())
+                break;
+        }
+
+        return start.getChildFile ("References");
+    }
+
+    const juce::StringArray modeNames { "Cln", "Cru", "Mod" };
+    const juce::StringArray voiceNames { "Raw", "Mid", "Mod" };
+    const juce::StringArray rectifierNames { "Silicon", "Tube" };
+    const juce::StringArray toneStackNames { "Classic", "Passive" };
+
+    const char* const knobIds[] = { "GAIN", "BASS", "MID", "TREBLE", "PRESENCE", "MASTER", "DRIVE" };
+
+    /** One render: parameter values by ID, on top of the defaults used for every case. */
+    struct RenderCase
+    {
+        juce::String name;
+        juce::NamedValueSet parameters;
+    };
+
+    void setParameter (GainForgeAudioProcessor& processor, const juce::String& id, float value)
+    {
+        if (auto* parameter = processor.apvts.getParameter (id))
+            parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+    }
+
+    /** Knobs at a mid-gain setting, so both the clean and the saturated paths do real work. */
+    juce::NamedValueSet getBaseParameters()
+    {
+        juce::NamedValueSet base;
+        for (auto* id : knobIds)
+            base.set (id, 0.5f);
+        base.set ("QUALITY", 2); // Standard
+        return base;
+    }
+
+    std::vector<RenderCase> makeRenderCases()
+    {
+        std::vector<RenderCase> cases;
+
+        // Every switch combination at the base knob setting
+        for (int mode = 0; mode < modeNames.size(); ++mode)
+            for (int voice = 0; voice < voiceNames.size(); ++voice)
+                for (int rectifier = 0; rectifier < rectifierNames.size(); ++rectifier)
+                    for (int stack = 0; stack < toneStackNames.size(); ++stack)
+                    {
+                        RenderCase c { "mode-" + modeNames[mode] + "_voice-" + voiceNames[voice]
+                                         + "_rect-" + rectifierNames[rectifier] + "_stack-" + toneStackNames[stack], getBaseParameters() };
+                        c.parameters.set ("MODE", mode);
+                        c.parameters.set ("VOICE", voice);
+                        c.parameters.set ("RECTIFIER_MODE", rectifier);
+                        c.parameters.set ("TONE_STACK", stack);
+                        cases.push_back (c);
+                    }
+
+        // Knob corners on the high-gain channel in both rectifier modes: all down, all up, each knob alone at its ends
+        for (int rectifier = 0; rectifier < rectifierNames.size(); ++rectifier)
+        {
+            const juce::String prefix = "corner_rect-" + rectifierNames[rectifier] + "_";
+            auto make = [&] (const juce::String& name)
+            {
+                RenderCase c { prefix + name, getBaseParameters() };
+                c.parameters.set ("MODE", 2);
+                c.parameters.set ("RECTIFIER_MODE", rectifier);
+                return c;
+            };
+
+            for (float value : { 0.0f, 1.0f })
+            {
+                auto all = make (value > 0.5f ? "all-max" : "all-min");
+                for (auto* id : knobIds)
+                    all.parameters.set (id, value);
+                cases.push_back (all);
+
+                for (auto* id : knobIds)
+                {
+                    auto single = make (juce::String (id).toLowerCase() + (value > 0.5f ? "-max" : "-min"));
+                    single.parameters.set (id, value);
+                    cases.push_back (single);
+                }
+            }
+        }
+
+        return cases;
+    }
+
+    juce::AudioBuffer<float> render (GainForgeAudioProcessor& processor, const Benchmark::Signal& signal)
+    {
+        processor.setRateAndBufferSizeDetails (renderRate, renderBlockSize);
+        processor.prepareToPlay (renderRate, renderBlockSize);
+
+        const int length = (int) signal.samples.size();
+        juce::AudioBuffer<float> output (2, length), block (2, renderBlockSize);
+        juce::MidiBuffer midi;
+        size_t position = 0;
+
+        for (int start = 0; start < length; start += renderBlockSize)
+        {
+            const int numSamples = juce::jmin (renderBlockSize, length - start);
+            block.setSize (2, numSamples, false, false, true);
+            Benchmark::fillBlock (block, numSamples, signal, position);
+            processor.processBlock (block, midi);
+
+            for (int channel = 0; channel < 2; ++channel)
+                output.copyFrom (channel, start, block, channel, 0, numSamples);
+        }
+
+        processor.releaseResources();
+        return output;
+    }
+
+    juce::AudioBuffer<float> render (const RenderCase& renderCase, const Benchmark::Signal& signal)
+    {
+        GainForgeAudioProcessor processor;
+        for (auto& parameter : renderCase.parameters)
+            setParameter (processor, parameter.name.toString(), (float) parameter.value);
+
+        return render (processor, signal);
+    }
+
+    //==============================================================================
+    /** A state as saved before the tiers: the APVTS tree as XML, with no QUALITY parameter. */
+    juce::MemoryBlock makeLegacyState (const juce::NamedValueSet& parameters)
+    {
+        GainForgeAudioProcessor source;
+        for (auto& parameter : parameters)
+            setParameter (source, parameter.name.toString(), (float) parameter.value);
+
+        auto state = source.apvts.copyState();
+        state.removeChild (state.getChildWithProperty ("id", "QUALITY"), nullptr);
+
+        juce::MemoryBlock data;
+        if (auto xml = state.createXml())
+            juce::AudioProcessor::copyXmlToBinary (*xml, data);
+        return data;
+    }
+
+    /** Null-tests a legacy state against the frozen chain. Returns an error, or an empty string if it nulls exactly. */
+    juce::String checkLegacyState (const juce::NamedValueSet& parameters, const Benchmark::Signal& signal)
+    {
+        const auto state = makeLegacyState (parameters);
+
+        GainForgeAudioProcessor processor;
+        setParameter (processor, "QUALITY", 2); // Something else first, so the load has to change it
+        processor.setStateInformation (state.getData(), (int) state.getSize());
+
+        const int quality = juce::roundToInt (processor.apvts.getRawParameterValue ("QUALITY")->load());
+        if (quality != GainForgeAudioProcessor::legacyQualityChoice)
+            return "loaded with QUALITY " + juce::String (quality);
+
+        const auto audio = render (processor, signal);
+
+        LegacyChain::Settings settings;
+        settings.gain = (float) parameters["GAIN"];
+        settings.bass = (float) parameters["BASS"];
+        settings.mid = (float) parameters["MID"];
+        settings.treble = (float) parameters["TREBLE"];
+        settings.presence = (float) parameters["PRESENCE"];
+        settings.master = (float) parameters["MASTER"];
+        settings.drive = (float) parameters["DRIVE"];
+        settings.rectifierMode = (float) parameters["RECTIFIER_MODE"] > 0.5f ? 1.0f : 0.0f;
+        settings.voice = (float) parameters["VOICE"];
+        settings.mode = (float) parameters["MODE"];
+
+        LegacyChain chain;
+        chain.prepare (renderRate, renderBlockSize);
+
+        const int length = (int) signal.samples.size();
+        std::vector<float> reference (signal.samples.begin(), signal.samples.end());
+        for (int start = 0; start < length; start += renderBlockSize)
+            chain.process (reference.data() + start, juce::jmin (renderBlockSize, length - start), settings);
+
+        for (int channel = 0; channel < audio.getNumChannels(); ++channel)
+            for (int i = 0; i < length; ++i)
+                if (audio.getSample (channel, i) != reference[(size_t) i])
+                    return "differs from sample " + juce::String (i) + " on channel " + juce::String (channel)
+                         + " (" + juce::String (audio.getSample (channel, i), 9) + " vs " + juce::String (reference[(size_t) i], 9) + ")";
+
+        return {};
+    }
+
+    bool readReference (const juce::File& file, juce::AudioBuffer<float>& reference)
+    {
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatReader> reader (wav.createReaderFor (file.createInputStream().release(), true));
+        if (reader == nullptr)
+            return false;
+
+        reference.setSize ((int) reader->numChannels, (int) reader->lengthInSamples);
+        return reader->read (&reference, 0, (int) reader->lengthInSamples, 0, true, true);
+    }
+
+    bool writeReference (const juce::File& file, const juce::AudioBuffer<float>& audio)
+    {
+        file.deleteFile();
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::OutputStream> stream (file.createOutputStream());
+        if (stream == nullptr)
+            return false;
+
+        std::unique_ptr<juce::AudioFormatWriter> writer (wav.createWriterFor (stream.get(), renderRate, (unsigned int) audio.getNumChannels(), 32, {}, 0));
+        if (writer == nullptr)
+            return false;
+
+        stream.release(); // Owned by the writer now
+        return writer->writeFromAudioSampleBuffer (audio, 0, audio.getNumSamples());
+    }
+
+    /** Peak of the difference, in dBFS (-200 when the renders null completely). */
+    float getResidualPeakDb (const juce::AudioBuffer<float>& render, const juce::AudioBuffer<float>& reference)
+    {
+        float peak = 0.0f;
+        for (int channel = 0; channel < render.getNumChannels(); ++channel)
+            for (int i = 0; i < render.getNumSamples(); ++i)
+                peak = juce::jmax (peak, std::abs (render.getSample (channel, i) - reference.getSample (channel, i)));
+
+        return juce::Decibels::gainToDecibels (peak, -200.0f);
+    }
+
+    //==============================================================================
+    /** A named benchmark whose ns/sample is held to a budget. */
+    struct BudgetCase
+    {
+        const char* name;
+        double sampleRate;
+        int blockSize;
+        int quality; // QUALITY choice index
+    };
+
+    const BudgetCase budgetCases[] =
+    {
+        { "engine-48k-64-standard",  48000.0,  64,  2 },
+        { "engine-48k-256-standard", 48000.0,  256, 2 },
+        { "engine-48k-256-high",     48000.0,  256, 3 },
+        { "engine-96k-256-standard", 96000.0,  256, 2 },
+    };
+
+    /** Median of five 1-second runs, high-gain Mod/Mid/Silicon over the plucked signal. */
+    double measureBudgetCase (const BudgetCase& budgetCase)
+    {
+        const auto signal = Benchmark::makePlucks (budgetCase.sampleRate, 1.0);
+
+        GainForgeAudioProcessor processor;
+        for (auto& parameter : getBaseParameters())
+            setParameter (processor, parameter.name.toString(), (float) parameter.value);
+        setParameter (processor, "GAIN", 0.7f);
+        setParameter (processor, "QUALITY", (float) budgetCase.quality);
+
+        processor.setRateAndBufferSizeDetails (budgetCase.sampleRate, budgetCase.blockSize);
+        processor.prepareToPlay (budgetCase.sampleRate, budgetCase.blockSize);
+
+        juce::AudioBuffer<float> buffer (2, budgetCase.blockSize);
+        juce::MidiBuffer midi;
+        size_t position = 0;
+        std::vector<double> runs;
+
+        for (int run = 0; run < 6; ++run)
+        {
+            Benchmark::Timings timings;
+            for (juce::int64 done = 0; done < (juce::int64) budgetCase.sampleRate; done += budgetCase.blockSize)
+            {
+                Benchmark::fillBlock (buffer, budgetCase.blockSize, signal, position);
+                const auto start = juce::Time::getHighResolutionTicks();
+                processor.processBlock (buffer, midi);
+                timings.add (juce::Time::getHighResolutionTicks() - start, budgetCase.blockSize);
+            }
+
+            if (run > 0) // The first run warms up
+                runs.push_back (timings.getNanosecondsPerSample());
+        }
+
+        std::sort (runs.begin(), runs.end());
+        return runs[runs.size() / 2];
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    auto referenceFolder = findDefaultReferenceFolder();
+    float toleranceDb = -90.0f;
+    bool updateReferences = false, updateBudgets = false, addMissing = false, skipBudgets = false;
+    double headroom = 1.25;
+    juce::String filter;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const juce::String arg (argv[i]);
+        const bool hasValue = i + 1 < argc;
+
+        if (arg == "--references" && hasValue)          referenceFolder = juce::File::getCurrentWorkingDirectory().getChildFile (argv[++i]);
+        else if (arg == "--tolerance-db" && hasValue)   toleranceDb = juce::String (argv[++i]).getFloatValue();
+        else if (arg == "--filter" && hasValue)         filter = argv[++i];
+        else if (arg == "--update-references")          updateReferences = true;
+        else if (arg == "--add-missing")                addMissing = true;
+        else if (arg == "--skip-budgets")               skipBudgets = true;
+        else if (arg == "--update-budgets")
+        {
+            updateBudgets = true;
+            if (hasValue && juce::String (argv[i + 1]).getDoubleValue() >= 1.0)
+                headroom = juce::String (argv[++i]).getDoubleValue();
+        }
+        else
+        {
+            std::cout << "Usage: GoldenRender [--references <folder>] [--tolerance-db -90]" << std::endl
+                      << "                    [--update-references] [--update-budgets [headroom]]" << std::endl
+                      << "                    [--add-missing] [--skip-budgets] [--filter <text>]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "References: " << referenceFolder.getFullPathName() << std::endl;
+
+    if ((updateReferences || updateBudgets || addMissing) && ! referenceFolder.createDirectory())
+    {
+        std::cerr << "Couldn't create " << referenceFolder.getFullPathName() << std::endl;
+        return 2;
+    }
+
+    int failures = 0;
+    juce::StringArray notGenerated;
+
+    //==============================================================================
+    // Null tests
+    const std::vector<Benchmark::Signal> signals { Benchmark::makePlucks (renderRate, renderSeconds),
+                                                   Benchmark::makeSweep (renderRate, renderSeconds) };
+    int rendered = 0, added = 0;
+    float worstResidualDb = -200.0f;
+
+    const bool skipNullTests = ! updateReferences && ! addMissing
+                            && referenceFolder.getNumberOfChildFiles (juce::File::findFiles, "*.wav") == 0;
+    if (skipNullTests)
+        notGenerated.add ("references");
+
+    for (auto& renderCase : skipNullTests ? decltype (makeRenderCases()) {} : makeRenderCases())
+    {
+        for (auto& signal : signals)
+        {
+            const auto name = renderCase.name + "_" + signal.name;
+            if (filter.isNotEmpty() && ! name.containsIgnoreCase (filter))
+                continue;
+
+            const auto audio = render (renderCase, signal);
+            const auto file = referenceFolder.getChildFile (name + ".wav");
+            ++rendered;
+
+            if (updateReferences)
+            {
+                if (! writeReference (file, audio))
+                {
+                    std::cerr << "Couldn't write " << file.getFullPathName() << std::endl;
+                    return 2;
+                }
+                continue;
+            }
+
+            juce::AudioBuffer<float> reference;
+            if (! readReference (file, reference))
+            {
+                if (addMissing)
+                {
+                    if (! writeReference (file, audio))
+                    {
+                        std::cerr << "Couldn't write " << file.getFullPathName() << std::endl;
+                        return 2;
+                    }
+
+                    std::cout << "ADDED    " << name << std::endl;
+                    ++added;
+                    continue;
+                }
+
+                std::cout << "MISSING  " << name << std::endl;
+                ++failures;
+                continue;
+            }
+
+            if (reference.getNumChannels() != audio.getNumChannels() || reference.getNumSamples() != audio.getNumSamples())
+            {
+                std::cout << "FAIL     " << name << ": reference has a different length or channel count" << std::endl;
+                ++failures;
+                continue;
+            }
+
+            const float residualDb = getResidualPeakDb (audio, reference);
+            worstResidualDb = juce::jmax (worstResidualDb, residualDb);
+
+            if (residualDb > toleranceDb)
+            {
+                std::cout << "FAIL     " << name << ": residual peak " << juce::String (residualDb, 1)
+                          << " dBFS (tolerance " << juce::String (toleranceDb, 1) << ")" << std::endl;
+                ++failures;
+            }
+        }
+    }
+
+    //==============================================================================
+    // Legacy states: Eco has to reproduce the pre-tier chain exactly
+    int legacyChecked = 0;
+
+    for (int mode = 0; mode < modeNames.size(); ++mode)
+        for (int voice = 0; voice < voiceNames.size(); ++voice)
+            for (int rectifier = 0; rectifier < rectifierNames.size(); ++rectifier)
+                for (auto& signal : signals)
+                {
+                    const auto name = "legacy_mode-" + modeNames[mode] + "_voice-" + voiceNames[voice]
+                                    + "_rect-" + rectifierNames[rectifier] + "_" + signal.name;
+                    if (filter.isNotEmpty() && ! name.containsIgnoreCase (filter))
+                        continue;
+
+                    auto parameters = getBaseParameters();
+                    parameters.remove ("QUALITY");
+                    parameters.set ("MODE", mode);
+                    parameters.set ("VOICE", voice);
+                    parameters.set ("RECTIFIER_MODE", rectifier);
+
+                    const auto error = checkLegacyState (parameters, signal);
+                    ++legacyChecked;
+
+                    if (error.isNotEmpty())
+                    {
+                        std::cout << "FAIL     " << name << ": " << error << std::endl;
+                        ++failures;
+                    }
+                }
+
+    std::cout << legacyChecked << " legacy states checked against the pre-tier chain" << std::endl;
+
+    if (updateReferences)
+        std::cout << "Wrote " << rendered << " references to " << referenceFolder.getFullPathName() << std::endl;
+    else if (skipNullTests)
+        std::cout << "No references in " << referenceFolder.getFullPathName() << " yet: null tests skipped" << std::endl;
+    else
+        std::cout << rendered << " renders (" << added << " new references), worst residual peak "
+                  << juce::String (worstResidualDb, 1) << " dBFS" << std::endl;
+
+    //==============================================================================
+    // Performance budgets
+    const auto budgetFile = referenceFolder.getChildFile ("budgets.json");
+
+    if (! skipBudgets && ! budgetFile.existsAsFile() && ! updateBudgets && ! addMissing)
+    {
+        notGenerated.add ("budgets");
+        std::cout << "No " << budgetFile.getFileName() << " yet: budgets skipped" << std::endl;
+    }
+    else if (! skipBudgets)
+    {
+        const auto stored = juce::JSON::parse (budgetFile);
+        auto updated = std::make_unique<juce::DynamicObject>();
+
+        for (auto& budgetCase : budgetCases)
+        {
+            if (filter.isNotEmpty() && ! juce::String (budgetCase.name).containsIgnoreCase (filter))
+                continue;
+
+            const double nsPerSample = measureBudgetCase (budgetCase);
+
+            if (updateBudgets)
+            {
+                updated->setProperty (budgetCase.name, nsPerSample * headroom);
+                std::cout << "BUDGET   " << budgetCase.name << ": " << juce::String (nsPerSample, 1) << " ns/sample, budget "
+                          << juce::String (nsPerSample * headroom, 1) << std::endl;
+                continue;
+            }
+
+            const auto budget = stored.getProperty (budgetCase.name, {});
+            if (budget.isVoid() && addMissing)
+            {
+                updated->setProperty (budgetCase.name, nsPerSample * headroom);
+                std::cout << "ADDED    budget " << budgetCase.name << ": " << juce::String (nsPerSample * headroom, 1) << std::endl;
+            }
+            else if (budget.isVoid())
+            {
+                std::cout << "MISSING  budget " << budgetCase.name << " (" << juce::String (nsPerSample, 1) << " ns/sample)" << std::endl;
+                ++failures;
+            }
+            else if (nsPerSample > (double) budget)
+            {
+                std::cout << "FAIL     " << budgetCase.name << ": " << juce::String (nsPerSample, 1)
+                          << " ns/sample over the budget of " << juce::String ((double) budget, 1) << std::endl;
+                ++failures;
+            }
+            else
+            {
+                std::cout << "OK       " << budgetCase.name << ": " << juce::String (nsPerSample, 1)
+                          << " of " << juce::String ((double) budget, 1) << " ns/sample" << std::endl;
+            }
+        }
+
+        if (updateBudgets || (addMissing && updated->getProperties().size() > 0))
+        {
+            // Keep budgets this run didn't measure (filtered out), or didn't replace (--add-missing)
+            if (auto* previous = stored.getDynamicObject())
+                for (auto& property : previous->getProperties())
+                    if (! updated->hasProperty (property.name))
+                        updated->setProperty (property.name, property.value);
+
+            if (! budgetFile.replaceWithText (juce::JSON::toString (juce::var (updated.release()))))
+            {
+                std::cerr << "Couldn't write " << budgetFile.getFullPathName() << std::endl;
+                return 2;
+            }
+        }
+    }
+
+    if (failures > 0)
+    {
+        std::cout << failures << " failure(s)" << std::endl;
+        return 3;
+    }
+
+    if (! notGenerated.isEmpty())
+    {
+        std::cout << "The " << notGenerated.joinIntoString (" and ") << " haven't been generated. From a Release build, run" << std::endl
+                  << "GoldenRender --update-references and GoldenRender --update-budgets on the machine that enforces them," << std::endl
+                  << "then commit " << referenceFolder.getFullPathName() << std::endl;
+        return 4;
+    }
+
+    std::cout << "All checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,103 @@
+/*
+  ==============================================================================
+
+    GAINFORGE IR converter: turns cabinet IR audio files into preprocessed
+    .gfir containers (resampled and partitioned for the common session rates).
+
+    Usage: IRConverter [--rates 44100,48000,...] [--out <folder>] <file or folder>...
+
+    Folders are converted recursively. Without --out, each container is written
+    next to its audio file, where the plugin picks it up automatically.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/IRContainer.h"
+
+namespace
+{
+    bool isAudioFile (const juce::File& file)
+    {
+        return file.hasFileExtension ("wav;aif;aiff;flac");
+    }
+
+    juce::Array<double> parseRates (const juce::String& list)
+    {
+        juce::Array<double> rates;
+        for (auto& token : juce::StringArray::fromTokens (list, ",", {}))
+            if (token.getDoubleValue() > 0.0)
+                rates.add (token.getDoubleValue());
+
+        return rates;
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    auto rates = IRContainer::getDefaultRates();
+    juce::File outputFolder;
+    juce::Array<juce::File> inputs;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const juce::String arg (argv[i]);
+
+        if (arg == "--rates" && i + 1 < argc)
+            rates = parseRates (argv[++i]);
+        else if (arg == "--out" && i + 1 < argc)
+            outputFolder = juce::File::getCurrentWorkingDirectory().getChildFile (argv[++i]);
+        else
+            inputs.add (juce::File::getCurrentWorkingDirectory().getChildFile (arg));
+    }
+
+    if (inputs.isEmpty() || rates.isEmpty())
+    {
+        std::cout << "Usage: IRConverter [--rates 44100,48000,...] [--out <folder>] <file or folder>..." << std::endl;
+        return 1;
+    }
+
+    juce::Array<juce::File> sources;
+    for (auto& input : inputs)
+    {
+        if (input.isDirectory())
+        {
+            for (const auto& entry : juce::RangedDirectoryIterator (input, true, "*", juce::File::findFiles))
+                if (isAudioFile (entry.getFile()))
+                    sources.add (entry.getFile());
+        }
+        else
+        {
+            sources.add (input);
+        }
+    }
+
+    if (outputFolder != juce::File())
+        outputFolder.createDirectory();
+
+    int failures = 0;
+    for (auto& source : sources)
+    {
+        const auto dest = (outputFolder != juce::File() ? outputFolder.getChildFile (source.getFileName()) : source)
+                              .withFileExtension (IRContainer::fileExtension);
+
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        juce::String error;
+
+        if (IRContainer::convert (source, dest, rates, error))
+        {
+            const auto ms = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+            std::cout << source.getFileName() << " -> " << dest.getFullPathName()
+                      << " (" << dest.getSize() / 1024 << " KB, " << juce::String (ms, 1) << " ms)" << std::endl;
+        }
+        else
+        {
+            std::cerr << source.getFileName() << ": " << error << std::endl;
+            ++failures;
+        }
+    }
+
+    return failures == 0 ? 0 : 2;
+}
@@ -0,0 +1,161 @@
+/*
+  ==============================================================================
+
+    Reference kernels: each AmpEmulator primitive exactly as processBlock runs
+    it, on a prepared emulator. AmpEmulatorProbe is a friend of the processor
+    and the emulator in headless builds.
+
+  ==============================================================================
+*/
+
+#include "../../../Source/PluginProcessor.h"
+#include "MicroBenchmarkRegistry.h"
+
+struct AmpEmulatorProbe
+{
+    using Emulator = GainForgeAudioProcessor::AmpEmulator;
+
+    static std::shared_ptr<Emulator> create (double sampleRate, int blockSize, Quality::Tier tier)
+    {
+        auto emulator = std::make_shared<Emulator>();
+        emulator->prepare (sampleRate, blockSize);
+        emulator->setQuality (tier);
+        return emulator;
+    }
+
+    /** An emulator running the passive tone stack, with the table it needs kept alive alongside. */
+    static std::shared_ptr<Emulator> createPassive (double sampleRate, int blockSize)
+    {
+        juce::SharedResourcePointer<SharedDspResourceCache> cache;
+        std::shared_ptr<PreparedResources> resources = AsyncPreparer::build (sampleRate, blockSize, *cache);
+
+        auto emulator = create (sampleRate, blockSize, Quality::Tier::standard);
+        emulator->setResources (resources.get());
+        emulator->setToneStackMode (true);
+        emulator->updateFilters (0.5f, 0.5f, 0.5f, 0.5f);
+
+        // The aliasing shared_ptr owns both, so the table outlives the emulator's pointer to it
+        auto both = std::make_shared<std::pair<std::shared_ptr<PreparedResources>, std::shared_ptr<Emulator>>> (resources, emulator);
+        return std::shared_ptr<Emulator> (both, both->second.get());
+    }
+
+    /** Keeps a smoother ramping for the whole block, as it would be while a knob moves. */
+    static void retarget (juce::LinearSmoothedValue<float>& smoothed)
+    {
+        smoothed.setTargetValue (smoothed.getTargetValue() > 0.5f ? 0.0f : 1.0f);
+    }
+
+    static void registerAll()
+    {
+        using MicroBenchmark::add;
+        using MicroBenchmark::referenceVariant;
+
+        add ("applyPreampStage", referenceVariant, [] (double rate, int block) -> MicroBenchmark::Kernel
+        {
+            auto e = create (rate, block, Quality::Tier::standard);
+            return [e] (float* s, int n) { for (int i = 0; i < n; ++i) s[i] = e->applyPreampStage (s[i] * 4.0f, 1.0f, 2); };
+        });
+
+        add ("applyPreampStage", "std::tanh (high tier)", [] (double rate, int block) -> MicroBenchmark::Kernel
+        {
+            auto e = create (rate, block, Quality::Tier::high);
+            return [e] (float* s, int n) { for (int i = 0; i < n; ++i) s[i] = e->applyPreampStage (s[i] * 4.0f, 1.0f, 2); };
+        });
+
+        add ("applyRectifierSaturation (silicon)", referenceVariant, [] (double rate, int block) -> MicroBenchmark::Kernel
+        {
+            auto e = create (rate, block, Quality::Tier::standard);
+            return [e] (float* s, int n) { for (int i = 0; i < n; ++i) s[i] = e->applyRectifierSaturation (s[i], 0.5f, 0.0f); };
+        });
+
+        add ("applyRectifierSaturation (tube)", referenceVariant, [] (double rate, int block) -> MicroBenchmark::Kernel
+        {
+            auto e = create (rate, block, Quality::Tier::standard);
+            return [e] (float* s, int n) { for (int i = 0; i < n; ++i) s[i] = e->applyRectifierSaturation (s[i], 0.5f, 1.0f); };
+        });
+
+        // One coefficient update per item, with knob values that move so nothing is hoisted
+        add ("updateFilters (classic)", referenceVariant, [] (double rate, int block) -> MicroBenchmark::Kernel
+        {
+            auto e = create (rate, block, Quality::Tier::standard);
+            return [e] (float* s, int n)
+            {
+                for (int i = 0; i < n; ++i)
+                {
+                    const float knob = 0.5f + 0.25f * s[i];
+                    e->updateFilters (knob, 1.0f - knob, knob, knob);
+                    s[i] = e->bassFilter.coefficients->coefficients[0];
+                }
+            };
+        }, "call");
+
+        add ("updateFilters (passive)", referenceVariant, [] (double rate, int block) -> MicroBenchmark::Kernel
+        {
+            auto e = createPassive (rate, block);
+            return [e] (float* s, int n)
+            {
+                for (int i = 0; i < n; ++i)
+                {
+                    const float knob = 0.5f + 0.25f * s[i];
+                    e->updateFilters (knob, 1.0f - knob, knob, knob);
+                    s[i] = e->presenceFilter.coefficients->coefficients[0];
+                }
+            };
+        }, "call");
+
+        // Tone-stack filters, block processed as in processLinear
+        using FilterMember = juce::dsp::IIR::Filter<float> Emulator::*;
+        static const std::pair<const char*, FilterMember> filters[] =
+        {
+            { "bassFilter", &Emulator::bassFilter },
+            { "midFilter", &Emulator::midFilter },
+            { "trebleFilter", &Emulator::trebleFilter },
+            { "presenceFilter", &Emulator::presenceFilter }
+        };
+
+        for (auto& [name, member] : filters)
+        {
+            add (name, referenceVariant, [member = member] (double rate, int block) -> MicroBenchmark::Kernel
+            {
+                auto e = create (rate, block, Quality::Tier::standard);
+                return [e, member] (float* s, int n)
+                {
+                    float* channels[] = { s };
+                    juce::dsp::AudioBlock<float> audio (channels, 1, (size_t) n);
+                    juce::dsp::ProcessContextReplacing<float> context (audio);
+                    ((*e).*member).process (context);
+                };
+            });
+        }
+
+        add ("passive tone stack", referenceVariant, [] (double rate, int block) -> MicroBenchmark::Kernel
+        {
+            auto e = createPassive (rate, block);
+            return [e] (float* s, int n) { e->toneStack.process (s, n); };
+        });
+
+        add ("LinearSmoothedValue::getNextValue", referenceVariant, [] (double rate, int block) -> MicroBenchmark::Kernel
+        {
+            auto e = create (rate, block, Quality::Tier::standard);
+            return [e] (float* s, int n)
+            {
+                retarget (e->smoothedBass);
+                for (int i = 0; i < n; ++i)
+                    s[i] *= e->smoothedBass.getNextValue();
+            };
+        });
+
+        add ("master gain + jlimit", referenceVariant, [] (double rate, int block) -> MicroBenchmark::Kernel
+        {
+            auto e = create (rate, block, Quality::Tier::standard);
+            return [e] (float* s, int n)
+            {
+                retarget (e->smoothedMaster);
+                for (int i = 0; i < n; ++i)
+                    s[i] = juce::jlimit (-0.98f, 0.98f, s[i] * LinearStage::getMasterGain (e->smoothedMaster.getNextValue()));
+            };
+        });
+    }
+};
+
+[[maybe_unused]] static const bool ampEmulatorKernelsRegistered = (AmpEmulatorProbe::registerAll(), true);
@@ -0,0 +1,184 @@
+/*
+  ==============================================================================
+
+    GAINFORGE micro-benchmarks: every registered DSP primitive and variant,
+    timed in isolation in cycles per sample (or per call), with warm and cold
+    caches.
+
+    Usage: MicroBenchmark [--rate 48000] [--block 256] [--repetitions 200]
+                          [--filter <text>] [--json <file>] [--csv <file>]
+
+    Warm: the same block processed repeatedly, median of the repetitions.
+    Cold: the caches evicted before each call, median of the repetitions.
+    Variants also report their speed-up over the reference of the same
+    primitive. Use a release build.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <map>
+#include "../../Benchmark/Source/BenchmarkSupport.h"
+#include "MicroBenchmarkRegistry.h"
+
+namespace
+{
+    struct Measurement
+    {
+        double cyclesPerItem = 0.0;
+        double nsPerItem = 0.0;
+    };
+
+    double getMedian (std::vector<double> values)
+    {
+        if (values.empty())
+            return 0.0;
+
+        const auto middle = values.begin() + (ptrdiff_t) (values.size() / 2);
+        std::nth_element (values.begin(), middle, values.end());
+        return *middle;
+    }
+
+    Measurement measure (const MicroBenchmark::Kernel& kernel, const std::vector<float>& input,
+                         std::vector<float>& work, int repetitions, bool cold)
+    {
+        const int numSamples = (int) input.size();
+        std::vector<double> cycles, nanoseconds;
+        cycles.reserve ((size_t) repetitions);
+        nanoseconds.reserve ((size_t) repetitions);
+
+        for (int r = 0; r < repetitions; ++r)
+        {
+            std::copy (input.begin(), input.end(), work.begin());
+            if (cold)
+                Benchmark::evictCaches();
+
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+            const auto startCycles = Benchmark::readCycleCounter();
+            kernel (work.data(), numSamples);
+            const auto endCycles = Benchmark::readCycleCounter();
+            const auto endTicks = juce::Time::getHighResolutionTicks();
+
+            cycles.push_back ((double) (endCycles - startCycles) / numSamples);
+            nanoseconds.push_back (juce::Time::highResolutionTicksToSeconds (endTicks - startTicks) * 1.0e9 / numSamples);
+        }
+
+        return { getMedian (cycles), getMedian (nanoseconds) };
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    double sampleRate = 48000.0;
+    int blockSize = 256;
+    int repetitions = 200;
+    juce::String filter;
+    juce::File jsonFile, csvFile;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const juce::String arg (argv[i]);
+        const bool hasValue = i + 1 < argc;
+        const auto cwd = juce::File::getCurrentWorkingDirectory();
+
+        if (arg == "--rate" && hasValue)                sampleRate = juce::String (argv[++i]).getDoubleValue();
+        else if (arg == "--block" && hasValue)          blockSize = juce::String (argv[++i]).getIntValue();
+        else if (arg == "--repetitions" && hasValue)    repetitions = juce::String (argv[++i]).getIntValue();
+        else if (arg == "--filter" && hasValue)         filter = argv[++i];
+        else if (arg == "--json" && hasValue)           jsonFile = cwd.getChildFile (argv[++i]);
+        else if (arg == "--csv" && hasValue)            csvFile = cwd.getChildFile (argv[++i]);
+        else
+        {
+            std::cout << "Usage: MicroBenchmark [--rate 48000] [--block 256] [--repetitions 200]" << std::endl
+                      << "                      [--filter <text>] [--json <file>] [--csv <file>]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (sampleRate <= 0.0 || blockSize <= 0 || repetitions <= 0)
+    {
+        std::cerr << "Nothing to run" << std::endl;
+        return 1;
+    }
+
+    juce::ScopedNoDenormals noDenormals; // As in processBlock
+
+    // A block of plucked-string "DI" from well into the first note
+    const auto signal = Benchmark::makePlucks (sampleRate, 0.25);
+    std::vector<float> input ((size_t) blockSize), work ((size_t) blockSize);
+    for (size_t i = 0; i < input.size(); ++i)
+        input[i] = signal.samples[(i + signal.samples.size() / 4) % signal.samples.size()];
+
+    Benchmark::ResultWriter results ("GainForge micro-benchmarks");
+    std::map<juce::String, double> referenceCycles;
+
+    std::cout << juce::SystemStats::getCpuModel()
+              << (Benchmark::hasCycleCounter() ? " (TSC cycles)" : " (cycles estimated from the clock speed)") << std::endl
+              << "primitive                            variant                unit     warm cyc   cold cyc   warm ns  speed-up" << std::endl;
+
+    // References first, so variants can be compared against them
+    auto entries = MicroBenchmark::getRegistry();
+    std::stable_partition (entries.begin(), entries.end(),
+                           [] (const MicroBenchmark::Entry& e) { return e.variant == MicroBenchmark::referenceVariant; });
+
+    for (auto& entry : entries)
+    {
+        if (filter.isNotEmpty() && ! entry.primitive.containsIgnoreCase (filter) && ! entry.variant.containsIgnoreCase (filter))
+            continue;
+
+        const auto kernel = entry.create (sampleRate, blockSize);
+
+        // Settle state (smoothers, filter memories) before the warm runs
+        for (int r = 0; r < 20; ++r)
+        {
+            std::copy (input.begin(), input.end(), work.begin());
+            kernel (work.data(), blockSize);
+        }
+
+        const auto warm = measure (kernel, input, work, repetitions, false);
+        const auto cold = measure (kernel, input, work, juce::jmax (10, repetitions / 4), true);
+
+        if (entry.variant == MicroBenchmark::referenceVariant)
+            referenceCycles[entry.primitive] = warm.cyclesPerItem;
+
+        const auto reference = referenceCycles.find (entry.primitive);
+        const double speedUp = reference != referenceCycles.end() && warm.cyclesPerItem > 0.0
+                                 ? reference->second / warm.cyclesPerItem : 0.0;
+
+        auto& row = results.addRow();
+        row.setProperty ("primitive", entry.primitive);
+        row.setProperty ("variant", entry.variant);
+        row.setProperty ("unit", entry.unit);
+        row.setProperty ("sampleRate", sampleRate);
+        row.setProperty ("blockSize", blockSize);
+        row.setProperty ("warmCycles", warm.cyclesPerItem);
+        row.setProperty ("coldCycles", cold.cyclesPerItem);
+        row.setProperty ("warmNs", warm.nsPerItem);
+        row.setProperty ("coldNs", cold.nsPerItem);
+        row.setProperty ("speedUp", speedUp);
+
+        std::cout << entry.primitive.substring (0, 36).paddedRight (' ', 37)
+                  << entry.variant.substring (0, 22).paddedRight (' ', 23)
+                  << entry.unit.paddedRight (' ', 7)
+                  << juce::String (warm.cyclesPerItem, 2).paddedLeft (' ', 10)
+                  << juce::String (cold.cyclesPerItem, 2).paddedLeft (' ', 11)
+                  << juce::String (warm.nsPerItem, 2).paddedLeft (' ', 10)
+                  << (speedUp > 0.0 ? juce::String (speedUp, 2) + "x" : juce::String ("-")).paddedLeft (' ', 10) << std::endl;
+    }
+
+    bool written = true;
+    if (jsonFile != juce::File())
+        written = results.writeJson (jsonFile) && written;
+    if (csvFile != juce::File())
+        written = results.writeCsv (csvFile) && written;
+
+    if (! written)
+    {
+        std::cerr << "Couldn't write the result files" << std::endl;
+        return 2;
+    }
+
+    return 0;
+}
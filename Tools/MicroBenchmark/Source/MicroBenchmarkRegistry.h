@@ -0,0 +1,57 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include <vector>
+
+//==============================================================================
+/**
+    Registry of micro-benchmark kernels, one per DSP primitive and variant.
+
+    A kernel processes a block in place; the runner times it warm (repeated on
+    the same block) and cold (after evicting the caches) and reports cycles
+    per item. Items are samples, except for per-call primitives such as
+    coefficient updates, which treat each item as one call.
+
+    Optimised variants (SIMD, tables, fused cascades) register under the same
+    primitive name with their own variant name, from any source file in the
+    target, and show up next to the reference:
+
+        static MicroBenchmark::Registration fused ("tone stack cascade", "fused",
+            [] (double sampleRate, int blockSize) { ...; return kernel; });
+*/
+namespace MicroBenchmark
+{
+    using Kernel = std::function<void (float* samples, int numSamples)>;
+    using Factory = std::function<Kernel (double sampleRate, int blockSize)>;
+
+    static constexpr const char* referenceVariant = "reference";
+
+    struct Entry
+    {
+        juce::String primitive;
+        juce::String variant;
+        juce::String unit;      // "sample" or "call"
+        Factory create;
+    };
+
+    inline std::vector<Entry>& getRegistry()
+    {
+        static std::vector<Entry> entries;
+        return entries;
+    }
+
+    inline void add (juce::String primitive, juce::String variant, Factory create, juce::String unit = "sample")
+    {
+        getRegistry().push_back ({ std::move (primitive), std::move (variant), std::move (unit), std::move (create) });
+    }
+
+    /** For registering at static-initialisation time from the file that defines a kernel. */
+    struct Registration
+    {
+        Registration (juce::String primitive, juce::String variant, Factory create, juce::String unit = "sample")
+        {
+            add (std::move (primitive), std::move (variant), std::move (create), std::move (unit));
+        }
+    };
+}
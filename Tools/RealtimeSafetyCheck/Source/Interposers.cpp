@@ -0,0 +1,231 @@
+/*
+  ==============================================================================
+
+    Hooks that report allocations and blocking calls to RealtimeSafety. They
+    replace the C library entry points for this executable only:
+
+    - Linux: malloc family via glibc's __libc_* entry points; pthread mutex
+      and condition waits and syscall(SYS_futex) via dlsym (RTLD_NEXT)
+    - macOS: malloc family and pthread waits via dyld interposing
+    - Windows: operator new/delete only (locks aren't caught)
+
+    operator new/delete end up in malloc/free on Linux and macOS, so they're
+    only replaced where malloc can't be.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/RealtimeSafety.h"
+
+#if JUCE_LINUX
+ #include <dlfcn.h>
+ #include <pthread.h>
+ #include <cstdarg>
+ #include <sys/syscall.h>
+
+extern "C"
+{
+    void* __libc_malloc (size_t);
+    void* __libc_calloc (size_t, size_t);
+    void* __libc_realloc (void*, size_t);
+    void* __libc_memalign (size_t, size_t);
+    void __libc_free (void*);
+}
+
+namespace
+{
+    template <typename Function>
+    Function findNext (const char* name) noexcept
+    {
+        return reinterpret_cast<Function> (dlsym (RTLD_NEXT, name));
+    }
+}
+
+extern "C"
+{
+    void* malloc (size_t size)
+    {
+        RealtimeSafety::report (RealtimeSafety::Violation::allocation, size);
+        return __libc_malloc (size);
+    }
+
+    void* calloc (size_t count, size_t size)
+    {
+        RealtimeSafety::report (RealtimeSafety::Violation::allocation, count * size);
+        return __libc_calloc (count, size);
+    }
+
+    void* realloc (void* pointer, size_t size)
+    {
+        RealtimeSafety::report (RealtimeSafety::Violation::allocation, size);
+        return __libc_realloc (pointer, size);
+    }
+
+    void* memalign (size_t alignment, size_t size)
+    {
+        RealtimeSafety::report (RealtimeSafety::Violation::allocation, size);
+        return __libc_memalign (alignment, size);
+    }
+
+    void* aligned_alloc (size_t alignment, size_t size)
+    {
+        RealtimeSafety::report (RealtimeSafety::Violation::allocation, size);
+        return __libc_memalign (alignment, size);
+    }
+
+    int posix_memalign (void** result, size_t alignment, size_t size)
+    {
+        RealtimeSafety::report (RealtimeSafety::Violation::allocation, size);
+        *result = __libc_memalign (alignment, size);
+        return *result != nullptr ? 0 : ENOMEM;
+    }
+
+    void free (void* pointer)
+    {
+        if (pointer != nullptr)
+            RealtimeSafety::report (RealtimeSafety::Violation::deallocation);
+        __libc_free (pointer);
+    }
+
+    // glibc's own calls to these don't go through the PLT, so dlsym never re-enters them
+    int pthread_mutex_lock (pthread_mutex_t* mutex)
+    {
+        static auto next = findNext<int (*) (pthread_mutex_t*)> ("pthread_mutex_lock");
+        RealtimeSafety::report (RealtimeSafety::Violation::mutexLock);
+        return next (mutex);
+    }
+
+    int pthread_cond_wait (pthread_cond_t* condition, pthread_mutex_t* mutex)
+    {
+        static auto next = findNext<int (*) (pthread_cond_t*, pthread_mutex_t*)> ("pthread_cond_wait");
+        RealtimeSafety::report (RealtimeSafety::Violation::conditionWait);
+        return next (condition, mutex);
+    }
+
+    int pthread_cond_timedwait (pthread_cond_t* condition, pthread_mutex_t* mutex, const struct timespec* time)
+    {
+        static auto next = findNext<int (*) (pthread_cond_t*, pthread_mutex_t*, const struct timespec*)> ("pthread_cond_timedwait");
+        RealtimeSafety::report (RealtimeSafety::Violation::conditionWait);
+        return next (condition, mutex, time);
+    }
+
+    // std::atomic wait/notify and some libraries call futex through syscall()
+    long syscall (long number, ...)
+    {
+        static auto next = findNext<long (*) (long, ...)> ("syscall");
+
+        va_list args;
+        va_start (args, number);
+        long a[6];
+        for (auto& arg : a)
+            arg = va_arg (args, long);
+        va_end (args);
+
+        if (number == SYS_futex)
+            RealtimeSafety::report (RealtimeSafety::Violation::futex);
+
+        return next (number, a[0], a[1], a[2], a[3], a[4], a[5]);
+    }
+}
+
+#elif JUCE_MAC
+ #include <malloc/malloc.h>
+ #include <pthread.h>
+
+namespace
+{
+    void* checkedMalloc (size_t size)
+    {
+        RealtimeSafety::report (RealtimeSafety::Violation::allocation, size);
+        return malloc (size);
+    }
+
+    void* checkedCalloc (size_t count, size_t size)
+    {
+        RealtimeSafety::report (RealtimeSafety::Violation::allocation, count * size);
+        return calloc (count, size);
+    }
+
+    void* checkedRealloc (void* pointer, size_t size)
+    {
+        RealtimeSafety::report (RealtimeSafety::Violation::allocation, size);
+        return realloc (pointer, size);
+    }
+
+    int checkedPosixMemalign (void** result, size_t alignment, size_t size)
+    {
+        RealtimeSafety::report (RealtimeSafety::Violation::allocation, size);
+        return posix_memalign (result, alignment, size);
+    }
+
+    void checkedFree (void* pointer)
+    {
+        if (pointer != nullptr)
+            RealtimeSafety::report (RealtimeSafety::Violation::deallocation);
+        free (pointer);
+    }
+
+    int checkedMutexLock (pthread_mutex_t* mutex)
+    {
+        RealtimeSafety::report (RealtimeSafety::Violation::mutexLock);
+        return pthread_mutex_lock (mutex);
+    }
+
+    int checkedConditionWait (pthread_cond_t* condition, pthread_mutex_t* mutex)
+    {
+        RealtimeSafety::report (RealtimeSafety::Violation::conditionWait);
+        return pthread_cond_wait (condition, mutex);
+    }
+
+    int checkedConditionTimedWait (pthread_cond_t* condition, pthread_mutex_t* mutex, const struct timespec* time)
+    {
+        RealtimeSafety::report (RealtimeSafety::Violation::conditionWait);
+        return pthread_cond_timedwait (condition, mutex, time);
+    }
+}
+
+// dyld swaps every other image's calls to the original for the replacement
+#define GAINFORGE_INTERPOSE(replacement, original) \
+    __attribute__ ((used)) static const struct { const void* replacement; const void* original; } \
+    interpose_##original __attribute__ ((section ("__DATA,__interpose"))) = { (const void*) &replacement, (const void*) &original };
+
+GAINFORGE_INTERPOSE (checkedMalloc, malloc)
+GAINFORGE_INTERPOSE (checkedCalloc, calloc)
+GAINFORGE_INTERPOSE (checkedRealloc, realloc)
+GAINFORGE_INTERPOSE (checkedPosixMemalign, posix_memalign)
+GAINFORGE_INTERPOSE (checkedFree, free)
+GAINFORGE_INTERPOSE (checkedMutexLock, pthread_mutex_lock)
+GAINFORGE_INTERPOSE (checkedConditionWait, pthread_cond_wait)
+GAINFORGE_INTERPOSE (checkedConditionTimedWait, pthread_cond_timedwait)
+
+#else
+ #include <new>
+
+void* operator new (size_t size)
+{
+    RealtimeSafety::report (RealtimeSafety::Violation::allocation, size);
+    if (auto* pointer = std::malloc (size))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void* operator new[] (size_t size)                                  { return operator new (size); }
+void* operator new (size_t size, const std::nothrow_t&) noexcept
+{
+    RealtimeSafety::report (RealtimeSafety::Violation::allocation, size);
+    return std::malloc (size);
+}
+void* operator new[] (size_t size, const std::nothrow_t& tag) noexcept  { return operator new (size, tag); }
+
+void operator delete (void* pointer) noexcept
+{
+    if (pointer != nullptr)
+        RealtimeSafety::report (RealtimeSafety::Violation::deallocation);
+    std::free (pointer);
+}
+
+void operator delete[] (void* pointer) noexcept                     { operator delete (pointer); }
+void operator delete (void* pointer, size_t) noexcept               { operator delete (pointer); }
+void operator delete[] (void* pointer, size_t) noexcept             { operator delete (pointer); }
+#endif
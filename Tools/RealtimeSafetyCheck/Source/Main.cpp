@@ -0,0 +1,285 @@
+/*
+  ==============================================================================
+
+    GAINFORGE real-time safety check: runs the processor on an audio thread
+    while the main thread storms it with parameter changes, preset switches,
+    state recalls, bypass, cabinet and capture loads (exact and approximated
+    cabinet), and merging switched on and off. Fails if processBlock
+    allocated, freed or waited on a lock (see Source/RealtimeSafety.h and
+    Interposers.cpp). Every block size runs live, then as an offline render
+    through the pipelined path, where only allocations count: that callback
+    waits for its pipeline worker by design.
+
+    Usage: RealtimeSafetyCheck [--seconds 4] [--blocks 32,128,1024] [--rate 48000]
+
+    Exit code 3 and a stack trace per violation when anything was caught.
+    Build in Debug with frame pointers (or -rdynamic on Linux) for readable
+    stacks.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <thread>
+#include "../../../Source/PluginProcessor.h"
+#include "../../../Source/RealtimeSafety.h"
+
+namespace
+{
+    /** Calls processBlock back to back, as a host's audio thread would. */
+    class AudioThread
+    {
+    public:
+        AudioThread (GainForgeAudioProcessor& p, int blockSize)
+            : processor (p), buffer (2, blockSize)
+        {
+            midi.ensureSize (256);
+        }
+
+        void start()
+        {
+            thread = std::thread ([this]
+            {
+                juce::Random random (0x5afe);
+                while (! shouldStop.load())
+                {
+                    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                        for (int i = 0; i < buffer.getNumSamples(); ++i)
+                            buffer.setSample (channel, i, 0.5f * (random.nextFloat() * 2.0f - 1.0f));
+
+                    processor.processBlock (buffer, midi);
+                    blocksProcessed.fetch_add (1);
+                }
+            });
+        }
+
+        void stop()
+        {
+            shouldStop = true;
+            if (thread.joinable())
+                thread.join();
+        }
+
+        int getBlocksProcessed() const noexcept     { return blocksProcessed.load(); }
+
+    private:
+        GainForgeAudioProcessor& processor;
+        juce::AudioBuffer<float> buffer;
+        juce::MidiBuffer midi;
+        std::thread thread;
+        std::atomic<bool> shouldStop { false };
+        std::atomic<int> blocksProcessed { 0 };
+    };
+
+    /** A 100 ms decaying-noise IR, long enough to give the convolver a tail for the worker. */
+    bool writeImpulseResponse (const juce::File& file, double sampleRate)
+    {
+        juce::AudioBuffer<float> ir (1, (int) (0.1 * sampleRate));
+        juce::Random random (0xcab);
+
+        for (int i = 0; i < ir.getNumSamples(); ++i)
+            ir.setSample (0, i, (float) std::pow (0.001, (double) i / ir.getNumSamples()) * 0.2f * (random.nextFloat() * 2.0f - 1.0f));
+
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer (wav.createWriterFor (new juce::FileOutputStream (file),
+                                                                              sampleRate, 1, 24, {}, 0));
+        return writer != nullptr && writer->writeFromAudioSampleBuffer (ir, 0, ir.getNumSamples());
+    }
+
+    /** A GRU capture (hidden size 8) with small random weights, declared at the session rate so it runs. */
+    bool writeCapture (const juce::File& file, double sampleRate)
+    {
+        constexpr int hiddenSize = 8, rows = 3 * hiddenSize;
+        juce::Random random (0x9a1);
+
+        auto tensor = [&random] (int size)
+        {
+            juce::Array<juce::var> values;
+            for (int i = 0; i < size; ++i)
+                values.add (0.2f * (random.nextFloat() * 2.0f - 1.0f));
+            return juce::var (values);
+        };
+
+        auto* modelData = new juce::DynamicObject();
+        modelData->setProperty ("unit_type", "GRU");
+        modelData->setProperty ("hidden_size", hiddenSize);
+        modelData->setProperty ("skip", 1);
+        modelData->setProperty ("sample_rate", sampleRate);
+
+        auto* stateDict = new juce::DynamicObject();
+        stateDict->setProperty ("rec.weight_ih_l0", tensor (rows));
+        stateDict->setProperty ("rec.weight_hh_l0", tensor (rows * hiddenSize));
+        stateDict->setProperty ("rec.bias_ih_l0", tensor (rows));
+        stateDict->setProperty ("rec.bias_hh_l0", tensor (rows));
+        stateDict->setProperty ("lin.weight", tensor (hiddenSize));
+        stateDict->setProperty ("lin.bias", tensor (1));
+
+        auto* json = new juce::DynamicObject();
+        json->setProperty ("model_data", juce::var (modelData));
+        json->setProperty ("state_dict", juce::var (stateDict));
+        return file.replaceWithText (juce::JSON::toString (juce::var (json)));
+    }
+
+    /**
+        One burst of the kind of traffic a busy session produces: automation, preset
+        switches, state recalls and bypass, with the cabinet, merging and capture
+        changing underneath. Every 500 bursts the rig moves on:
+            0   exact cabinet loaded, merging on
+            1   automation pauses, so the knobs settle and the merged kernel is
+                built and crossfaded in
+            2   cabinet approximated with biquads, merging off
+            3   cabinet cleared
+    */
+    void storm (GainForgeAudioProcessor& processor, juce::Random& random, int iteration, juce::MemoryBlock& state,
+                const juce::File& irFile, const juce::File& captureFile)
+    {
+        const int phase = (iteration / 500) % 4;
+
+        if (iteration % 500 == 0)
+        {
+            switch (phase)
+            {
+                case 0:
+                    processor.setCabinetApproximation (0);
+                    processor.loadCabinetIR (irFile);
+                    processor.setLinearStageMerging (true);
+                    break;
+                case 2:
+                    processor.setCabinetApproximation (12);
+                    processor.setLinearStageMerging (false);
+                    break;
+                case 3:
+                    processor.clearCabinetIR();
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        if (iteration % 200 == 0)
+        {
+            if ((iteration / 200) % 2 == 0)
+                processor.loadAmpModel (captureFile);
+            else
+                processor.clearAmpModel();
+        }
+
+        if (iteration % 50 == 0)
+            if (auto* bypass = processor.getBypassParameter())
+                bypass->setValueNotifyingHost ((iteration / 50) % 4 == 3 ? 1.0f : 0.0f);
+
+        if (phase == 1)
+            return;
+
+        auto& parameters = processor.getParameters();
+        for (int i = 0; i < 16; ++i)
+            if (auto* parameter = parameters[random.nextInt (parameters.size())])
+                if (parameter != processor.getBypassParameter())
+                    parameter->setValueNotifyingHost (random.nextFloat());
+
+        if (iteration % 25 == 0)
+            processor.setCurrentProgram (random.nextInt (juce::jmax (1, processor.getNumPrograms())));
+
+        if (iteration % 40 == 0)
+        {
+            ParameterSnapshot snapshot;
+            for (auto& value : snapshot.values)
+                value = random.nextFloat();
+            snapshot[ParameterSnapshot::rectifierMode] = (float) random.nextInt (2);
+            snapshot[ParameterSnapshot::voice] = (float) random.nextInt (3);
+            snapshot[ParameterSnapshot::mode] = (float) random.nextInt (3);
+            snapshot[ParameterSnapshot::toneStack] = (float) random.nextInt (2);
+            processor.applyParameterSnapshot (snapshot);
+        }
+
+        if (iteration % 100 == 0)
+        {
+            processor.getStateInformation (state);
+            processor.setStateInformation (state.getData(), (int) state.getSize());
+        }
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    double seconds = 4.0, sampleRate = 48000.0; // Long enough for every phase of the storm
+    juce::Array<int> blockSizes { 32, 128, 1024 };
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const juce::String arg (argv[i]);
+        const bool hasValue = i + 1 < argc;
+
+        if (arg == "--seconds" && hasValue)         seconds = juce::String (argv[++i]).getDoubleValue();
+        else if (arg == "--rate" && hasValue)       sampleRate = juce::String (argv[++i]).getDoubleValue();
+        else if (arg == "--blocks" && hasValue)
+        {
+            blockSizes.clear();
+            for (auto& token : juce::StringArray::fromTokens (argv[++i], ",", {}))
+                if (token.getIntValue() > 0)
+                    blockSizes.add (token.getIntValue());
+        }
+        else
+        {
+            std::cout << "Usage: RealtimeSafetyCheck [--seconds 4] [--blocks 32,128,1024] [--rate 48000]" << std::endl;
+            return 1;
+        }
+    }
+
+    juce::TemporaryFile irFile (".wav"), captureFile (".json");
+    if (! writeImpulseResponse (irFile.getFile(), sampleRate) || ! writeCapture (captureFile.getFile(), sampleRate))
+    {
+        std::cerr << "Couldn't write the test impulse response and capture" << std::endl;
+        return 1;
+    }
+
+    RealtimeSafety::enable();
+    int totalViolations = 0;
+
+    for (auto blockSize : blockSizes)
+    for (auto offline : { false, true })
+    {
+        GainForgeAudioProcessor processor;
+        processor.setNonRealtime (offline); // Offline renders run the pipelined path
+        processor.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        processor.prepareToPlay (sampleRate, blockSize);
+
+        RealtimeSafety::clear();
+        AudioThread audio (processor, blockSize);
+        audio.start();
+
+        juce::Random random (blockSize);
+        juce::MemoryBlock state;
+        const auto end = juce::Time::getMillisecondCounterHiRes() + seconds * 1000.0;
+
+        for (int iteration = 0; juce::Time::getMillisecondCounterHiRes() < end; ++iteration)
+        {
+            storm (processor, random, iteration, state, irFile.getFile(), captureFile.getFile());
+
+            // Lets the processor's timer (merge settling) and async host updates run, as in a host
+            juce::MessageManager::getInstance()->runDispatchLoopUntil (1);
+        }
+
+        audio.stop();
+        processor.releaseResources();
+
+        const int violations = RealtimeSafety::getNumViolations();
+        totalViolations += violations;
+
+        std::cout << "Block " << blockSize << (offline ? " (offline)" : "") << ": " << audio.getBlocksProcessed() << " callbacks, "
+                  << violations << " violation(s)" << std::endl;
+
+        if (violations > 0)
+            std::cout << RealtimeSafety::getReport() << std::endl;
+    }
+
+    RealtimeSafety::disable();
+
+    if (totalViolations > 0)
+        return 3;
+
+    std::cout << "No allocations or locks on the audio thread" << std::endl;
+    return 0;
+}